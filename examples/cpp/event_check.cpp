@@ -0,0 +1,121 @@
+/**
+ * Checks util::Event's timeouts and wake-ups, and that take and take1
+ * give up after their timeouts. Exits nonzero if anything is off.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "roboflex_core/core_messages/core_messages.h"
+#include "roboflex_core/core_nodes/core_nodes.h"
+#include "roboflex_core/util/event.h"
+
+using namespace roboflex;
+
+static int num_failures = 0;
+
+#define CHECK(condition) \
+    if (!(condition)) { \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": FAILED: " #condition << std::endl; \
+        num_failures++; \
+    }
+
+// Generous upper bound on how late a timed-out or woken wait may return;
+// loaded machines are slow.
+constexpr double SlackMilliseconds = 500;
+
+template <typename F>
+double milliseconds_taken(F&& f)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void check_event(int spin_microseconds)
+{
+    util::Event e(spin_microseconds);
+
+    // unset: times out, no sooner than asked
+    bool result = true;
+    double ms = milliseconds_taken([&] { result = e.wait(50); });
+    CHECK(!result);
+    CHECK(ms >= 49.0 && ms < 50 + SlackMilliseconds);
+
+    // set: returns at once, and stays set until cleared
+    e.set();
+    CHECK(e.isSet());
+    ms = milliseconds_taken([&] { result = e.wait(1000); });
+    CHECK(result);
+    CHECK(ms < SlackMilliseconds);
+    CHECK(e.wait(0));
+    e.clear();
+    CHECK(!e.isSet());
+    CHECK(!e.wait(1));
+
+    // set from another thread wakes every waiter, with or without a timeout
+    std::atomic<int> num_woken = 0;
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 4; i++) {
+        waiters.emplace_back([&e, &num_woken, i] {
+            if (e.wait(i % 2 == 0 ? 0 : 10000)) {
+                num_woken++;
+            }
+        });
+    }
+    ms = milliseconds_taken([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        e.set();
+        for (auto& t: waiters) {
+            t.join();
+        }
+    });
+    CHECK(num_woken == 4);
+    CHECK(ms < 30 + SlackMilliseconds);
+}
+
+void check_take()
+{
+    core::Node source("source");
+
+    // nothing comes: take1 gives up, with nothing
+    core::MessagePtr m;
+    double ms = milliseconds_taken([&] { m = nodes::take1(source, 50); });
+    CHECK(m == nullptr);
+    CHECK(ms >= 49.0 && ms < 50 + SlackMilliseconds);
+
+    // a message every 10 ms
+    std::atomic<bool> stop = false;
+    std::thread producer([&] {
+        while (!stop) {
+            source.signal(std::make_shared<core::BlankMessage>("tick"));
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    });
+
+    // enough come: take returns as soon as they have
+    std::vector<core::MessagePtr> messages;
+    ms = milliseconds_taken([&] { messages = nodes::take(3, source, 5000); });
+    CHECK(messages.size() == 3);
+    CHECK(ms < 30 + SlackMilliseconds);
+
+    // not enough come: take gives up, with what did
+    ms = milliseconds_taken([&] { messages = nodes::take(1000, source, 100); });
+    CHECK(messages.size() < 1000);
+    CHECK(ms >= 99.0 && ms < 100 + SlackMilliseconds);
+
+    stop = true;
+    producer.join();
+}
+
+int main()
+{
+    check_event(0);
+    check_event(200);
+    check_take();
+
+    std::cout << (num_failures == 0 ? "PASSED" : "FAILED") << std::endl;
+    return num_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+/**
+ * Times graph walks on a generated graph: 10k nodes by default (or
+ * however many are given as the first argument), each fanning out to a
+ * few of the nodes after it, plus a long chain.
+ *
+ * Walks are cached until the graph changes (see node_registry.h), so
+ * this times both: cold walks, with the cache invalidated each time, and
+ * warm ones. Also times finding a node by guid, by walking and by asking
+ * the NodeRegistry.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "roboflex_core/core.h"
+
+using namespace roboflex::core;
+
+template <typename F>
+double time_per_call_us(int repeats, F&& f)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        f();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(t1 - t0).count() / repeats;
+}
+
+int main(int argc, char** argv)
+{
+    const size_t num_nodes = std::max<size_t>(2, argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000);
+    const int repeats = 20;
+
+    // Each node connects to 1-3 later nodes: acyclic, with lots of
+    // paths to each node, so the visited set matters.
+    std::mt19937 rng(7);
+    std::vector<NodePtr> nodes;
+    nodes.reserve(num_nodes);
+    for (size_t i = 0; i < num_nodes; i++) {
+        nodes.push_back(std::make_shared<Node>("n" + std::to_string(i)));
+    }
+    size_t num_edges = 0;
+    for (size_t i = 0; i + 1 < num_nodes; i++) {
+        nodes[i]->connect(nodes[i + 1]);
+        num_edges++;
+        int extra = rng() % 3;
+        for (int e = 0; e < extra; e++) {
+            size_t j = i + 1 + rng() % std::min<size_t>(num_nodes - i - 1, 64);
+            nodes[i]->connect(nodes[j]);
+            num_edges++;
+        }
+    }
+
+    NodePtr root = std::make_shared<Node>("root");
+    root->connect(nodes[0]);
+    NodePtr scratch = std::make_shared<Node>("scratch");
+
+    std::cout << "graph: " << num_nodes << " nodes, " << num_edges << " edges" << std::endl
+              << std::fixed << std::setprecision(2);
+
+    size_t visits = 0;
+    auto count_nodes = [&visits](NodePtr, int) { visits++; };
+    auto count_connections = [&visits](NodePtr, NodePtr, int) { visits++; };
+
+    // connecting anything invalidates cached walks
+    auto invalidate = [&]() {
+        scratch->connect(scratch);
+        scratch->disconnect(scratch);
+    };
+
+    auto report = [&](const string& what, double us) {
+        std::cout << std::setw(34) << std::left << what << std::setw(10) << std::right << us << " us" << std::endl;
+    };
+
+    report("walk_nodes_forwards (cold)", time_per_call_us(repeats, [&]() { invalidate(); root->walk_nodes_forwards(count_nodes); }));
+    report("walk_nodes_forwards (warm)", time_per_call_us(repeats, [&]() { root->walk_nodes_forwards(count_nodes); }));
+    report("walk_nodes_backwards (cold)", time_per_call_us(repeats, [&]() { invalidate(); root->walk_nodes_backwards(count_nodes); }));
+    report("walk_nodes_backwards (warm)", time_per_call_us(repeats, [&]() { root->walk_nodes_backwards(count_nodes); }));
+    report("walk_connections_forwards (cold)", time_per_call_us(repeats, [&]() { invalidate(); root->walk_connections_forwards(count_connections); }));
+    report("walk_connections_forwards (warm)", time_per_call_us(repeats, [&]() { root->walk_connections_forwards(count_connections); }));
+    report("filter_nodes (keep all)", time_per_call_us(repeats, [&]() {
+        root->filter_nodes([](NodePtr, int) { return true; });
+    }));
+
+    const uuid& target = nodes[num_nodes - 1]->get_guid();
+    report("find by guid (walk)", time_per_call_us(repeats, [&]() {
+        NodePtr found;
+        root->walk_nodes_forwards([&](NodePtr n, int) {
+            if (found == nullptr && n->get_guid() == target) {
+                found = n;
+            }
+        });
+        visits += found != nullptr;
+    }));
+    report("find by guid (registry)", time_per_call_us(repeats * 1000, [&]() {
+        visits += NodeRegistry::instance().find(target) != nullptr;
+    }));
+
+    // a long chain: deep enough to overflow a recursive walk
+    const size_t chain_length = num_nodes * 10;
+    std::vector<NodePtr> chain;
+    chain.reserve(chain_length);
+    for (size_t i = 0; i < chain_length; i++) {
+        chain.push_back(std::make_shared<Node>());
+        if (i > 0) {
+            chain[i - 1]->connect(chain[i]);
+        }
+    }
+    report("walk_nodes_backwards, " + std::to_string(chain_length) + "-chain", time_per_call_us(1, [&]() {
+        invalidate();
+        chain[0]->walk_nodes_backwards(count_nodes);
+    }));
+
+    std::cout << "(" << visits << " visits)" << std::endl;
+    return 0;
+}
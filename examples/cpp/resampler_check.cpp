@@ -0,0 +1,136 @@
+/**
+ * Checks PolyphaseResampler and the Resampler node: that a stream
+ * resamples the same however it's chopped up, that it keeps dc and
+ * in-band sines, and where its output sits in time. Exits nonzero if
+ * anything is off.
+ */
+
+#include <cmath>
+#include <iostream>
+#include "roboflex_core/core_messages/core_messages.h"
+#include "roboflex_core/core_nodes/core_nodes.h"
+
+using namespace roboflex;
+
+static int num_failures = 0;
+
+#define CHECK(condition) \
+    if (!(condition)) { \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": FAILED: " #condition << std::endl; \
+        num_failures++; \
+    }
+
+// Resamples input (one channel) in pieces of chunk_size.
+std::vector<double> resample(nodes::PolyphaseResampler<double>& r, const std::vector<double>& input, size_t chunk_size)
+{
+    r.reset(1);
+    std::vector<double> output;
+    for (size_t i = 0; i < input.size(); i += chunk_size) {
+        size_t n = std::min(chunk_size, input.size() - i);
+        std::vector<double> out(r.num_outputs(n));
+        r.process(input.data() + i, n, out.data());
+        output.insert(output.end(), out.begin(), out.end());
+    }
+    return output;
+}
+
+void check_ratio(size_t up, size_t down)
+{
+    const size_t length = 2000;
+    const double frequency = 0.2 * std::min(1.0, double(up) / down) / 2;  // cycles per input sample; well in band
+    nodes::PolyphaseResampler<double> r(up, down);
+
+    std::vector<double> sine(length);
+    std::vector<double> dc(length, 1.0);
+    for (size_t i = 0; i < length; i++) {
+        sine[i] = std::sin(2 * M_PI * frequency * i);
+    }
+
+    // chopping the stream up changes nothing
+    auto whole = resample(r, sine, length);
+    for (size_t chunk_size: {1, 3, 17, 100}) {
+        auto pieces = resample(r, sine, chunk_size);
+        CHECK(pieces.size() == whole.size());
+        bool same = pieces.size() == whole.size();
+        for (size_t k = 0; same && k < whole.size(); k++) {
+            same = std::abs(pieces[k] - whole[k]) < 1e-12;
+        }
+        CHECK(same);
+    }
+
+    // output k is input position k * down / up, once past the filter's start-up
+    r.reset(1);
+    double lag = r.output_lag(length);
+    double expected_count = (length - 1 - lag) * r.get_up() / r.get_down() + 1;
+    CHECK(std::abs(double(whole.size()) - expected_count) < 1.0 + 1e-9);
+
+    size_t settle = r.get_filter().size() / r.get_up() * r.get_up() / r.get_down() + 1;
+    double worst_sine = 0;
+    auto flat = resample(r, dc, length);
+    double worst_dc = 0;
+    for (size_t k = settle; k < whole.size(); k++) {
+        double position = double(k) * r.get_down() / r.get_up();
+        worst_sine = std::max(worst_sine, std::abs(whole[k] - std::sin(2 * M_PI * frequency * position)));
+        worst_dc = std::max(worst_dc, std::abs(flat[k] - 1.0));
+    }
+    CHECK(worst_sine < 0.02);
+    CHECK(worst_dc < 0.01);
+}
+
+void check_node()
+{
+    // 2 channels at 1000 Hz, down to 250 Hz
+    const double rate = 1000.0;
+    auto resampler = std::make_shared<nodes::Resampler<double>>(1, 4, 10, 5.0, rate);
+
+    std::vector<core::MessagePtr> outputs;
+    auto collector = std::make_shared<nodes::CallbackFun>([&](core::MessagePtr m) { outputs.push_back(m); });
+    resampler->connect(collector);
+
+    nodes::PolyphaseResampler<double> reference(1, 4, 10, 5.0);
+    reference.reset(2);
+
+    double timestamp = 100.0;
+    for (int i = 0; i < 10; i++) {
+        const size_t n = 100;
+        xt::xtensor<double, 2> chunk = xt::ones<double>({2, 100}) * double(i);
+        timestamp += n / rate;
+        auto m = core::TensorMessage<double, 2>::Ptr(chunk);
+        m->set_timestamp(timestamp);
+
+        size_t count_before = outputs.size();
+        double lag = reference.output_lag(n);
+        size_t num_out = reference.num_outputs(n);
+        std::vector<double> out(2 * num_out);
+        reference.process(chunk.data(), n, out.data());
+
+        resampler->receive(m);
+        CHECK(outputs.size() == count_before + (num_out > 0 ? 1 : 0));
+        if (num_out == 0 || outputs.size() == count_before) {
+            continue;
+        }
+
+        // named as the input was, so it reads as a rank-2 TensorMessage
+        auto out_message = outputs.back();
+        CHECK((out_message->message_name() == core::TensorMessage<double, 2>::DefaultMessageName));
+        core::TensorMessage<double, 2> tensor_message(*out_message);
+        auto value = tensor_message.value();
+        CHECK(value.shape()[0] == 2 && value.shape()[1] == num_out);
+        CHECK((value(1, num_out - 1) == out[2 * num_out - 1]));
+
+        // stamped as its last sample: the input's, less the filter's lag
+        CHECK(std::abs(out_message->timestamp() - (timestamp - lag / rate)) < 1e-9);
+    }
+}
+
+int main()
+{
+    check_ratio(1, 4);
+    check_ratio(3, 2);
+    check_ratio(2, 1);
+    check_ratio(5, 7);
+    check_node();
+
+    std::cout << (num_failures == 0 ? "PASSED" : "FAILED") << std::endl;
+    return num_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+/**
+ * Checks TimeSynchronizer's matching: feeds it messages with chosen
+ * timestamps, and checks which tuples come out, and what's dropped.
+ * Exits nonzero if anything is off.
+ */
+
+#include <cmath>
+#include <iostream>
+#include "roboflex_core/core_messages/core_messages.h"
+#include "roboflex_core/core_nodes/core_nodes.h"
+
+using namespace roboflex;
+
+static int num_failures = 0;
+
+#define CHECK(condition) \
+    if (!(condition)) { \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": FAILED: " #condition << std::endl; \
+        num_failures++; \
+    }
+
+core::MessagePtr stamped(const std::string& name, double timestamp)
+{
+    auto m = std::make_shared<core::BlankMessage>(name);
+    m->set_timestamp(timestamp);
+    return m;
+}
+
+void check_approximate()
+{
+    auto sync = std::make_shared<nodes::TimeSynchronizer>(0.01);
+    auto a = sync->add_input("a");
+    auto b = sync->add_input("b");
+
+    std::vector<std::vector<core::MessagePtr>> matches;
+    sync->set_callback([&](const std::vector<core::MessagePtr>& match) { matches.push_back(match); });
+
+    std::vector<std::shared_ptr<nodes::SynchronizedMessage>> signalled;
+    auto collector = std::make_shared<nodes::CallbackFun>([&](core::MessagePtr m) {
+        // within the process, what arrives is the SynchronizedMessage itself
+        signalled.push_back(std::dynamic_pointer_cast<nodes::SynchronizedMessage>(m));
+    });
+    sync->connect(collector);
+
+    // within slop: a match, once a has caught up with the pivot (b1)
+    auto a1 = stamped("a1", 1.000);
+    auto b1 = stamped("b1", 1.005);
+    a->receive(a1);
+    b->receive(b1);
+    CHECK(matches.empty());
+    a->receive(stamped("a2", 1.100));
+    CHECK(matches.size() == 1);
+    if (matches.size() == 1) {
+        CHECK(matches[0].size() == 2);
+        CHECK(matches[0][0] == a1);
+        CHECK(matches[0][1] == b1);
+    }
+
+    // a2 is too old for the next pivot (b2), so it's dropped; a3 pivots,
+    // and is matched with b2 once b catches up
+    auto b2 = stamped("b2", 1.500);
+    auto a3 = stamped("a3", 1.504);
+    b->receive(b2);
+    CHECK(sync->get_num_dropped() == 1);
+    a->receive(a3);
+    CHECK(matches.size() == 1);
+    b->receive(stamped("b3", 1.600));
+    CHECK(matches.size() == 2);
+    if (matches.size() == 2) {
+        CHECK(matches[1][0] == a3);
+        CHECK(matches[1][1] == b2);
+    }
+    CHECK(sync->get_num_matched() == 2);
+    CHECK(sync->get_num_dropped() == 1);
+
+    // beyond slop: nothing matches, and the old messages go
+    a->receive(stamped("a4", 1.650));
+    b->receive(stamped("b4", 1.700));
+    a->receive(stamped("a5", 1.800));
+    CHECK(sync->get_num_matched() == 2);
+    CHECK(sync->get_num_dropped() > 1);
+
+    // what's signalled carries the same messages, without copying them
+    CHECK(signalled.size() == 2);
+    if (signalled.size() == 2 && signalled[0] != nullptr) {
+        CHECK(signalled[0]->get_num_messages() == 2);
+        CHECK(signalled[0]->get_names() == std::vector<std::string>({"a", "b"}));
+        CHECK(!signalled[0]->has_embedded_messages());
+        CHECK(signalled[0]->get_message("a") == a1);
+        CHECK(signalled[0]->get_message(size_t(1)) == b1);
+    }
+}
+
+void check_exact()
+{
+    auto sync = std::make_shared<nodes::TimeSynchronizer>(nodes::TimeSynchronizer::Policy::Exact);
+    auto a = sync->add_input("a");
+    auto b = sync->add_input("b");
+
+    size_t num_matches = 0;
+    sync->set_callback([&](const std::vector<core::MessagePtr>&) { num_matches++; });
+
+    // a microsecond apart is not a match
+    a->receive(stamped("a1", 1.0));
+    b->receive(stamped("b1", 1.0 + 1e-6));
+    a->receive(stamped("a2", 2.0));
+    CHECK(num_matches == 0);
+    b->receive(stamped("b2", 2.0));
+    CHECK(num_matches == 1);
+}
+
+void check_embedded()
+{
+    auto sync = std::make_shared<nodes::TimeSynchronizer>(0.01);
+    sync->set_embed_messages(true);
+    auto a = sync->add_input("a");
+    auto b = sync->add_input("b");
+
+    std::shared_ptr<nodes::SynchronizedMessage> signalled;
+    auto collector = std::make_shared<nodes::CallbackFun>([&](core::MessagePtr m) {
+        // as if it had come through a transport: only the bytes
+        signalled = std::make_shared<nodes::SynchronizedMessage>(*m);
+    });
+    sync->connect(collector);
+
+    a->receive(stamped("a1", 1.0));
+    b->receive(stamped("b1", 1.0));
+    CHECK(signalled != nullptr);
+    if (signalled != nullptr) {
+        CHECK(signalled->has_embedded_messages());
+        auto b1 = signalled->get_message("b");
+        CHECK(b1 != nullptr && b1->message_name() == "b1");
+    }
+}
+
+void check_lifetimes()
+{
+    // inputs keep the synchronizer alive, as parents do
+    auto sync = std::make_shared<nodes::TimeSynchronizer>(0.01);
+    std::weak_ptr<nodes::TimeSynchronizer> weak_sync = sync;
+    auto a = sync->add_input("a");
+    auto b = sync->add_input("b");
+    sync.reset();
+    CHECK(!weak_sync.expired());
+    a->receive(stamped("a1", 1.0));
+    a.reset();
+    b.reset();
+    CHECK(weak_sync.expired());
+}
+
+int main()
+{
+    check_approximate();
+    check_exact();
+    check_embedded();
+    check_lifetimes();
+
+    std::cout << (num_failures == 0 ? "PASSED" : "FAILED") << std::endl;
+    return num_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+/**
+ * Checks WindowStatistics against statistics computed directly over each
+ * window, for a signal sitting far from zero (where a naive sum of
+ * squares loses the variance), and that an empty first message signals
+ * nothing. Exits nonzero if anything is off.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include "roboflex_core/core_messages/core_messages.h"
+#include "roboflex_core/core_nodes/core_nodes.h"
+
+using namespace roboflex;
+
+static int num_failures = 0;
+
+#define CHECK(condition) \
+    if (!(condition)) { \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": FAILED: " #condition << std::endl; \
+        num_failures++; \
+    }
+
+bool near(double a, double b, double relative_tolerance)
+{
+    return std::abs(a - b) <= relative_tolerance * std::max(std::abs(b), 1e-300);
+}
+
+void check_against_direct()
+{
+    const size_t window_size = 50;
+    const size_t num_channels = 3;
+    const double offsets[num_channels] = {0.0, 1000.0, -1.0e6};
+    const double noise[num_channels] = {1.0, 1.0e-3, 1.0e-2};
+
+    auto stats = std::make_shared<nodes::WindowStatistics<double>>(window_size);
+    std::shared_ptr<nodes::WindowStatisticsMessage> last;
+    auto collector = std::make_shared<nodes::CallbackFun>([&](core::MessagePtr m) {
+        last = std::make_shared<nodes::WindowStatisticsMessage>(*m);
+    });
+    stats->connect(collector);
+
+    std::mt19937 rng(3);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::vector<std::vector<double>> history(num_channels);
+
+    // chunks of several sizes, across many windows and re-sums
+    size_t chunk_sizes[] = {1, 7, 13, 50, 64};
+    for (int round = 0; round < 40; round++) {
+        size_t n = chunk_sizes[round % 5];
+        xt::xtensor<double, 2> chunk = xt::zeros<double>({num_channels, n});
+        for (size_t c = 0; c < num_channels; c++) {
+            for (size_t j = 0; j < n; j++) {
+                chunk(c, j) = offsets[c] + noise[c] * normal(rng);
+                history[c].push_back(chunk(c, j));
+            }
+        }
+        stats->receive(core::TensorMessage<double, 2>::Ptr(chunk));
+
+        CHECK(last != nullptr);
+        if (last == nullptr) {
+            return;
+        }
+        size_t count = std::min(history[0].size(), window_size);
+        CHECK(last->count() == count);
+
+        for (size_t c = 0; c < num_channels; c++) {
+            auto begin = history[c].end() - count;
+            double mean = 0;
+            for (auto it = begin; it != history[c].end(); it++) {
+                mean += *it;
+            }
+            mean /= count;
+            double variance = 0;
+            for (auto it = begin; it != history[c].end(); it++) {
+                variance += (*it - mean) * (*it - mean);
+            }
+            variance /= count;
+
+            CHECK(near(last->mean()(c), mean, 1e-12));
+            if (count > 1) {
+                CHECK(near(last->variance()(c), variance, 1e-6));
+            }
+            CHECK(last->min()(c) == *std::min_element(begin, history[c].end()));
+            CHECK(last->max()(c) == *std::max_element(begin, history[c].end()));
+        }
+    }
+}
+
+void check_empty_first_message()
+{
+    auto stats = std::make_shared<nodes::WindowStatistics<float>>(10);
+    size_t num_signalled = 0;
+    auto collector = std::make_shared<nodes::CallbackFun>([&](core::MessagePtr) { num_signalled++; });
+    stats->connect(collector);
+
+    stats->receive(core::TensorMessage<float, 2>::Ptr(xt::xtensor<float, 2>(xt::zeros<float>({2, 0}))));
+    CHECK(num_signalled == 0);
+    stats->receive(core::TensorMessage<float, 2>::Ptr(xt::xtensor<float, 2>(xt::ones<float>({2, 3}))));
+    CHECK(num_signalled == 1);
+}
+
+int main()
+{
+    check_against_direct();
+    check_empty_first_message();
+
+    std::cout << (num_failures == 0 ? "PASSED" : "FAILED") << std::endl;
+    return num_failures == 0 ? 0 : 1;
+}
@@ -2,8 +2,11 @@
 #define ROBOFLEX_CORE_CORE__H
 
 #include "node.h"
+#include "node_registry.h"
+#include "graph_snapshot.h"
 #include "message.h"
 #include "core_messages/core_messages.h"
+#include "core_messages/direct_write_message.h"
 #include "serialization/flex_utils.h"
 #include "serialization/flex_tensor_format.h"
 #include "serialization/flex_xtensor.h"
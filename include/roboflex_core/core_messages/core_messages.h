@@ -57,7 +57,7 @@ public:
     }
 
     const string message() const {
-        return root_map()["s"].AsString().str();
+        return root_val(serialization::FlexKey("s")).AsString().str();
     }
 
     void print_on(ostream& os) const override {
@@ -84,7 +84,7 @@ public:
     }
 
     float value() const {
-        return root_map()["v"].AsFloat();
+        return root_val(serialization::FlexKey("v")).AsFloat();
     }
 
     void print_on(ostream& os) const override {
@@ -111,7 +111,7 @@ public:
     }
 
     float value() const {
-        return root_map()["v"].AsDouble();
+        return root_val(serialization::FlexKey("v")).AsDouble();
     }
 
     void print_on(ostream& os) const override {
@@ -132,11 +132,16 @@ public:
 
     inline static const string DefaultMessageName = "TensorMessage";
     inline static const string DefaultKey = "t";
+    static constexpr serialization::FlexKey DefaultFlexKey{"t"};
 
-    TensorMessage(Message& other, const string& key="t"): Message(other), key(key) {}
+    // Nodes that wrap many messages should resolve their key once, and
+    // use this one.
+    TensorMessage(Message& other, const serialization::FlexKey& key=DefaultFlexKey): Message(other), key(key.to_string()), key_handle(key) {}
+    TensorMessage(Message& other, const string& key): TensorMessage(other, serialization::FlexKey::intern(key, DefaultFlexKey)) {}
+    TensorMessage(Message& other, const char* key): TensorMessage(other, string(key)) {}
 
     TensorMessage(const xt::xtensor<T, Rank>& matrix, const string& message_name=DefaultMessageName, const string& key=DefaultKey):
-        Message(CoreModuleName, message_name, nullptr), key(key)
+        Message(CoreModuleName, message_name, nullptr), key(key), key_handle(serialization::FlexKey::intern(key, DefaultFlexKey))
     {
         flexbuffers::Builder fbb = get_builder();
         WriteMapRoot(fbb, [&](){
@@ -145,7 +150,7 @@ public:
     }
 
     TensorMessage(const std::array<size_t, Rank>& shape, const string& message_name=DefaultMessageName, const string& key=DefaultKey):
-        Message(message_name, nullptr), key(key)
+        Message(message_name, nullptr), key(key), key_handle(serialization::FlexKey::intern(key, DefaultFlexKey))
     {
         flexbuffers::Builder fbb = get_builder();
         WriteMapRoot(fbb, [&](){
@@ -165,8 +170,7 @@ public:
     }
 
     void print_on(ostream& os) const override {
-        auto root = root_map()[this->key].AsMap();
-        auto dtype = root["dtype"].AsInt8();
+        auto dtype = serialization::tensor_type_code(root_val(this->key_handle));
         os << "<TensorMessage" << " key:" << this->key 
            << " shape:" << xt::adapt(this->value().shape()) 
            << " dtype:" << serialization::type_name_from_code(dtype) 
@@ -176,7 +180,7 @@ public:
     }
 
     const serialization::flextensor_adaptor<T> value() const {
-        auto root = root_map()[this->key];
+        auto root = root_val(this->key_handle);
         return serialization::deserialize_flex_tensor<T, Rank>(root);
     }
 
@@ -184,10 +188,10 @@ public:
     void set_value(const xt::xtensor<T, Rank>& x) {
 
         // my root must be a map that obeys our tensor format
-        auto root = root_map()[this->key].AsMap();
+        auto root = root_val(this->key_handle).AsMap();
 
         // get, ultimately, a pointer to the data that backs the tensor
-        auto tensor_data_portion = root["data"].AsBlob();
+        auto tensor_data_portion = serialization::lookup(root, serialization::DataFlexKey).AsBlob();
         const uint8_t* tensor_const_data = tensor_data_portion.data();
         uint8_t* tensor_data = const_cast<uint8_t*>(tensor_const_data);
 
@@ -205,10 +209,10 @@ public:
     void set_value(const xt::xfunction<whatever...>& f) {
 
         // my root must be a map that obeys our tensor format
-        auto root = root_map()[this->key].AsMap();
+        auto root = root_val(this->key_handle).AsMap();
 
         // get, ultimately, a pointer to the data that backs the tensor
-        auto tensor_data_portion = root["data"].AsBlob();
+        auto tensor_data_portion = serialization::lookup(root, serialization::DataFlexKey).AsBlob();
         const uint8_t* tensor_const_data = tensor_data_portion.data();
         uint8_t* tensor_data = const_cast<uint8_t*>(tensor_const_data);
         T * data_typed = (T*)tensor_data;
@@ -229,6 +233,72 @@ public:
 protected:
 
     string key;
+    serialization::FlexKey key_handle;
+};
+
+/**
+ * Carries a single float32 tensor under some map key, transmitted in
+ * reduced precision (float16 or bfloat16): half the bytes, at the cost of
+ * precision. value() converts back to float32, on demand.
+ */
+template <size_t Rank>
+class ReducedPrecisionTensorMessage: public Message {
+public:
+
+    inline static const string DefaultMessageName = "ReducedPrecisionTensorMessage";
+    inline static const string DefaultKey = "t";
+    static constexpr serialization::FlexKey DefaultFlexKey{"t"};
+
+    ReducedPrecisionTensorMessage(Message& other, const serialization::FlexKey& key=DefaultFlexKey): Message(other), key(key.to_string()), key_handle(key) {}
+    ReducedPrecisionTensorMessage(Message& other, const string& key): ReducedPrecisionTensorMessage(other, serialization::FlexKey::intern(key, DefaultFlexKey)) {}
+    ReducedPrecisionTensorMessage(Message& other, const char* key): ReducedPrecisionTensorMessage(other, string(key)) {}
+
+    ReducedPrecisionTensorMessage(
+        const xt::xtensor<float, Rank>& tensor,
+        serialization::ReducedPrecision precision = serialization::ReducedPrecision::Float16,
+        const string& message_name=DefaultMessageName,
+        const string& key=DefaultKey):
+            Message(CoreModuleName, message_name, nullptr), key(key), key_handle(serialization::FlexKey::intern(key, DefaultFlexKey))
+    {
+        flexbuffers::Builder fbb = get_builder();
+        WriteMapRoot(fbb, [&](){
+            serialization::serialize_flex_tensor_reduced<Rank>(fbb, tensor, precision, key);
+        });
+    }
+
+    static shared_ptr<ReducedPrecisionTensorMessage> Ptr(
+        const xt::xtensor<float, Rank>& tensor,
+        serialization::ReducedPrecision precision = serialization::ReducedPrecision::Float16,
+        const string& message_name=DefaultMessageName,
+        const string& key=DefaultKey) {
+        return std::make_shared<ReducedPrecisionTensorMessage<Rank>>(tensor, precision, message_name, key);
+    }
+
+    void print_on(ostream& os) const override {
+        auto root = root_val(this->key_handle);
+        os << "<ReducedPrecisionTensorMessage" << " key:" << this->key
+           << " shape:" << serialization::shape_to_string(serialization::tensor_shape(root))
+           << " dtype:" << serialization::tensor_type_name(root)
+           << " ";
+        Message::print_on(os);
+        os << ">";
+    }
+
+    // Converts to a new float32 tensor.
+    xt::xtensor<float, Rank> value() const {
+        return serialization::deserialize_flex_tensor_as_float<Rank>(root_val(this->key_handle));
+    }
+
+    // The float16 or bfloat16 tensor, as sent, without copying.
+    template <typename T>
+    const serialization::flextensor_adaptor<T> reduced_value() const {
+        return serialization::deserialize_flex_tensor<T, Rank>(root_val(this->key_handle));
+    }
+
+protected:
+
+    string key;
+    serialization::FlexKey key_handle;
 };
 
 /**
@@ -240,11 +310,14 @@ public:
 
     inline static const string DefaultMessageName = "EigenMessage";
     inline static const string DefaultKey = "t";
+    static constexpr serialization::FlexKey DefaultFlexKey{"t"};
 
-    EigenMessage(Message& other, const string& key="t"): Message(other), key(key) {}
+    EigenMessage(Message& other, const serialization::FlexKey& key=DefaultFlexKey): Message(other), key(key.to_string()), key_handle(key) {}
+    EigenMessage(Message& other, const string& key): EigenMessage(other, serialization::FlexKey::intern(key, DefaultFlexKey)) {}
+    EigenMessage(Message& other, const char* key): EigenMessage(other, string(key)) {}
 
     EigenMessage(const Eigen::Matrix<T, NRows, NCols, Options>& matrix, const string& message_name=DefaultMessageName, const string& key=DefaultKey):
-        Message(CoreModuleName, message_name, nullptr), key(key)
+        Message(CoreModuleName, message_name, nullptr), key(key), key_handle(serialization::FlexKey::intern(key, DefaultFlexKey))
     {
         flexbuffers::Builder fbb = get_builder();
         WriteMapRoot(fbb, [&](){
@@ -257,8 +330,7 @@ public:
     }
 
     void print_on(ostream& os) const override {
-        auto root = root_map()[this->key].AsMap();
-        auto dtype = root["dtype"].AsInt8();
+        auto dtype = serialization::tensor_type_code(root_val(this->key_handle));
         os << "<EigenMessage" << " key:" << this->key 
            << " shape: ()" << NRows << ", " << NCols << ")"
            << " dtype:" << serialization::type_name_from_code(dtype) 
@@ -268,13 +340,14 @@ public:
     }
 
     const Eigen::Map<const Eigen::Matrix<T, NRows, NCols, Options>> value() const {
-        auto root = root_val(this->key);
+        auto root = root_val(this->key_handle);
         return serialization::deserialize_eigen_matrix<T, NRows, NCols, Options>(root);
     }
 
 protected:
 
     string key;
+    serialization::FlexKey key_handle;
 };
 
 
@@ -287,13 +360,19 @@ protected:
 template <typename T>
 class TensorBufferMessage: public Message {
 public:
+
+    static constexpr serialization::FlexKey DefaultBufferFlexKey{"buffer"};
+    static constexpr serialization::FlexKey DefaultCountFlexKey{"count"};
+
     TensorBufferMessage(
         Message& other, 
         const string& buffer_key="buffer", 
         const string& count_key="count"): 
             Message(other),
             buffer_key(buffer_key),
-            count_key(count_key) {}
+            count_key(count_key),
+            buffer_key_handle(serialization::FlexKey::intern(buffer_key, DefaultBufferFlexKey)),
+            count_key_handle(serialization::FlexKey::intern(count_key, DefaultCountFlexKey)) {}
 
     TensorBufferMessage(
         const xt::xarray<T>& matrix, 
@@ -302,7 +381,9 @@ public:
         const string& count_key="count"):
             Message(CoreModuleName, "TensorBuffer"),
             buffer_key(buffer_key),
-            count_key(count_key)
+            count_key(count_key),
+            buffer_key_handle(serialization::FlexKey::intern(buffer_key, DefaultBufferFlexKey)),
+            count_key_handle(serialization::FlexKey::intern(count_key, DefaultCountFlexKey))
     {
         flexbuffers::Builder fbb = get_builder();
         WriteMapRoot(fbb, [&](){
@@ -312,18 +393,20 @@ public:
     }
 
     const serialization::flextensor_adaptor<T> buffer() const {
-        auto root = root_map()[buffer_key];
+        auto root = root_val(buffer_key_handle);
         return serialization::deserialize_flex_array<T>(root);
     }
 
     uint64_t count() const {
-        return root_map()[count_key].AsUInt64();
+        return root_val(count_key_handle).AsUInt64();
     }
 
 protected:
 
     string buffer_key;
     string count_key;
+    serialization::FlexKey buffer_key_handle;
+    serialization::FlexKey count_key_handle;
 };
 
 constexpr char PingMessageName[] = "ping";
@@ -0,0 +1,308 @@
+#ifndef ROBOFLEX_CORE_DIRECT_WRITE_MESSAGE__H
+#define ROBOFLEX_CORE_DIRECT_WRITE_MESSAGE__H
+
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <xtensor/containers/xadapt.hpp>
+#include <Eigen/Dense>
+#include "flatbuffers/flexbuffers.h"
+#include "roboflex_core/message.h"
+#include "roboflex_core/serialization/flex_tensor_format.h"
+
+namespace roboflex::core {
+
+/**
+ * Identifies a tensor declared in a MessageLayout. Hand it to
+ * DirectWriteMessage::view to get at the tensor's memory.
+ */
+template <typename T, size_t Rank>
+struct TensorSlot {
+    size_t index;
+    std::array<size_t, Rank> shape;
+};
+
+/**
+ * Like TensorSlot, for a tensor whose rank is only known at runtime.
+ */
+template <typename T>
+struct ArraySlot {
+    size_t index;
+    std::vector<size_t> shape;
+};
+
+/**
+ * Identifies a scalar declared in a MessageLayout: one of int64_t,
+ * uint64_t, double or bool. Hand it to DirectWriteMessage::set.
+ */
+template <typename T>
+struct ScalarSlot {
+    static_assert(
+        std::is_same_v<T, int64_t> || std::is_same_v<T, uint64_t> ||
+        std::is_same_v<T, double> || std::is_same_v<T, bool>,
+        "scalar slots hold int64_t, uint64_t, double or bool");
+    size_t index;
+};
+
+/**
+ * Describes the contents of a DirectWriteMessage: any number of tensors,
+ * of any dtype and rank, under their own keys, plus scalars. Tensors and
+ * scalar slots are only declared here - their values get written later,
+ * in place, in each message.
+ *
+ * A layout can be reused for any number of messages. The add_int etc.
+ * fields are constants: every message built from the layout gets the
+ * same value. Use a scalar slot for anything that changes per message.
+ */
+class MessageLayout {
+public:
+
+    template <typename T, size_t Rank>
+    TensorSlot<T, Rank> add_tensor(const string& key, const std::array<size_t, Rank>& shape) {
+        size_t index = add_tensor_writer<T>(key, std::vector<uint64_t>(shape.begin(), shape.end()));
+        return TensorSlot<T, Rank>{index, shape};
+    }
+
+    template <typename T>
+    ArraySlot<T> add_array(const string& key, const std::vector<size_t>& shape) {
+        size_t index = add_tensor_writer<T>(key, std::vector<uint64_t>(shape.begin(), shape.end()));
+        return ArraySlot<T>{index, shape};
+    }
+
+    // A scalar that each message sets for itself; zero until it does.
+    template <typename T>
+    ScalarSlot<T> add_scalar(const string& key) {
+        size_t index = scalar_keys.size();
+        scalar_keys.push_back(serialization::FlexKey::intern(key));
+
+        // Written as the widest value of its type, so that the map's
+        // values are 8 bytes wide and any value can replace it in place.
+        add_field([key](flexbuffers::Builder& fbb) {
+            if constexpr (std::is_same_v<T, bool>) {
+                fbb.Bool(key.c_str(), false);
+            } else if constexpr (std::is_same_v<T, double>) {
+                fbb.Double(key.c_str(), std::numeric_limits<double>::max());
+            } else if constexpr (std::is_same_v<T, int64_t>) {
+                fbb.Int(key.c_str(), std::numeric_limits<int64_t>::min());
+            } else {
+                fbb.UInt(key.c_str(), std::numeric_limits<uint64_t>::max());
+            }
+        });
+        return ScalarSlot<T>{index};
+    }
+
+    void add_int(const string& key, int64_t v) { add_field([key, v](flexbuffers::Builder& fbb) { fbb.Int(key.c_str(), v); }); }
+    void add_uint(const string& key, uint64_t v) { add_field([key, v](flexbuffers::Builder& fbb) { fbb.UInt(key.c_str(), v); }); }
+    void add_double(const string& key, double v) { add_field([key, v](flexbuffers::Builder& fbb) { fbb.Double(key.c_str(), v); }); }
+    void add_bool(const string& key, bool v) { add_field([key, v](flexbuffers::Builder& fbb) { fbb.Bool(key.c_str(), v); }); }
+    void add_string(const string& key, const string& v) { add_field([key, v](flexbuffers::Builder& fbb) { fbb.String(key.c_str(), v); }); }
+
+    size_t get_num_tensors() const { return num_tensors; }
+    const std::vector<serialization::FlexKey>& get_scalar_keys() const { return scalar_keys; }
+
+    // Writes everything into the builder, and records where each
+    // tensor's data ended up.
+    void write(flexbuffers::Builder& fbb, std::vector<size_t>& data_offsets) const {
+        data_offsets.assign(num_tensors, 0);
+        for (auto& writer: writers) {
+            writer(fbb, data_offsets);
+        }
+    }
+
+protected:
+
+    using Writer = std::function<void(flexbuffers::Builder&, std::vector<size_t>&)>;
+
+    template <typename T>
+    size_t add_tensor_writer(const string& key, const std::vector<uint64_t>& shape_vector) {
+        static_assert(serialization::tensor_dtype_indexer<T>::index >= 0, "unsupported tensor dtype");
+        size_t num_elements = 1;
+        for (auto s: shape_vector) {
+            num_elements *= s;
+        }
+        size_t index = num_tensors++;
+        size_t num_bytes = num_elements * sizeof(T);
+        writers.push_back([key, shape_vector, num_bytes, index](flexbuffers::Builder& fbb, std::vector<size_t>& data_offsets) {
+            fbb.Key(key);
+            fbb.Map([&]() {
+                fbb.Key(serialization::ShapeKey);
+                fbb.Vector(shape_vector);
+                fbb.Key(serialization::DataKey);
+                serialization::pad_for_aligned_blob(fbb, num_bytes);
+                fbb.Blob(nullptr, num_bytes);
+                // The blob's data is the last thing written. Offsets are from
+                // the start of the buffer, which survive the buffer moving.
+                data_offsets[index] = fbb.GetSize() - num_bytes;
+                fbb.Int(serialization::DTypeKey, serialization::tensor_dtype_indexer<T>::index);
+                fbb.Int(serialization::AlignKey, serialization::TensorDataAlignment);
+            });
+        });
+        return index;
+    }
+
+    void add_field(std::function<void(flexbuffers::Builder&)> f) {
+        writers.push_back([f](flexbuffers::Builder& fbb, std::vector<size_t>&) { f(fbb); });
+    }
+
+    std::vector<Writer> writers;
+    size_t num_tensors = 0;
+    std::vector<serialization::FlexKey> scalar_keys;
+};
+
+/**
+ * A message built from a MessageLayout in one pass, whose tensors are then
+ * filled in place: producers write sensor data (or evaluate xtensor
+ * expressions) straight into the final buffer, exactly once, instead of
+ * computing into an xtensor and copying it in.
+ *
+ *   // once
+ *   MessageLayout layout;
+ *   auto rgb = layout.add_tensor<uint8_t, 3>("rgb", {480, 640, 3});
+ *   auto depth = layout.add_tensor<float, 2>("depth", {480, 640});
+ *   auto frame_id = layout.add_scalar<uint64_t>("frame_id");
+ *   layout.add_string("camera", serial_number);
+ *
+ *   // per frame
+ *   auto m = std::make_shared<DirectWriteMessage>("camera", "frame", layout);
+ *   camera.read_color_into(m->view(rgb).data());
+ *   m->view(depth) = raw_depth * depth_scale;
+ *   m->set(frame_id, camera.frame_id());
+ *   signal(m);
+ *
+ * On the wire this is an ordinary message: tensors are in the usual
+ * tensor format (aligned - see serialize_flex_tensor), so receivers
+ * read them with TensorMessage, deserialize_flex_tensor, etc.
+ *
+ * Tensor data is uninitialized until written; scalar slots are zero.
+ * Views are valid as long as the message's payload is.
+ */
+class DirectWriteMessage: public Message {
+public:
+    DirectWriteMessage(const string& module_name, const string& message_name, const MessageLayout& layout):
+        Message(module_name, message_name)
+    {
+        flexbuffers::Builder fbb = get_builder();
+        WriteMapRoot(fbb, [&](){
+            layout.write(fbb, data_offsets);
+        });
+
+        auto root = root_map();
+        for (auto& key: layout.get_scalar_keys()) {
+            scalar_positions.push_back(serialization::lookup_index(root, key));
+        }
+        for (size_t i = 0; i < scalar_positions.size(); i++) {
+            auto r = scalar_at(i);
+            if (r.IsBool()) {
+                r.MutateBool(false);
+            } else if (r.IsFloat()) {
+                r.MutateFloat(0.0);
+            } else if (r.IsInt()) {
+                r.MutateInt(0);
+            } else {
+                r.MutateUInt(0);
+            }
+        }
+    }
+
+    // Writes a scalar slot's value, in place.
+    template <typename T>
+    void set(const ScalarSlot<T>& slot, T v) {
+        auto r = scalar_at(slot.index);
+        bool written;
+        if constexpr (std::is_same_v<T, bool>) {
+            written = r.MutateBool(v);
+        } else if constexpr (std::is_same_v<T, double>) {
+            written = r.MutateFloat(v);
+        } else if constexpr (std::is_same_v<T, int64_t>) {
+            written = r.MutateInt(v);
+        } else {
+            written = r.MutateUInt(v);
+        }
+        if (!written) {
+            throw std::runtime_error("DirectWriteMessage could not write scalar slot " + std::to_string(slot.index));
+        }
+    }
+
+    template <typename T>
+    T get(const ScalarSlot<T>& slot) const {
+        auto r = scalar_at(slot.index);
+        if constexpr (std::is_same_v<T, bool>) {
+            return r.AsBool();
+        } else if constexpr (std::is_same_v<T, double>) {
+            return r.AsDouble();
+        } else if constexpr (std::is_same_v<T, int64_t>) {
+            return r.AsInt64();
+        } else {
+            return r.AsUInt64();
+        }
+    }
+
+    template <typename T, size_t Rank>
+    T* data(const TensorSlot<T, Rank>& slot) {
+        return data_at<T>(slot.index);
+    }
+
+    // A writable, non-owning xtensor adaptor over the tensor's data.
+    template <typename T, size_t Rank>
+    auto view(const TensorSlot<T, Rank>& slot) {
+        size_t num_elements = 1;
+        for (auto s: slot.shape) {
+            num_elements *= s;
+        }
+        return xt::adapt(data(slot), num_elements, xt::no_ownership(), slot.shape);
+    }
+
+    template <typename T>
+    T* data(const ArraySlot<T>& slot) {
+        return data_at<T>(slot.index);
+    }
+
+    template <typename T>
+    auto view(const ArraySlot<T>& slot) {
+        size_t num_elements = 1;
+        for (auto s: slot.shape) {
+            num_elements *= s;
+        }
+        return xt::adapt(data(slot), num_elements, xt::no_ownership(), slot.shape);
+    }
+
+    // A writable Eigen::Map over a rank-2 tensor's data. Defaults to
+    // column-major, to agree with serialize_eigen_matrix and EigenMessage.
+    template <int Options = Eigen::ColMajor, typename T>
+    Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Options>, Eigen::Aligned64> eigen_view(const TensorSlot<T, 2>& slot) {
+        return Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Options>, Eigen::Aligned64>(
+            data(slot), slot.shape[0], slot.shape[1]);
+    }
+
+    void print_on(ostream& os) const override {
+        os << "<DirectWriteMessage tensors: " << data_offsets.size() << " ";
+        Message::print_on(os);
+        os << ">";
+    }
+
+protected:
+
+    template <typename T>
+    T* data_at(size_t index) {
+        if (index >= data_offsets.size()) {
+            throw std::runtime_error("DirectWriteMessage has no tensor slot " + std::to_string(index));
+        }
+        return reinterpret_cast<T*>(get_raw_data() + data_offsets[index]);
+    }
+
+    flexbuffers::Reference scalar_at(size_t index) const {
+        if (index >= scalar_positions.size()) {
+            throw std::runtime_error("DirectWriteMessage has no scalar slot " + std::to_string(index));
+        }
+        return root_map().Values()[scalar_positions[index]];
+    }
+
+    std::vector<size_t> data_offsets;
+
+    // where each scalar slot is in the root map
+    std::vector<int> scalar_positions;
+};
+
+} // roboflex::core
+
+#endif // ROBOFLEX_CORE_DIRECT_WRITE_MESSAGE__H
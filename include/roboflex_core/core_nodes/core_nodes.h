@@ -8,20 +8,29 @@
 #include "roboflex_core/core_nodes/take.h"
 #include "roboflex_core/core_nodes/null.h"
 #include "roboflex_core/core_nodes/producer.h"
+#include "roboflex_core/core_nodes/pipeline.h"
 
 // queuing
 #include "roboflex_core/core_nodes/last_one.h"
 #include "roboflex_core/core_nodes/tensor_buffer.h"
+#include "roboflex_core/core_nodes/tensor_batcher.h"
+#include "roboflex_core/core_nodes/window_statistics.h"
+#include "roboflex_core/core_nodes/resampler.h"
+#include "roboflex_core/core_nodes/timestamp_merge.h"
+#include "roboflex_core/core_nodes/time_synchronizer.h"
 
 // various utilities
 #include "roboflex_core/core_nodes/every_n.h"
 #include "roboflex_core/core_nodes/frequency_generator.h"
 #include "roboflex_core/core_nodes/message_printer.h"
 #include "roboflex_core/core_nodes/metrics.h"
+#include "roboflex_core/core_nodes/metrics_exporter.h"
+#include "roboflex_core/core_nodes/rpc_router.h"
 
 // fast message record and playback
 #include "roboflex_core/core_nodes/universal_data_saver.h"
 #include "roboflex_core/core_nodes/universal_data_player.h"
+#include "roboflex_core/core_nodes/tensor_codec.h"
 
 // super useful - can perform profiling, graph re-writing, more.
 #include "roboflex_core/core_nodes/graph_root.h"
@@ -3,38 +3,134 @@
 
 #include <iostream>
 #include <atomic>
+#include <mutex>
 #include "roboflex_core/node.h"
+#include "roboflex_core/core_nodes/metrics.h"
+#include "roboflex_core/util/timer_service.h"
 
 namespace roboflex {
 using namespace core;
 namespace nodes {
 
+/**
+ * What a FrequencyGenerator does when the nodes downstream
+ * of it report congestion (see Node::get_congestion):
+ *
+ *   None: nothing, keep triggering at the set frequency.
+ *   Skip: skip triggers while congested.
+ *   Throttle: halve the frequency on every congested trigger (down
+ *     to 1/16th of the set frequency), and recover it gradually
+ *     once downstream catches up.
+ */
+enum class BackpressurePolicy {
+    None,
+    Skip,
+    Throttle
+};
+
+/**
+ * What a FrequencyGenerator does when it wakes up more than one
+ * period after a trigger's deadline (because on_trigger, or something
+ * downstream of it, took too long):
+ *
+ *   Skip: drop the missed triggers, and resume on the next deadline
+ *     that is still in the future.
+ *   CatchUp: fire every missed trigger, back-to-back, until caught up.
+ */
+enum class OverrunPolicy {
+    Skip,
+    CatchUp
+};
+
 /**
  * This node signals BlankMessage at the frequency specified 
  * in the constructor.
  * 
  * Supports sub-classing, since child nodes might want
  * to just "be" a frequency trigger and override on_trigger. 
+ * Child nodes that can degrade gracefully (reduce resolution,
+ * etc) may also override on_backpressure, which is called
+ * on every trigger while downstream is congested.
+ *
+ * Triggers are scheduled on absolute deadlines (start + n * period),
+ * so wake-up jitter does not accumulate. The lateness of every trigger
+ * is tracked as jitter, and deadlines that could not be met are counted.
+ *
+ * With set_use_timer_service(true), start() registers the generator with
+ * the process-wide TimerService instead of launching a thread: many
+ * generators then share a couple of threads, at one-tick (1ms) accuracy.
+ * In that mode missed periods are always skipped, and jitter is not tracked.
  */
 class FrequencyGenerator: public RunnableNode {
 public:
     FrequencyGenerator(
         const float frequency_hz,
         const std::string& name = "FrequencyGenerator");
+    ~FrequencyGenerator();
+
+    static const RpcTable& class_rpc_table();
+    const RpcTable& get_rpc_table() const override { return class_rpc_table(); }
+
+    void start() override;
+    void stop_and_join() override;
+
+    // Takes effect on the next start().
+    void set_use_timer_service(bool use_timer_service) { this->use_timer_service = use_timer_service; }
+    bool get_use_timer_service() const { return use_timer_service; }
 
     void set_frequency(float new_frequency_hz);
     float get_frequency() const { return frequency_hz;  }
 
-    MessagePtr handle_rpc(MessagePtr rpc_message) override;
+    void set_backpressure(BackpressurePolicy policy, float congestion_threshold = 1.0);
+    BackpressurePolicy get_backpressure_policy() const { return backpressure_policy; }
+    float get_congestion_threshold() const { return congestion_threshold; }
+    uint64_t get_num_skipped_triggers() const { return num_skipped_triggers; }
+
+    void set_overrun_policy(OverrunPolicy policy) { overrun_policy = policy; }
+    OverrunPolicy get_overrun_policy() const { return overrun_policy; }
+
+    // Busy-wait for the last spin_tail_seconds before each deadline, for
+    // sub-100us accuracy at the cost of cpu. Default is 0: no spinning.
+    void set_spin_tail(double spin_tail_seconds);
+    double get_spin_tail() const { return spin_tail_ns / 1.0e9; }
+
+    // Lateness of triggers, in seconds, relative to their deadlines.
+    MetricTracker get_jitter() const;
+    uint64_t get_num_missed_deadlines() const { return num_missed_deadlines; }
+    void reset_timing_stats();
+
     std::string to_string() const override;
 
 protected:
     void child_thread_fn() override;
 
     virtual void on_trigger(double wall_clock_time);
+    virtual void on_backpressure(float /*downstream_congestion*/) {}
+
+    // returns true if this trigger should be skipped
+    bool apply_backpressure();
+
+    // Called by the TimerService, when we use it.
+    void on_timer();
 
     std::atomic<float> frequency_hz;
     uint32_t invocation_count;
+
+    // The frequency last set by the user; throttling never goes above it.
+    std::atomic<float> nominal_frequency_hz;
+    std::atomic<BackpressurePolicy> backpressure_policy = BackpressurePolicy::None;
+    std::atomic<float> congestion_threshold = 1.0;
+    std::atomic<uint64_t> num_skipped_triggers = 0;
+
+    std::atomic<OverrunPolicy> overrun_policy = OverrunPolicy::Skip;
+    std::atomic<int64_t> spin_tail_ns = 0;
+    std::atomic<uint64_t> num_missed_deadlines = 0;
+    mutable std::mutex jitter_mutex;
+    MetricTracker jitter;
+
+    bool use_timer_service = false;
+    util::TimerService::TimerId timer_id = 0;
+    float timer_frequency_hz = 0;
 };
 
 // some rpc names
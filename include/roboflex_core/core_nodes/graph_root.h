@@ -1,6 +1,8 @@
 #ifndef ROBOFLEX_GRAPH_ROOT_NODE__H
 #define ROBOFLEX_GRAPH_ROOT_NODE__H
 
+#include <map>
+#include <optional>
 #include "roboflex_core/node.h"
 #include "roboflex_core/core_nodes/frequency_generator.h"
 
@@ -56,6 +58,12 @@ public:
 
     bool is_metrics_instrumented() const { return metrics_instrumented; }
 
+    // Thread configs to apply to RunnableNodes when start_all starts them.
+    // A config set for a node's name wins over the default config. Nodes
+    // that match neither keep whatever config they were given directly.
+    void set_node_thread_config(const string& node_name, const util::ThreadConfig& config) { thread_configs[node_name] = config; }
+    void set_default_thread_config(const util::ThreadConfig& config) { default_thread_config = config; }
+
 protected:
 
     void instrument_metrics();
@@ -74,6 +82,11 @@ protected:
     bool debug;
 
     RunnableNodePtr _node_to_run = nullptr;
+
+    std::map<string, util::ThreadConfig> thread_configs;
+    std::optional<util::ThreadConfig> default_thread_config;
+
+    void apply_thread_config_to(RunnableNodePtr rn) const;
 };
 
 
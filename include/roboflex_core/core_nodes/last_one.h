@@ -1,43 +1,66 @@
 #ifndef ROBOFLEX_NODES_LAST_ONE__H
 #define ROBOFLEX_NODES_LAST_ONE__H
 
-#include <atomic>
-#include <mutex>
 #include "roboflex_core/node.h"
+#include "roboflex_core/util/latest_value.h"
 
-using std::atomic, std::string;
+using std::string;
 
 namespace roboflex {
 using namespace core;
 namespace nodes {
 
 /**
- * A Node that remembers the last message.
+ * A Node that remembers the last message. Reading it takes no lock, so
+ * it can be polled as fast as you like without holding up the thread
+ * that delivers messages.
  */
 class LastOne: public Node {
 public:
     LastOne(const string& name = "LastOne"):
         Node(name) {}
 
-    MessagePtr get_last_message() { 
-        std::lock_guard<std::recursive_mutex> lock(last_message_mutex); 
-        return last_message; 
+    MessagePtr get_last_message() const {
+        return last_message.load();
     }
 
     void receive(MessagePtr m) override {
-        {
-            std::lock_guard<std::recursive_mutex> lock(last_message_mutex);
-            last_message = m;
-        }
+        last_message.store(m);
         this->signal(m);
     }
 
 protected:
 
-    // Requires gcc 12.1... do we force upgrade to 12.1?
-    // atomic<MessagePtr> last_message;
-    mutable std::recursive_mutex last_message_mutex;
-    MessagePtr last_message = nullptr;
+    util::LatestValue<Message> last_message;
+};
+
+/**
+ * A Node that remembers the last message of each message_name, such as
+ * from a stream that carries several kinds. Like LastOne, reading takes
+ * no lock.
+ */
+class LastOneByName: public Node {
+public:
+    LastOneByName(const string& name = "LastOneByName"):
+        Node(name) {}
+
+    // nullptr if no message of that name has come yet
+    MessagePtr get_last_message(const string& message_name) const {
+        return last_messages.load(message_name);
+    }
+
+    std::vector<string> get_message_names() const {
+        return last_messages.keys();
+    }
+
+    void receive(MessagePtr m) override {
+        last_messages.store(m->message_name(), m);
+        this->signal(m);
+    }
+
+protected:
+
+    util::KeyedLatestValue<Message> last_messages;
 };
 
 } // namespace nodes
@@ -1,14 +1,20 @@
 #ifndef ROBOFLEX_METRICS_NODE__H
 #define ROBOFLEX_METRICS_NODE__H
 
+#include <array>
 #include <iostream>
+#include <atomic>
 #include <mutex>
 #include <map>
 #include "roboflex_core/node.h"
 #include "roboflex_core/serialization/flex_utils.h"
+#include "roboflex_core/serialization/flex_schema.h"
 #include "roboflex_core/util/uuid.h"
+#include "roboflex_core/util/uuid_map.h"
+#include "roboflex_core/util/timer_service.h"
 
 namespace roboflex {
+using namespace core;
 namespace nodes {
 
 using std::map, std::string, sole::uuid;
@@ -17,12 +23,22 @@ using std::map, std::string, sole::uuid;
 /**
  * Client calls record_value multiple times, passing in a double value,
  * and this class tracks the mean, min, max, count, sum, and variance of that value.
+ *
+ * It can also keep a histogram, once enable_histogram is called: how many
+ * values fell in each bucket of HistogramBounds (at most that bound, and
+ * more than the one before), and last, how many were above them all.
+ * The bounds suit durations, in seconds.
  */
 struct MetricTracker {
+    static constexpr std::array<double, 19> HistogramBounds = {
+        0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005,
+        0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0 };
+
     MetricTracker();
     MetricTracker(unsigned int count, double total, double mean_value, double m2_value, double max_value, double min_value);
     void record_value(double value);
     void reset();
+    void enable_histogram() { bucket_counts.assign(HistogramBounds.size() + 1, 0); }
     double variance_value() const { return count == 0 ? count : m2_value/count; };
 
     void print_on(ostream& os) const;
@@ -37,6 +53,44 @@ struct MetricTracker {
     double m2_value;
     double max_value;
     double min_value;
+
+    // empty unless enable_histogram was called
+    std::vector<uint64_t> bucket_counts;
+};
+
+
+/**
+ * Follows the message counters of one source, to tell lost messages apart
+ * from reordered and duplicated ones. It remembers which of the last
+ * WindowSize counters (up to the highest seen) have arrived, in a bitmap.
+ * A counter that arrives late but within the window is reordered; one
+ * that's still missing when it falls out of the window is lost - so a
+ * loss is only counted once it can no longer be a reordering.
+ *
+ * A counter that goes back further than the window means the source
+ * started over (a restarted process, say): that's no loss, and tracking
+ * starts again from there.
+ */
+struct SequenceTracker {
+    static constexpr uint64_t WindowSize = 64;
+
+    struct Update {
+        uint64_t lost = 0;
+        uint64_t reordered = 0;
+        uint64_t duplicates = 0;
+        bool restarted = false;
+    };
+
+    Update record(uint64_t counter);
+
+    // How many counters in the window haven't arrived (yet).
+    uint64_t num_missing() const;
+
+    bool started = false;
+    uint64_t highest = 0;
+
+    // bit i: whether counter highest - i has arrived
+    uint64_t received = 0;
 };
 
 
@@ -47,6 +101,16 @@ struct MetricsMessage: public core::Message {
 
     constexpr static char MetricsMessageType[] = "MetricsMessage";
 
+    using Schema = serialization::FlexSchema<
+        serialization::Field<"elapsed_time", double>,
+        serialization::Field<"time", double>,
+        serialization::Field<"current_mem_usage", uint64_t>,
+        serialization::Field<"parent_node_name", string>,
+        serialization::Field<"child_node_name", string>,
+        serialization::Field<"parent_node_guid", uuid>,
+        serialization::Field<"child_node_guid", uuid>,
+        serialization::Field<"host_name", string>>;
+
     MetricsMessage(Message& other);
     MetricsMessage(
         double elapsed_time,
@@ -64,39 +128,19 @@ struct MetricsMessage: public core::Message {
 
     map<string, MetricTracker> metrics;
 
-    double elapsed_time() const {
-        return root_map()["elapsed_time"].AsDouble();
-    }
-
-    double time() const {
-        return root_map()["time"].AsDouble();
-    }
-
-    uint64_t current_mem_usage() const {
-        return root_map()["current_mem_usage"].AsUInt64();
-    }
-
-    const string parent_node_name() const {
-        return root_map()["parent_node_name"].AsString().str();
-    }
-
-    const string child_node_name() const {
-        return root_map()["child_node_name"].AsString().str();
-    }
+    double elapsed_time() const { return fields.get<"elapsed_time">(); }
+    double time() const { return fields.get<"time">(); }
+    uint64_t current_mem_usage() const { return fields.get<"current_mem_usage">(); }
+    const string parent_node_name() const { return fields.get<"parent_node_name">(); }
+    const string child_node_name() const { return fields.get<"child_node_name">(); }
+    const uuid parent_node_guid() const { return fields.get<"parent_node_guid">(); }
+    const uuid child_node_guid() const { return fields.get<"child_node_guid">(); }
+    const string host_name() const { return fields.get<"host_name">(); }
 
-    const uuid parent_node_guid() const {
-        auto blob = root_map()["parent_node_guid"].AsBlob();
-        return serialization::deserialize_uuid(blob);
-    }
-
-    const uuid child_node_guid() const {
-        auto blob = root_map()["child_node_guid"].AsBlob();
-        return serialization::deserialize_uuid(blob);
-    }
+protected:
 
-    const string host_name() const {
-        return root_map()["host_name"].AsString().str();
-    }
+    // resolved once, at construction
+    Schema fields;
 };
 
 
@@ -116,7 +160,8 @@ public:
     void receive_from(core::MessagePtr m, const core::Node& from) override;
 
     // Called by MetricsNode
-    void record_metrics(double receive_time, long unsigned int bytes, double time_since_last_receive, double latency, int num_missed_messages);
+    void record_metrics(double receive_time, long unsigned int bytes, double time_since_last_receive, double latency,
+        uint64_t num_missed_messages, uint64_t num_reordered_messages = 0, uint64_t num_duplicate_messages = 0);
 
     // Called by whoever (and maybe by MetricsNode)
     void publish_and_reset();
@@ -133,6 +178,8 @@ protected:
     MetricTracker tracked_dt;
     MetricTracker tracked_latency;
     MetricTracker tracked_missed_messages;
+    MetricTracker tracked_reordered_messages;
+    MetricTracker tracked_duplicate_messages;
 
     double last_reset_time;
 
@@ -173,8 +220,16 @@ public:
         const string& name = "MetricsNode",
         const float passive_frequency_hz = 0);
 
+    ~MetricsNode();
+
     void receive(core::MessagePtr m) override;
 
+    // By default, passive publishing happens on the signaller's thread,
+    // when a message arrives. This moves it to the shared TimerService,
+    // so metrics keep getting published when nothing is flowing.
+    void start_passive_publishing_timer();
+    void stop_passive_publishing_timer();
+
     void pretty_print(bool compact=false) const;
     void reset() { publisher_node->reset(); }
     string to_string() const override;
@@ -183,10 +238,12 @@ public:
     double last_receive_time;
     float passive_frequency_hz;
     double last_passive_publish_time;
-    map<string, uint64_t> node_uuids_to_last_received_message_indexes;
+    util::UuidMap<SequenceTracker> source_sequences;
 
 protected:
 
+    std::atomic<util::TimerService::TimerId> passive_timer_id = 0;
+
     void on_connect(const core::Node& node, bool node_is_child) override;
 };
 
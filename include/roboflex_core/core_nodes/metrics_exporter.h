@@ -0,0 +1,111 @@
+#ifndef ROBOFLEX_METRICS_EXPORTER__H
+#define ROBOFLEX_METRICS_EXPORTER__H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include "roboflex_core/node.h"
+#include "roboflex_core/core_nodes/metrics.h"
+
+namespace roboflex {
+using namespace core;
+namespace nodes {
+
+/**
+ * Serves a graph's metrics in the OpenMetrics text format (which is what
+ * Prometheus scrapes), from a tiny HTTP server of its own, at
+ * http://address:port/metrics.
+ *
+ * Give it to GraphRoot as the metrics publisher, and it receives the
+ * MetricsMessage of every edge (or connect MetricsPublisherNodes to it
+ * yourself). It adds up what they report, per edge, into:
+ *
+ *   counters of messages, bytes, and missed, reordered and duplicate messages
+ *   histograms of latency, receive time and time between messages
+ *   gauges of the latest frequency, and of each host's memory use
+ *
+ * each labelled with the edge's parent, child and host.
+ *
+ * The server runs in this node's thread, so call start(). It listens on
+ * localhost by default; port 0 picks a free port, which get_port() says
+ * once started. It serves one scrape at a time, and gives each a second,
+ * all told, to send its request and take the response.
+ */
+class MetricsExporter: public RunnableNode {
+public:
+    MetricsExporter(
+        int port = 9464,
+        const string& address = "127.0.0.1",
+        const string& name = "MetricsExporter");
+
+    virtual ~MetricsExporter();
+
+    // Opens the listening socket (throwing if it can't), then starts serving.
+    void start() override;
+    void stop() override;
+
+    void receive(MessagePtr m) override;
+
+    // What a scrape returns.
+    string render() const;
+
+    int get_port() const { return port; }
+    const string& get_address() const { return address; }
+    size_t get_num_edges() const;
+    uint64_t get_num_scrapes() const { return num_scrapes; }
+
+    string to_string() const override;
+
+protected:
+
+    struct Histogram {
+        std::vector<uint64_t> bucket_counts;
+        uint64_t count = 0;
+        double sum = 0;
+
+        void add(const MetricTracker& tracker);
+    };
+
+    struct Edge {
+        string parent_name;
+        string child_name;
+        string host_name;
+
+        uint64_t messages = 0;
+        double bytes = 0;
+        uint64_t missed = 0;
+        uint64_t reordered = 0;
+        uint64_t duplicates = 0;
+
+        Histogram latency;
+        Histogram receive_time;
+        Histogram interval;
+
+        double frequency_hz = 0;
+    };
+
+    void child_thread_fn() override;
+    void serve(int client);
+    void close_socket();
+
+    // Waits for the client socket to be ready for events (POLLIN or
+    // POLLOUT). False if the deadline passes, or we're asked to stop, first.
+    bool wait_for_client(int client, short events, std::chrono::steady_clock::time_point deadline) const;
+
+    // written by start() when asked for any port, read by get_port()
+    std::atomic<int> port;
+    string address;
+    int listen_socket = -1;
+
+    mutable std::mutex registry_mutex;
+    std::map<std::pair<uuid, uuid>, Edge> edges;
+    std::map<string, uint64_t> host_memory_bytes;
+
+    std::atomic<uint64_t> num_scrapes = 0;
+};
+
+} // namespace nodes
+} // namespace roboflex
+
+#endif // ROBOFLEX_METRICS_EXPORTER__H
@@ -0,0 +1,131 @@
+#ifndef ROBOFLEX_PIPELINE__H
+#define ROBOFLEX_PIPELINE__H
+
+#include <tuple>
+#include <utility>
+#include "roboflex_core/node.h"
+
+namespace roboflex {
+using namespace core;
+namespace nodes {
+
+/**
+ * Stages are the building blocks of a Pipeline. Each one does what the
+ * equivalent node does (FilterName, FilterFun, EveryN, MapFun, CallbackFun),
+ * but as a plain callable instead of a Node: no virtual receive, no
+ * signal, no observer mutex. A stage is called with the message, may replace
+ * it, and returns whether the message should continue down the pipeline.
+ */
+struct FilterNameStage {
+    std::string message_name;
+
+    bool operator()(MessagePtr& m) {
+        return m->message_name() == message_name;
+    }
+};
+
+template <typename F>
+struct FilterFunStage {
+    F filterfun;
+
+    bool operator()(MessagePtr& m) {
+        return filterfun(m);
+    }
+};
+
+struct EveryNStage {
+    int n;
+    int count = 0;
+
+    bool operator()(MessagePtr&) {
+        bool pass = count == 0;
+        count += 1;
+        if (count == n) {
+            count = 0;
+        }
+        return pass;
+    }
+};
+
+template <typename F>
+struct MapFunStage {
+    F mapfun;
+
+    bool operator()(MessagePtr& m) {
+        m = mapfun(m);
+        return m != nullptr;
+    }
+};
+
+template <typename F>
+struct CallbackFunStage {
+    F callbackfun;
+
+    bool operator()(MessagePtr& m) {
+        callbackfun(m);
+        return true;
+    }
+};
+
+inline FilterNameStage filter_name(const std::string& message_name) { return FilterNameStage{message_name}; }
+inline EveryNStage every_n(int n) { return EveryNStage{n}; }
+template <typename F> FilterFunStage<F> filter_fun(F f) { return FilterFunStage<F>{std::move(f)}; }
+template <typename F> MapFunStage<F> map_fun(F f) { return MapFunStage<F>{std::move(f)}; }
+template <typename F> CallbackFunStage<F> callback_fun(F f) { return CallbackFunStage<F>{std::move(f)}; }
+
+
+/**
+ * A Node that fuses a chain of stateless stages into a single node,
+ * resolved at compile time. This:
+ *
+ *   auto p = pipeline(filter_name("imu"), every_n(4), map_fun(f));
+ *
+ * behaves like FilterName("imu") > EveryN(4) > MapFun(f), except that
+ * the message is handed from stage to stage by direct (inlinable) call,
+ * and signalled once at the end. One difference: a message created by
+ * a map_fun stage carries the Pipeline as its source node.
+ *
+ * To name it, construct it directly:
+ *
+ *   Pipeline p("imu_chain", filter_name("imu"), every_n(4));
+ */
+template <typename... Stages>
+class Pipeline: public Node {
+public:
+    Pipeline(const std::string& name, Stages... stages):
+        Node(name), stages(std::move(stages)...) {}
+
+    void receive(MessagePtr m) override {
+        if (run_stages<0>(m)) {
+            signal(m);
+        }
+    }
+
+    std::string to_string() const override {
+        return "<Pipeline stages: " + std::to_string(sizeof...(Stages)) + " " + Node::to_string() + ">";
+    }
+
+protected:
+
+    template <size_t I>
+    bool run_stages(MessagePtr& m) {
+        if constexpr (I == sizeof...(Stages)) {
+            return true;
+        } else {
+            return std::get<I>(stages)(m) && run_stages<I+1>(m);
+        }
+    }
+
+    std::tuple<Stages...> stages;
+};
+
+template <typename... Stages>
+shared_ptr<Pipeline<Stages...>> pipeline(Stages... stages)
+{
+    return std::make_shared<Pipeline<Stages...>>("Pipeline", std::move(stages)...);
+}
+
+} // namespace nodes
+} // namespace roboflex
+
+#endif // ROBOFLEX_PIPELINE__H
@@ -1,8 +1,10 @@
 #ifndef ROBOFLEX_PRODUCER__H
 #define ROBOFLEX_PRODUCER__H
 
+#include <atomic>
 #include "roboflex_core/node.h"
 #include "roboflex_core/util/event.h"
+#include "roboflex_core/util/latest_value.h"
 
 namespace roboflex {
 using namespace core;
@@ -16,6 +18,9 @@ namespace nodes {
  * Can run slower or faster than the upstream, and so might skip
  * messages if it runs slower.
  * 
+ * To pick up messages sooner, at the cost of a busy core, the thread can
+ * spin for spin_microseconds waiting for one before it goes to sleep.
+ * 
  * Designed to be inherited from, and the produce() method overridden.
  * Default implementation of produce() just returns the message.
  * 
@@ -25,34 +30,55 @@ class Producer: public RunnableNode {
 public:
     Producer(
         int timeout_milliseconds = 1000, 
-        const std::string& name = "Producer"):
+        const std::string& name = "Producer",
+        int spin_microseconds = 0):
             RunnableNode(name),
-            timeout_milliseconds(timeout_milliseconds) {}
+            timeout_milliseconds(timeout_milliseconds),
+            has_new_message_event(spin_microseconds) {}
 
     void receive(MessagePtr m) override {
-        std::lock_guard<std::recursive_mutex> lock(last_message_mutex);
-        last_message = m;
+        last_message.store(m);
+        if (unproduced_message.exchange(m) != nullptr) {
+            // the previous message was never produced
+            num_dropped_messages += 1;
+        }
         has_new_message_event.set();
     }
 
-    MessagePtr get_latest_message() { 
-        std::lock_guard<std::recursive_mutex> lock(last_message_mutex); 
-        return last_message; 
+    // Saturated whenever a message is waiting that the
+    // production thread has not picked up yet.
+    float get_congestion() const override {
+        return unproduced_message.has_value() ? 1.0f : 0.0f;
+    }
+
+    uint64_t get_num_dropped_messages() const {
+        return num_dropped_messages;
+    }
+
+    MessagePtr get_latest_message() const {
+        return last_message.load();
     }
 
     int get_timeout_milliseconds() const { 
         return timeout_milliseconds; 
     }
 
+    int get_spin_microseconds() const {
+        return has_new_message_event.get_spin_microseconds();
+    }
+
 protected:
 
     void child_thread_fn() override {
         while (!this->stop_requested()) {
             bool has_new_message = has_new_message_event.wait_once(timeout_milliseconds);
             if (has_new_message) {
-                MessagePtr m = get_latest_message();
+                // Clear first: whatever arrives from here on sets it again.
                 has_new_message_event.clear();
-                this->produce(m);
+                MessagePtr m = unproduced_message.exchange(nullptr);
+                if (m != nullptr) {
+                    this->produce(m);
+                }
             }
         }
     }
@@ -61,11 +87,12 @@ protected:
 
     int timeout_milliseconds;
 
-    // Requires gcc 12.1... do we force upgrade to 12.1?
-    // atomic<MessagePtr> last_message;
-    mutable std::recursive_mutex last_message_mutex;
-    MessagePtr last_message = nullptr;
-    util::Event has_new_message_event;
+    // Neither takes a lock, so readers of the latest message never hold
+    // up the thread delivering them.
+    util::LatestValue<Message> last_message;
+    util::LatestValue<Message> unproduced_message;
+    mutable util::Event has_new_message_event;
+    std::atomic<uint64_t> num_dropped_messages = 0;
 };
 
 } // namespace nodes
@@ -0,0 +1,430 @@
+#ifndef ROBOFLEX_RESAMPLER__H
+#define ROBOFLEX_RESAMPLER__H
+
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <type_traits>
+#include <xsimd/xsimd.hpp>
+#include "roboflex_core/node.h"
+#include "roboflex_core/serialization/flex_xtensor.h"
+#include "roboflex_core/core_messages/core_messages.h"
+#include "roboflex_core/core_messages/direct_write_message.h"
+
+namespace roboflex {
+using namespace core;
+namespace nodes {
+
+// sum(a[i] * b[i]), vectorized with xsimd.
+template <typename T>
+T simd_dot(const T* a, const T* b, size_t n)
+{
+    size_t i = 0;
+    T sum = 0;
+#if !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE)
+    using batch = xsimd::batch<T>;
+    constexpr size_t width = batch::size;
+    if (n >= width) {
+        batch acc(T(0));
+        for (; i + width <= n; i += width) {
+            acc = xsimd::fma(batch::load_unaligned(a + i), batch::load_unaligned(b + i), acc);
+        }
+        sum = xsimd::reduce_add(acc);
+    }
+#endif
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+// The zeroth order modified bessel function of the first kind, by its series.
+inline double bessel_i0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    double q = x * x / 4.0;
+    for (int k = 1; k < 500; k++) {
+        term *= q / (double(k) * k);
+        sum += term;
+        if (term < sum * 1e-17) {
+            break;
+        }
+    }
+    return sum;
+}
+
+/**
+ * Streaming polyphase FIR resampling by the rational factor up / down,
+ * of any number of channels at once, as with scipy's resample_poly: a
+ * kaiser-windowed sinc low-pass filter (to stop aliasing) applied at the
+ * upsampled rate, but only ever evaluated where an output sample lands,
+ * as one dot product of the filter's taps for that phase with the input.
+ * The filter is 2 * half_width * max(up, down) + 1 taps long, at the
+ * upsampled rate.
+ *
+ * State carries across calls to process, so a stream chopped into
+ * pieces of any size resamples the same as if it had arrived whole.
+ * Output is aligned with input (output sample 0 is at input sample 0),
+ * so it lags by half the filter: half_width * max(up, down) / up input
+ * samples.
+ */
+template <typename T>
+class PolyphaseResampler {
+public:
+    static_assert(std::is_floating_point_v<T>, "PolyphaseResampler works on float or double");
+
+    PolyphaseResampler(size_t up, size_t down, size_t half_width = 10, double kaiser_beta = 5.0);
+
+    // Forgets all history; the next call to process starts a new stream.
+    void reset(size_t num_channels);
+
+    // How many samples of each channel the next n input samples complete.
+    size_t num_outputs(size_t n) const;
+
+    // How far, in input samples, the last of those outputs lags behind the
+    // last of the n inputs: about half_width * max(up, down) / up. Only
+    // meaningful when num_outputs(n) > 0.
+    double output_lag(size_t n) const;
+
+    // Consumes n samples of each channel (channel-major: [num_channels, n]),
+    // and writes num_outputs(n) samples of each channel to output, likewise.
+    void process(const T* input, size_t n, T* output);
+
+    size_t get_up() const { return up; }
+    size_t get_down() const { return down; }
+    size_t get_num_channels() const { return num_channels; }
+    const std::vector<T>& get_filter() const { return filter; }
+
+protected:
+
+    void advance(size_t& index, size_t& phase) const {
+        phase += down;
+        index += phase / up;
+        phase %= up;
+    }
+
+    size_t up;
+    size_t down;
+
+    // the filter, at the upsampled rate
+    std::vector<T> filter;
+
+    // per phase, taps_per_phase taps, reversed to line up with the input
+    size_t taps_per_phase;
+    std::vector<T> phase_taps;
+
+    size_t num_channels = 0;
+
+    // per channel: the last taps_per_phase - 1 samples, then the new ones
+    size_t history_length;
+    std::vector<T> history;
+    std::vector<T> samples;
+
+    // the next output is at sample next_index of the history, and its
+    // taps are those of phase next_phase
+    size_t next_index = 0;
+    size_t next_phase = 0;
+};
+
+template <typename T>
+PolyphaseResampler<T>::PolyphaseResampler(size_t up, size_t down, size_t half_width, double kaiser_beta)
+{
+    if (up == 0 || down == 0 || half_width == 0) {
+        throw std::runtime_error("PolyphaseResampler: up, down and half_width must be at least 1");
+    }
+    size_t g = std::gcd(up, down);
+    this->up = up / g;
+    this->down = down / g;
+
+    size_t max_rate = std::max(this->up, this->down);
+    size_t half_length = half_width * max_rate;
+    size_t num_taps = 2 * half_length + 1;
+
+    // windowed sinc, cutting off at the lower of the two nyquist rates
+    std::vector<double> h(num_taps);
+    double total = 0;
+    for (size_t n = 0; n < num_taps; n++) {
+        double t = (double(n) - double(half_length)) / max_rate;
+        double sinc = t == 0 ? 1.0 : std::sin(M_PI * t) / (M_PI * t);
+        double r = (double(n) - double(half_length)) / double(half_length);
+        double window = bessel_i0(kaiser_beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / bessel_i0(kaiser_beta);
+        h[n] = sinc * window;
+        total += h[n];
+    }
+
+    // unity gain at dc, after upsampling's zero-stuffing
+    filter.resize(num_taps);
+    for (size_t n = 0; n < num_taps; n++) {
+        filter[n] = T(h[n] * this->up / total);
+    }
+
+    // Phase p's taps are filter[p], filter[p + up], ...; they're reversed
+    // here, so that each output is one contiguous dot product.
+    taps_per_phase = (num_taps + this->up - 1) / this->up;
+    phase_taps.assign(this->up * taps_per_phase, T(0));
+    for (size_t p = 0; p < this->up; p++) {
+        T* taps = phase_taps.data() + p * taps_per_phase;
+        for (size_t j = 0; j < taps_per_phase && p + j * this->up < num_taps; j++) {
+            taps[taps_per_phase - 1 - j] = filter[p + j * this->up];
+        }
+    }
+
+    history_length = taps_per_phase - 1;
+    reset(1);
+}
+
+template <typename T>
+void PolyphaseResampler<T>::reset(size_t num_channels)
+{
+    this->num_channels = num_channels;
+
+    // start with silence before the stream, and aim the first output at
+    // input sample 0, which is half the filter in
+    history.assign(num_channels * history_length, T(0));
+    size_t half_length = (filter.size() - 1) / 2;
+    next_index = history_length + half_length / up;
+    next_phase = half_length % up;
+}
+
+template <typename T>
+size_t PolyphaseResampler<T>::num_outputs(size_t n) const
+{
+    size_t count = 0;
+    size_t index = next_index;
+    size_t phase = next_phase;
+    while (index < history_length + n) {
+        count++;
+        advance(index, phase);
+    }
+    return count;
+}
+
+template <typename T>
+double PolyphaseResampler<T>::output_lag(size_t n) const
+{
+    // output (index, phase) is centred on input position
+    // index + (phase - half_length) / up, in history coordinates
+    size_t index = next_index;
+    size_t phase = next_phase;
+    size_t last_index = index;
+    size_t last_phase = phase;
+    while (index < history_length + n) {
+        last_index = index;
+        last_phase = phase;
+        advance(index, phase);
+    }
+    double half_length = double((filter.size() - 1) / 2);
+    double position = double(last_index) + (double(last_phase) - half_length) / up;
+    return double(history_length + n - 1) - position;
+}
+
+template <typename T>
+void PolyphaseResampler<T>::process(const T* input, size_t n, T* output)
+{
+    size_t num_out = num_outputs(n);
+
+    // append the new samples to each channel's history
+    size_t length = history_length + n;
+    samples.resize(num_channels * length);
+    for (size_t c = 0; c < num_channels; c++) {
+        T* x = samples.data() + c * length;
+        std::copy(history.data() + c * history_length, history.data() + (c + 1) * history_length, x);
+        std::copy(input + c * n, input + (c + 1) * n, x + history_length);
+    }
+
+    for (size_t c = 0; c < num_channels; c++) {
+        const T* x = samples.data() + c * length;
+        T* y = output + c * num_out;
+        size_t index = next_index;
+        size_t phase = next_phase;
+        for (size_t k = 0; k < num_out; k++) {
+            y[k] = simd_dot(phase_taps.data() + phase * taps_per_phase, x + index + 1 - taps_per_phase, taps_per_phase);
+            advance(index, phase);
+        }
+    }
+    for (size_t k = 0; k < num_out; k++) {
+        advance(next_index, next_phase);
+    }
+
+    // keep just what the next outputs need
+    for (size_t c = 0; c < num_channels; c++) {
+        const T* x = samples.data() + c * length;
+        std::copy(x + n, x + length, history.data() + c * history_length);
+    }
+    next_index -= n;
+}
+
+
+/**
+ * A Node that resamples the tensor in each message along its last
+ * dimension, by the rational factor up / down, with a PolyphaseResampler:
+ * 4000 Hz -> 200 Hz is up = 1, down = 20. Other dimensions are
+ * independent channels, fixed by the first message.
+ *
+ * Signals a message with the same module and message name as the input
+ * (so a TensorMessage of any rank stays readable as one) holding the
+ * resampled tensor under tensor_key_out. A message that completes no
+ * output sample signals nothing.
+ *
+ * Each input message's timestamp is taken to be that of its last sample.
+ * The output's is that of its own last sample: the input's, less the
+ * filter's lag (PolyphaseResampler::output_lag) at input_sample_rate.
+ * If input_sample_rate is 0, it is estimated from the timestamps and
+ * sizes of the messages so far; until there are two, the input's
+ * timestamp is passed through as is.
+ */
+template <typename T>
+class Resampler: public Node {
+public:
+    Resampler(
+        size_t up,
+        size_t down,
+        size_t half_width = 10,
+        double kaiser_beta = 5.0,
+        double input_sample_rate = 0.0,
+        const std::string& tensor_key_in = "t",
+        const std::string& tensor_key_out = "t",
+        const std::string& name = "Resampler"):
+            Node(name),
+            resampler(up, down, half_width, kaiser_beta),
+            input_sample_rate(input_sample_rate),
+            tensor_key_in(tensor_key_in),
+            tensor_key_in_handle(serialization::FlexKey::intern(tensor_key_in)),
+            tensor_key_out(tensor_key_out) {}
+
+    void receive(MessagePtr m) override;
+    std::string to_string() const override;
+
+    // Forgets all history; the next message starts a new stream.
+    void reset();
+
+    size_t get_up() const { return resampler.get_up(); }
+    size_t get_down() const { return resampler.get_down(); }
+    std::vector<T> get_filter() const { return resampler.get_filter(); }
+    double get_input_sample_rate() const { return input_sample_rate; }
+
+protected:
+
+    // The input's sample rate, as given, else estimated from the samples
+    // after the first message over the time since it.
+    double get_sample_rate() const;
+
+    std::mutex resampler_mutex;
+    PolyphaseResampler<T> resampler;
+    bool started = false;
+    double input_sample_rate;
+    double first_timestamp = 0.0;
+    double last_timestamp = 0.0;
+    uint64_t num_samples_since_first = 0;
+
+    // the shape of everything but the last dimension
+    std::vector<size_t> channel_shape;
+
+    // Output layouts, by number of output samples - which, for a steady
+    // input, takes only a value or two. Cleared whenever the shape changes
+    // and if it grows past MaxLayouts.
+    static constexpr size_t MaxLayouts = 16;
+    std::map<size_t, std::pair<MessageLayout, ArraySlot<T>>> layouts;
+
+    std::string tensor_key_in;
+    serialization::FlexKey tensor_key_in_handle;
+    std::string tensor_key_out;
+};
+
+template <typename T>
+void Resampler<T>::reset()
+{
+    std::lock_guard<std::mutex> lock(resampler_mutex);
+    started = false;
+}
+
+template <typename T>
+void Resampler<T>::receive(MessagePtr m)
+{
+    // deserialize into an xtensor adapter... no copy yet!
+    auto tensor = serialization::deserialize_flex_array<T>(m->root_val(tensor_key_in_handle));
+    std::vector<size_t> shape(tensor.shape().begin(), tensor.shape().end());
+    if (shape.empty()) {
+        throw std::runtime_error("Resampler \"" + get_name() + "\" can't resample a scalar");
+    }
+    size_t n = shape.back();
+    std::vector<size_t> leading(shape.begin(), shape.end() - 1);
+
+    std::lock_guard<std::mutex> lock(resampler_mutex);
+
+    double timestamp = m->timestamp();
+    if (!started) {
+        if (leading != channel_shape) {
+            layouts.clear();
+        }
+        channel_shape = leading;
+        resampler.reset(std::accumulate(leading.begin(), leading.end(), size_t(1), std::multiplies<size_t>()));
+        first_timestamp = timestamp;
+        num_samples_since_first = 0;
+        started = true;
+    } else if (leading != channel_shape) {
+        std::stringstream sst;
+        sst << "Resampler \"" << get_name() << "\" expected tensors of shape " << xt::adapt(channel_shape)
+            << " (plus a last dimension), but got " << xt::adapt(shape);
+        throw std::runtime_error(sst.str());
+    } else {
+        num_samples_since_first += n;
+    }
+    last_timestamp = timestamp;
+
+    size_t num_out = resampler.num_outputs(n);
+    if (num_out == 0) {
+        resampler.process(tensor.data(), n, nullptr);
+        return;
+    }
+
+    auto it = layouts.find(num_out);
+    if (it == layouts.end()) {
+        if (layouts.size() >= MaxLayouts) {
+            layouts.clear();
+        }
+        std::vector<size_t> out_shape = leading;
+        out_shape.push_back(num_out);
+        MessageLayout layout;
+        auto slot = layout.add_array<T>(tensor_key_out, out_shape);
+        it = layouts.emplace(num_out, std::make_pair(std::move(layout), slot)).first;
+    }
+    const auto& [layout, slot] = it->second;
+
+    auto out = std::make_shared<DirectWriteMessage>(m->module_name(), m->message_name(), layout);
+    double sample_rate = get_sample_rate();
+    double lag = sample_rate > 0 ? resampler.output_lag(n) / sample_rate : 0.0;
+    out->set_timestamp(timestamp - lag);
+    resampler.process(tensor.data(), n, out->data(slot));
+
+    this->signal(out);
+}
+
+template <typename T>
+double Resampler<T>::get_sample_rate() const
+{
+    if (input_sample_rate > 0) {
+        return input_sample_rate;
+    }
+    double elapsed = last_timestamp - first_timestamp;
+    return elapsed > 0 ? num_samples_since_first / elapsed : 0.0;
+}
+
+template <typename T>
+std::string Resampler<T>::to_string() const
+{
+    std::stringstream sst;
+    sst << "<Resampler up=" << get_up()
+        << " down=" << get_down()
+        << " taps=" << resampler.get_filter().size()
+        << " " << Node::to_string() << ">";
+    return sst.str();
+}
+
+} // namespace nodes
+} // namespace roboflex
+
+#endif // ROBOFLEX_RESAMPLER__H
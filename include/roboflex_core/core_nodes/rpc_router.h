@@ -0,0 +1,130 @@
+#ifndef ROBOFLEX_RPC_ROUTER__H
+#define ROBOFLEX_RPC_ROUTER__H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "roboflex_core/node.h"
+#include "roboflex_core/serialization/flex_schema.h"
+#include "roboflex_core/util/uuid_map.h"
+
+namespace roboflex {
+using namespace core;
+namespace nodes {
+
+/**
+ * Asks an RpcRouter to make an rpc call on the node whose guid is target.
+ * The call is itself a message (such as a BlankMessage named "ping"),
+ * carried whole. call_id comes back in the result, to match them up.
+ */
+class RemoteCallMessage: public Message {
+public:
+
+    constexpr static char RemoteCallMessageName[] = "RemoteCall";
+
+    using Schema = serialization::FlexSchema<
+        serialization::Field<"target", uuid>,
+        serialization::Field<"call_id", uint64_t>,
+        serialization::Field<"call", flexbuffers::Reference>>;
+
+    RemoteCallMessage(Message& other);
+    RemoteCallMessage(const uuid& target, MessagePtr call, uint64_t call_id = 0);
+
+    uuid target() const { return fields.get<"target">(); }
+    uint64_t call_id() const { return fields.get<"call_id">(); }
+    MessagePtr call() const;
+
+    void print_on(ostream& os) const override;
+
+protected:
+    Schema fields;
+};
+
+/**
+ * What an RpcRouter signals for each RemoteCallMessage. handled is false
+ * if the target isn't known, or its handle_rpc answered nothing; error
+ * says what it threw, if it did. result() is nullptr unless it returned
+ * something.
+ */
+class RemoteCallResultMessage: public Message {
+public:
+
+    constexpr static char RemoteCallResultMessageName[] = "RemoteCallResult";
+
+    using Schema = serialization::FlexSchema<
+        serialization::Field<"target", uuid>,
+        serialization::Field<"call_id", uint64_t>,
+        serialization::Field<"handled", bool>,
+        serialization::Field<"error", string>,
+        serialization::Field<"result", flexbuffers::Reference>>;
+
+    RemoteCallResultMessage(Message& other);
+    RemoteCallResultMessage(
+        const uuid& target,
+        uint64_t call_id,
+        bool handled,
+        const string& error,
+        MessagePtr result);
+
+    uuid target() const { return fields.get<"target">(); }
+    uint64_t call_id() const { return fields.get<"call_id">(); }
+    bool handled() const { return fields.get<"handled">(); }
+    string error() const { return fields.get<"error">(); }
+    MessagePtr result() const;
+
+    void print_on(ostream& os) const override;
+
+protected:
+    Schema fields;
+};
+
+
+/**
+ * Routes rpc calls to any node it knows of, by guid, with one hash
+ * lookup. Nodes are added one by one, or a whole graph at once; it holds
+ * them weakly, so it keeps nothing alive.
+ *
+ * Call it directly (call), or send it RemoteCallMessages - from a
+ * transport, say, so that tools outside the process can tune a running
+ * graph - and it signals a RemoteCallResultMessage for each. Other
+ * messages are ignored.
+ */
+class RpcRouter: public Node {
+public:
+    RpcRouter(const string& name = "RpcRouter");
+
+    void add_node(NodePtr node);
+
+    // root, and every node downstream of it
+    void add_graph(NodePtr root);
+
+    bool remove_node(const uuid& guid);
+
+    // nullptr if it's unknown, or gone
+    NodePtr find_node(const uuid& guid) const;
+
+    size_t get_num_nodes() const;
+
+    // nullptr if the target is unknown, or its handle_rpc answers nothing
+    MessagePtr call(const uuid& target, MessagePtr rpc_message) const;
+
+    void receive(MessagePtr m) override;
+
+    uint64_t get_num_calls() const { return num_calls; }
+    uint64_t get_num_unhandled() const { return num_unhandled; }
+
+    string to_string() const override;
+
+protected:
+
+    mutable std::mutex nodes_mutex;
+    util::UuidMap<std::weak_ptr<Node>> nodes;
+
+    std::atomic<uint64_t> num_calls = 0;
+    std::atomic<uint64_t> num_unhandled = 0;
+};
+
+} // namespace nodes
+} // namespace roboflex
+
+#endif // ROBOFLEX_RPC_ROUTER__H
@@ -9,6 +9,10 @@ namespace nodes {
 
 using std::vector, std::shared_ptr;
 
+// Waits for the next n messages from the given node, for up to
+// timeout_milliseconds (0: forever), and returns what came. take1
+// returns nullptr if nothing did.
+
 vector<MessagePtr> take(size_t n, Node& from, int timeout_milliseconds=0);
 vector<MessagePtr> take(size_t n, shared_ptr<Node> from, int timeout_milliseconds=0);
 
@@ -0,0 +1,345 @@
+#ifndef ROBOFLEX_TENSOR_BATCHER__H
+#define ROBOFLEX_TENSOR_BATCHER__H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include "roboflex_core/node.h"
+#include "roboflex_core/serialization/flex_xtensor.h"
+#include "roboflex_core/core_messages/core_messages.h"
+#include "roboflex_core/core_messages/direct_write_message.h"
+#include "roboflex_core/util/timer_service.h"
+#include <xtensor/views/xstrided_view.hpp>
+
+namespace roboflex {
+using namespace core;
+namespace nodes {
+
+/**
+ * A Node that stacks the tensors of batch_size messages into one tensor
+ * of shape [batch_size, ...shape], and signals it in a single message:
+ *
+ *   tensor_key_out: the batch
+ *   "count":        how many of the rows are filled
+ *   "timestamps":   [batch_size] float64, each row's message's timestamp
+ *   "shapes":       [batch_size, rank] uint64, each row's tensor's shape
+ *                   (only when padding)
+ *
+ * A batch goes out when it's full or, if timeout_seconds > 0, that long
+ * after its first tensor arrived, whichever is first: a batch that times
+ * out has count < batch_size. Rows past count are filled with pad_value.
+ *
+ * Every tensor must have the given shape - unless pad is set, in which
+ * case a tensor may be smaller along any dimension, and the rest of its
+ * row is filled with pad_value.
+ *
+ * Each tensor is copied once, straight into the outgoing message. Those
+ * messages come from a pool, and are reused once nothing else holds
+ * them, so in steady state batching allocates nothing. The pool grows up
+ * to pool_size messages; past that, batches get fresh messages.
+ */
+template <typename T>
+class TensorBatcher: public Node {
+public:
+    TensorBatcher(
+        size_t batch_size,
+        const std::vector<size_t>& shape,
+        double timeout_seconds = 0,
+        bool pad = false,
+        T pad_value = T(0),
+        const std::string& tensor_key_in = "t",
+        const std::string& tensor_key_out = "t",
+        size_t pool_size = 4,
+        const std::string& name = "TensorBatcher");
+
+    virtual ~TensorBatcher();
+
+    void receive(MessagePtr m) override;
+    std::string to_string() const override;
+
+    size_t get_batch_size() const { return batch_size; }
+    const std::vector<size_t>& get_shape() const { return shape; }
+    double get_timeout() const { return timeout_seconds; }
+
+    uint64_t get_num_batches() const { return num_batches; }
+    uint64_t get_num_timed_out() const { return num_timed_out; }
+    uint64_t get_num_pool_misses() const { return num_pool_misses; }
+
+protected:
+
+    using BatchMessagePtr = shared_ptr<DirectWriteMessage>;
+
+    // Finds a pooled message that nothing else holds, or makes one.
+    BatchMessagePtr acquire();
+
+    // Fills the unfilled rows, sets the count, and starts a new batch.
+    // Call with batch_mutex held.
+    BatchMessagePtr finish_batch();
+
+    // Signals the batch, letting go of batch_lock first.
+    void emit(BatchMessagePtr batch, std::unique_lock<std::mutex>& batch_lock, util::TimerService::TimerId timer_to_cancel);
+
+    void on_timeout(uint64_t generation);
+
+    size_t batch_size;
+    std::vector<size_t> shape;
+    size_t sample_size;
+    double timeout_seconds;
+    bool pad;
+    T pad_value;
+    std::string tensor_key_in;
+    serialization::FlexKey tensor_key_in_handle;
+    std::string tensor_key_out;
+    size_t pool_size;
+
+    MessageLayout layout;
+    ArraySlot<T> batch_slot;
+    ArraySlot<double> timestamps_slot;
+    ArraySlot<uint64_t> shapes_slot;
+    ScalarSlot<uint64_t> count_slot;
+
+    std::mutex batch_mutex;
+    std::vector<BatchMessagePtr> pool;
+    BatchMessagePtr current;
+    size_t count = 0;
+    uint64_t generation = 0;
+    util::TimerService::TimerId timer_id = 0;
+
+    // Timeout callbacks under way. A timed-out batch is signalled from
+    // the timer's thread, with timer_id already cleared, so the
+    // destructor waits for these to finish rather than relying on
+    // cancelling timer_id.
+    int timeouts_running = 0;
+    std::condition_variable timeouts_finished;
+
+    // held while signalling, so batches go out in order
+    std::mutex emit_mutex;
+
+    std::atomic<uint64_t> num_batches = 0;
+    std::atomic<uint64_t> num_timed_out = 0;
+    std::atomic<uint64_t> num_pool_misses = 0;
+};
+
+template <typename T>
+TensorBatcher<T>::TensorBatcher(
+    size_t batch_size,
+    const std::vector<size_t>& shape,
+    double timeout_seconds,
+    bool pad,
+    T pad_value,
+    const std::string& tensor_key_in,
+    const std::string& tensor_key_out,
+    size_t pool_size,
+    const std::string& name):
+        Node(name),
+        batch_size(batch_size),
+        shape(shape),
+        timeout_seconds(timeout_seconds),
+        pad(pad),
+        pad_value(pad_value),
+        tensor_key_in(tensor_key_in),
+        tensor_key_in_handle(serialization::FlexKey::intern(tensor_key_in)),
+        tensor_key_out(tensor_key_out),
+        pool_size(pool_size)
+{
+    if (batch_size == 0) {
+        throw std::runtime_error("TensorBatcher \"" + name + "\": batch_size must be at least 1");
+    }
+
+    sample_size = 1;
+    for (auto s: shape) {
+        sample_size *= s;
+    }
+
+    std::vector<size_t> batch_shape = {batch_size};
+    batch_shape.insert(batch_shape.end(), shape.begin(), shape.end());
+    batch_slot = layout.add_array<T>(tensor_key_out, batch_shape);
+    timestamps_slot = layout.add_array<double>("timestamps", {batch_size});
+    if (pad) {
+        shapes_slot = layout.add_array<uint64_t>("shapes", {batch_size, shape.size()});
+    }
+
+    count_slot = layout.add_scalar<uint64_t>("count");
+}
+
+template <typename T>
+TensorBatcher<T>::~TensorBatcher()
+{
+    util::TimerService::TimerId pending_timer;
+    {
+        const std::lock_guard<std::mutex> lock(batch_mutex);
+        pending_timer = timer_id;
+        timer_id = 0;
+
+        // any timeout that fires from now on finds nothing to do
+        generation++;
+    }
+    if (pending_timer != 0) {
+        util::TimerService::instance().cancel(pending_timer);
+    }
+
+    std::unique_lock<std::mutex> lock(batch_mutex);
+    timeouts_finished.wait(lock, [this]{ return timeouts_running == 0; });
+}
+
+template <typename T>
+void TensorBatcher<T>::receive(MessagePtr m)
+{
+    // deserialize into an xtensor adapter... no copy yet!
+    auto tensor = serialization::deserialize_flex_array<T>(m->root_val(tensor_key_in_handle));
+    const auto& tensor_shape = tensor.shape();
+
+    bool exact = tensor_shape.size() == shape.size();
+    bool fits = exact;
+    for (size_t i = 0; fits && i < shape.size(); i++) {
+        exact = exact && tensor_shape[i] == shape[i];
+        fits = tensor_shape[i] <= shape[i];
+    }
+    if (!exact && !(pad && fits)) {
+        std::stringstream sst;
+        sst << "TensorBatcher \"" << get_name() << "\" expected a tensor of shape " << xt::adapt(shape)
+            << (pad ? " or smaller" : "") << ", but got " << xt::adapt(tensor_shape);
+        throw std::runtime_error(sst.str());
+    }
+
+    std::unique_lock<std::mutex> lock(batch_mutex);
+
+    if (current == nullptr) {
+        current = acquire();
+        count = 0;
+        if (timeout_seconds > 0) {
+            uint64_t g = generation;
+            timer_id = util::TimerService::instance().schedule_once(timeout_seconds, [this, g]{ on_timeout(g); });
+        }
+    }
+
+    // the one copy
+    T* row = current->data(batch_slot) + count * sample_size;
+    if (exact) {
+        std::copy(tensor.data(), tensor.data() + sample_size, row);
+    } else {
+        std::fill(row, row + sample_size, pad_value);
+        auto row_view = xt::adapt(row, sample_size, xt::no_ownership(), shape);
+        xt::xstrided_slice_vector region;
+        for (auto s: tensor_shape) {
+            region.push_back(xt::range(size_t(0), s));
+        }
+        xt::strided_view(row_view, region).assign(tensor);
+    }
+
+    current->data(timestamps_slot)[count] = m->timestamp();
+    if (pad) {
+        std::copy(tensor_shape.begin(), tensor_shape.end(), current->data(shapes_slot) + count * shape.size());
+    }
+
+    if (++count == batch_size) {
+        auto stale_timer = timer_id;
+        timer_id = 0;
+        emit(finish_batch(), lock, stale_timer);
+    }
+}
+
+template <typename T>
+void TensorBatcher<T>::on_timeout(uint64_t g)
+{
+    std::unique_lock<std::mutex> lock(batch_mutex);
+    if (g != generation || current == nullptr) {
+        return;
+    }
+    timeouts_running++;
+    timer_id = 0;
+    num_timed_out++;
+    auto finished = [this, &lock]() {
+        lock.lock();
+        timeouts_running--;
+        timeouts_finished.notify_all();
+    };
+    try {
+        emit(finish_batch(), lock, 0);
+    } catch (...) {
+        finished();
+        throw;
+    }
+    finished();
+}
+
+template <typename T>
+typename TensorBatcher<T>::BatchMessagePtr TensorBatcher<T>::acquire()
+{
+    // Nothing can get a new reference to a message without already having
+    // one, so if only the pool holds it (and its payload), it stays that way.
+    for (auto& message: pool) {
+        if (message.use_count() == 1 && message->payload().use_count() == 2) {
+            message->set_message_counter(std::numeric_limits<uint64_t>::max());
+            return message;
+        }
+    }
+
+    auto message = std::make_shared<DirectWriteMessage>(CoreModuleName, "TensorBatch", layout);
+    if (pool.size() < pool_size) {
+        pool.push_back(message);
+    } else {
+        num_pool_misses++;
+    }
+    return message;
+}
+
+template <typename T>
+typename TensorBatcher<T>::BatchMessagePtr TensorBatcher<T>::finish_batch()
+{
+    auto batch = current;
+    current = nullptr;
+    generation++;
+    num_batches++;
+
+    T* rows = batch->data(batch_slot);
+    std::fill(rows + count * sample_size, rows + batch_size * sample_size, pad_value);
+    double* timestamps = batch->data(timestamps_slot);
+    std::fill(timestamps + count, timestamps + batch_size, 0.0);
+    if (pad) {
+        uint64_t* shapes = batch->data(shapes_slot);
+        std::fill(shapes + count * shape.size(), shapes + batch_size * shape.size(), 0);
+    }
+
+    batch->set(count_slot, uint64_t(count));
+    batch->set_timestamp(get_current_time());
+    return batch;
+}
+
+template <typename T>
+void TensorBatcher<T>::emit(
+    BatchMessagePtr batch,
+    std::unique_lock<std::mutex>& batch_lock,
+    util::TimerService::TimerId timer_to_cancel)
+{
+    {
+        // take the emit lock before letting go of the batch, so that the
+        // next batch has to wait for this one to go out
+        const std::lock_guard<std::mutex> emit_lock(emit_mutex);
+        batch_lock.unlock();
+        this->signal(batch);
+    }
+    if (timer_to_cancel != 0) {
+        util::TimerService::instance().cancel(timer_to_cancel);
+    }
+}
+
+template <typename T>
+std::string TensorBatcher<T>::to_string() const
+{
+    std::stringstream sst;
+    sst << "<TensorBatcher batch_size=" << batch_size
+        << " shape=" << xt::adapt(shape)
+        << " timeout=" << timeout_seconds
+        << " batches=" << num_batches
+        << " timed_out=" << num_timed_out
+        << " pool=" << pool_size
+        << " " << Node::to_string() << ">";
+    return sst.str();
+}
+
+} // namespace nodes
+} // namespace roboflex
+
+#endif // ROBOFLEX_TENSOR_BATCHER__H
@@ -103,6 +103,7 @@ public:
         const std::string& name = "TensorBuffer"):
             Node(name),
             tensor_key_in(tensor_key_in),
+            tensor_key_in_handle(serialization::FlexKey::intern(tensor_key_in)),
             tensor_key_out(tensor_key_out),
             count_key_out(count_key_out),
             buf(shape) {}
@@ -117,6 +118,7 @@ public:
 protected:
 
     std::string tensor_key_in;
+    serialization::FlexKey tensor_key_in_handle;
     std::string tensor_key_out;
     std::string count_key_out;
     mutable std::recursive_mutex buffer_mutex;
@@ -128,7 +130,7 @@ template <typename T>
 void TensorRightBuffer<T>::receive(MessagePtr m) 
 {
     // get the map at the key holding the tensor
-    auto tensor_map = m->root_val(tensor_key_in);
+    auto tensor_map = m->root_val(tensor_key_in_handle);
 
     // deserialize into an xtensor adapter... no copy yet!
     serialization::flextensor_adaptor<T> tensor_adapter = serialization::deserialize_flex_array<T>(tensor_map);
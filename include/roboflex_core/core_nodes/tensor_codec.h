@@ -0,0 +1,89 @@
+#ifndef ROBOFLEX_TENSOR_CODEC__H
+#define ROBOFLEX_TENSOR_CODEC__H
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include "roboflex_core/node.h"
+#include "roboflex_core/serialization/flex_tensor_codec.h"
+
+namespace roboflex {
+using namespace core;
+namespace nodes {
+
+using std::string;
+
+/**
+ * A node that re-signals messages with some of their tensors encoded
+ * (see flex_tensor_codec.h): put one in front of a UniversalDataSaver,
+ * or a transport, to cut the bytes that sensor streams take.
+ *
+ * With EncodingFrameDelta, each tensor is sent as its difference from the
+ * same key's previous frame, plus a keyframe (a full frame) every
+ * keyframe_interval frames, and whenever the tensor's size changes, so
+ * that receivers can join, or recover from a lost message, quickly.
+ */
+class TensorEncoder: public Node {
+public:
+    TensorEncoder(
+        const std::vector<string>& tensor_keys,
+        int encoding = serialization::EncodingShuffle | serialization::EncodingLZ4,
+        unsigned int keyframe_interval = 30,
+        const string& name = "TensorEncoder");
+
+    void receive(MessagePtr m) override;
+    string to_string() const override;
+
+    const std::vector<string>& get_tensor_keys() const { return tensor_keys; }
+    int get_encoding() const { return encoding; }
+    unsigned int get_keyframe_interval() const { return keyframe_interval; }
+
+protected:
+
+    struct StreamState {
+        std::vector<uint8_t> previous;
+        uint64_t frame = 0;
+    };
+
+    std::vector<string> tensor_keys;
+    int encoding;
+    unsigned int keyframe_interval;
+    std::map<string, StreamState> streams;
+    std::mutex streams_mutex;
+};
+
+/**
+ * A node that re-signals messages with all of their (top-level) encoded
+ * tensors decoded, and aligned, so that everything downstream - TensorMessage,
+ * deserialize_flex_tensor, and so on - reads them as usual.
+ *
+ * A frame-delta encoded tensor can only be decoded given the previous
+ * frame. Messages that can't be decoded (because this node joined the
+ * stream mid-way, or missed a message) are dropped until the next keyframe.
+ */
+class TensorDecoder: public Node {
+public:
+    TensorDecoder(const string& name = "TensorDecoder");
+
+    void receive(MessagePtr m) override;
+    string to_string() const override;
+
+    uint64_t get_num_dropped() const { return num_dropped; }
+
+protected:
+
+    struct StreamState {
+        std::vector<uint8_t> previous;
+        uint64_t frame = 0;
+        bool valid = false;
+    };
+
+    std::map<string, StreamState> streams;
+    std::mutex streams_mutex;
+    uint64_t num_dropped = 0;
+};
+
+} // namespace nodes
+} // namespace roboflex
+
+#endif // ROBOFLEX_TENSOR_CODEC__H
@@ -0,0 +1,196 @@
+#ifndef ROBOFLEX_TIME_SYNCHRONIZER__H
+#define ROBOFLEX_TIME_SYNCHRONIZER__H
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "roboflex_core/node.h"
+#include "roboflex_core/util/owner_link.h"
+
+namespace roboflex {
+using namespace core;
+namespace nodes {
+
+using std::string, std::vector;
+
+/**
+ * A message that bundles one message from each input of a
+ * TimeSynchronizer: the inputs' names under "names", in input order; the
+ * timestamp is that of the match (see TimeSynchronizer).
+ *
+ * Within the process, get_message returns the original messages, without
+ * copying. To send the messages on (through a transport), they must be
+ * embedded: each is then serialized, whole, as a blob under "messages",
+ * and get_message rebuilds them from the blobs after transport. That
+ * copies every message in full for every match - a whole frame, for a
+ * camera - so it's off unless asked for.
+ */
+class SynchronizedMessage: public Message {
+public:
+
+    constexpr static char SynchronizedMessageType[] = "SynchronizedMessage";
+
+    SynchronizedMessage(Message& other);
+    SynchronizedMessage(
+        const vector<string>& names,
+        const vector<MessagePtr>& messages,
+        double timestamp,
+        bool embed_messages = false);
+
+    size_t get_num_messages() const;
+    bool has_embedded_messages() const;
+    vector<string> get_names() const;
+
+    MessagePtr get_message(size_t index) const;
+    MessagePtr get_message(const string& name) const;
+
+    void print_on(ostream& os) const override;
+
+protected:
+
+    // the originals, if we built this message in this process; otherwise,
+    // filled in as they are rebuilt
+    mutable std::mutex messages_mutex;
+    mutable vector<MessagePtr> messages;
+};
+
+using SynchronizedMessagePtr = std::shared_ptr<SynchronizedMessage>;
+
+
+/**
+ * Matches up messages from several inputs - say a camera, a depth sensor,
+ * and an imu - by timestamp, and emits each match as one tuple:
+ *
+ *   auto sync = std::make_shared<TimeSynchronizer>(0.01);
+ *   camera > sync->add_input("camera");
+ *   depth > sync->add_input("depth");
+ *   imu > sync->add_input("imu");
+ *   sync > fusion;
+ *
+ * Each input keeps its recent messages, in arrival order, in a bounded
+ * buffer; when one fills up its oldest message is dropped. Every time a
+ * message arrives, we look for matches. The pivot is the latest of the
+ * inputs' oldest messages: nothing older than it can be in any future
+ * match. Once every input has received something at least as recent as
+ * the pivot, each input's message nearest the pivot is found by binary
+ * search. If all are within slop seconds of the pivot, that's a match,
+ * and it, and everything older, is removed from the buffers. If not, the
+ * pivot's message can never be matched, and is dropped.
+ *
+ * With slop = 0 (the Exact policy), timestamps must be equal: useful when
+ * the inputs are all derived from the same original message.
+ *
+ * Matches are signalled as SynchronizedMessages (if anything is connected)
+ * and passed to the callback (if there is one), in the order they are
+ * found. Neither copies the original messages, unless embed_messages is
+ * set - needed only if the SynchronizedMessages are to leave the process
+ * (see SynchronizedMessage).
+ *
+ * Each input is connected to the synchronizer, so walks from upstream
+ * (GraphRoot's start_all, metrics instrumentation, snapshot_graph) reach
+ * it and whatever follows it; messages go straight to the synchronizer,
+ * not over that connection. The inputs keep the synchronizer alive, as
+ * parents do; it doesn't keep them alive - whatever connects to them
+ * does.
+ *
+ * Assumes each input's timestamps don't go backwards.
+ */
+class TimeSynchronizer: public Node {
+public:
+
+    enum class Policy {
+        Exact,
+        ApproximateTime,
+    };
+
+    using MatchCallback = std::function<void(const vector<MessagePtr>&)>;
+
+    TimeSynchronizer(
+        double slop = 0.01,
+        size_t buffer_capacity = 32,
+        const string& name = "TimeSynchronizer");
+
+    TimeSynchronizer(
+        Policy policy,
+        double slop = 0.01,
+        size_t buffer_capacity = 32,
+        const string& name = "TimeSynchronizer");
+
+    virtual ~TimeSynchronizer();
+
+    // Inputs should be added before messages start to arrive. get_input
+    // is nullptr if the input has gone.
+    NodePtr add_input(const string& name = "");
+    NodePtr get_input(size_t index) const;
+    size_t get_num_inputs() const;
+    vector<string> get_input_names() const;
+
+    void set_callback(MatchCallback callback);
+
+    void set_embed_messages(bool embed) { embed_messages = embed; }
+    bool get_embed_messages() const { return embed_messages; }
+
+    Policy get_policy() const { return policy; }
+    double get_slop() const { return slop; }
+    size_t get_buffer_capacity() const { return buffer_capacity; }
+
+    uint64_t get_num_matched() const { return num_matched; }
+    uint64_t get_num_dropped() const { return num_dropped; }
+
+    string to_string() const override;
+
+protected:
+
+    class Input: public Node {
+    public:
+        Input(util::OwnerLink<TimeSynchronizer> synchronizer, size_t index, const string& name):
+            Node(name), synchronizer(synchronizer), index(index) {}
+
+        void receive(MessagePtr m) override;
+
+        // cut when the synchronizer goes away, in case we outlive it
+        util::OwnerLink<TimeSynchronizer> synchronizer;
+        size_t index;
+    };
+
+    struct Entry {
+        double timestamp;
+        MessagePtr message;
+    };
+
+    void receive_input(size_t index, MessagePtr m);
+
+    // Finds every match now possible, and appends each to matches.
+    // Call with buffers_mutex held.
+    void find_matches(vector<vector<MessagePtr>>& matches, vector<double>& match_timestamps);
+
+    // The index of the entry in buffer nearest to t.
+    static size_t nearest(const std::deque<Entry>& buffer, double t);
+
+    Policy policy;
+    double slop;
+    size_t buffer_capacity;
+
+    // guards inputs, input_links, input_names and buffers
+    mutable std::mutex buffers_mutex;
+    vector<std::weak_ptr<Input>> inputs;
+    vector<util::OwnerLink<TimeSynchronizer>> input_links;
+    vector<string> input_names;
+    vector<std::deque<Entry>> buffers;
+
+    // held while emitting, so matches go out in the order they're found
+    std::mutex emit_mutex;
+    MatchCallback callback;
+
+    std::atomic<bool> embed_messages = false;
+
+    std::atomic<uint64_t> num_matched = 0;
+    std::atomic<uint64_t> num_dropped = 0;
+};
+
+} // namespace nodes
+} // namespace roboflex
+
+#endif // ROBOFLEX_TIME_SYNCHRONIZER__H
@@ -0,0 +1,180 @@
+#ifndef ROBOFLEX_TIMESTAMP_MERGE__H
+#define ROBOFLEX_TIMESTAMP_MERGE__H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <vector>
+#include "roboflex_core/node.h"
+#include "roboflex_core/util/owner_link.h"
+#include "roboflex_core/util/spsc_queue.h"
+
+namespace roboflex {
+using namespace core;
+namespace nodes {
+
+using std::string;
+
+/**
+ * Merges the messages of several producers into one stream, in timestamp
+ * order. Each producer connects to its own input, which has its own
+ * lock-free queue, so producers never contend with one another (an input
+ * refuses a second parent):
+ *
+ *   auto merge = std::make_shared<TimestampMerge>(0.02);
+ *   camera > merge->add_input("camera");
+ *   imu > merge->add_input("imu");
+ *   merge > fusion;
+ *   merge->start();
+ *
+ * Each input is connected to the merge, so walks from upstream (such as
+ * GraphRoot's start_all, metrics instrumentation, and snapshot_graph)
+ * reach it and whatever follows it. Messages don't go over that
+ * connection, though, but through the input's queue. The inputs keep
+ * the merge alive, as parents do; the merge doesn't keep its inputs
+ * alive - whatever connects to them does.
+ *
+ * The merge runs in its own thread. A message is signalled once every
+ * input has delivered something at least as recent (so nothing earlier
+ * can still arrive), or once it is older than the lateness window,
+ * whichever comes first. Ties go by input, then by arrival.
+ *
+ * How old a message is depends on the clock. By default it's event
+ * time: measured against the latest timestamp any input has delivered,
+ * so recorded data merges the same way when replayed, at any speed.
+ * With WallClock, it's measured against the current time, which flushes
+ * messages even when every input goes quiet - but replayed data, whose
+ * timestamps are all in the past, is then always "late".
+ *
+ * The output order is the same every time only as long as no input lags
+ * the others by more than the lateness window: past that, what gets
+ * flushed (and what arrives late) depends on when messages arrive.
+ *
+ * Assumes each input's timestamps don't go backwards. A message that
+ * arrives after something later has already been signalled is late, and
+ * dropped; a message that arrives to a full input queue is dropped too.
+ * Both are counted.
+ */
+class TimestampMerge: public RunnableNode {
+public:
+
+    enum class Clock {
+        EventTime,
+        WallClock
+    };
+
+    TimestampMerge(
+        double lateness_window = 0.05,
+        size_t queue_capacity = 256,
+        Clock clock = Clock::EventTime,
+        const string& name = "TimestampMerge");
+    virtual ~TimestampMerge();
+
+    // Inputs must be added before start(). get_input is nullptr if the
+    // input has gone.
+    NodePtr add_input(const string& name = "");
+    NodePtr get_input(size_t index) const;
+    size_t get_num_inputs() const { return input_queues.size(); }
+
+    double get_lateness_window() const { return lateness_window; }
+    Clock get_clock() const { return clock; }
+
+    uint64_t get_num_signalled() const { return num_signalled; }
+    uint64_t get_num_late() const { return num_late; }
+    uint64_t get_num_overflowed() const;
+
+    void request_stop() override;
+
+    string to_string() const override;
+
+protected:
+
+    // What the merge keeps of each input: the merge owns these, so they
+    // last as long as it does, whatever happens to the input nodes.
+    struct InputQueue {
+        InputQueue(size_t index, size_t capacity): index(index), queue(capacity) {}
+
+        size_t index;
+        util::SpscQueue<MessagePtr> queue;
+        std::atomic<uint64_t> num_overflowed = 0;
+
+        // only touched by the merge thread
+        double latest_timestamp = -1;
+        uint64_t num_received = 0;
+    };
+
+    class Input: public Node {
+    public:
+        Input(util::OwnerLink<TimestampMerge> merge, InputQueue* queue, const string& name):
+            Node(name), merge(merge), queue(queue) {}
+
+        void receive(MessagePtr m) override;
+
+        // The queue takes one producer: refuse a second parent.
+        void on_connect(const Node& node, bool node_is_child) override;
+        void on_disconnect(const Node& node, bool node_is_child) override;
+
+        std::mutex parent_mutex;
+        const Node* parent = nullptr;
+        size_t num_parent_connections = 0;
+
+        // cut when the merge goes away, in case we outlive it; queue
+        // is only touched through it
+        util::OwnerLink<TimestampMerge> merge;
+        InputQueue* queue;
+    };
+
+    struct Pending {
+        double timestamp;
+        size_t input_index;
+        uint64_t sequence;
+        MessagePtr message;
+
+        // std::priority_queue is a max-heap: "less" means later
+        bool operator<(const Pending& other) const {
+            if (timestamp != other.timestamp) return timestamp > other.timestamp;
+            if (input_index != other.input_index) return input_index > other.input_index;
+            return sequence > other.sequence;
+        }
+    };
+
+    void child_thread_fn() override;
+
+    // Moves everything the inputs have queued into the heap.
+    void drain_inputs();
+
+    // Whether nothing earlier than t can still arrive.
+    bool all_inputs_past(double t) const;
+
+    // What lateness is measured against.
+    double now() const;
+
+    void wake();
+
+    double lateness_window;
+    size_t queue_capacity;
+    Clock clock;
+    std::vector<std::unique_ptr<InputQueue>> input_queues;
+    std::vector<util::OwnerLink<TimestampMerge>> input_links;
+    std::vector<std::weak_ptr<Input>> inputs;
+
+    std::priority_queue<Pending> pending;
+    double last_signalled_timestamp = -1;
+
+    // the latest timestamp any input has delivered
+    double latest_event_time = -1;
+    std::atomic<uint64_t> num_signalled = 0;
+    std::atomic<uint64_t> num_late = 0;
+
+    // The merge thread sleeps on this when there's nothing to do;
+    // inputs only take the lock to wake it.
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    std::atomic<bool> sleeping = false;
+};
+
+} // namespace nodes
+} // namespace roboflex
+
+#endif // ROBOFLEX_TIMESTAMP_MERGE__H
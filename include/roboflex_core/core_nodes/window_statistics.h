@@ -0,0 +1,373 @@
+#ifndef ROBOFLEX_WINDOW_STATISTICS__H
+#define ROBOFLEX_WINDOW_STATISTICS__H
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <xsimd/xsimd.hpp>
+#include "roboflex_core/node.h"
+#include "roboflex_core/serialization/flex_xtensor.h"
+#include "roboflex_core/core_messages/core_messages.h"
+#include "roboflex_core/core_messages/direct_write_message.h"
+
+namespace roboflex {
+using namespace core;
+namespace nodes {
+
+/**
+ * What a WindowStatistics node signals: per-channel statistics over the
+ * window, each a float64 tensor of shape [channels], under "mean",
+ * "variance" (the population variance), "min" and "max", and the number
+ * of samples they cover under "count".
+ */
+class WindowStatisticsMessage: public Message {
+public:
+
+    constexpr static char WindowStatisticsMessageType[] = "WindowStatistics";
+
+    WindowStatisticsMessage(Message& other): Message(other, WindowStatisticsMessageType) {}
+
+    const serialization::flextensor_adaptor<double> mean() const { return get(serialization::FlexKey("mean")); }
+    const serialization::flextensor_adaptor<double> variance() const { return get(serialization::FlexKey("variance")); }
+    const serialization::flextensor_adaptor<double> min() const { return get(serialization::FlexKey("min")); }
+    const serialization::flextensor_adaptor<double> max() const { return get(serialization::FlexKey("max")); }
+    uint64_t count() const { return root_val(serialization::FlexKey("count")).AsUInt64(); }
+
+    void print_on(ostream& os) const override {
+        os << "<WindowStatisticsMessage count: " << count() << " ";
+        Message::print_on(os);
+        os << ">";
+    }
+
+protected:
+
+    const serialization::flextensor_adaptor<double> get(const serialization::FlexKey& key) const {
+        return serialization::deserialize_flex_tensor<double, 1>(root_val(key));
+    }
+};
+
+
+// The per-sample kernels, vectorized with xsimd across channels. Channels
+// are independent of one another, so no floating-point sum is reordered:
+// each lane does exactly what the scalar tail does (no fma, either), and
+// the results don't depend on the instruction set.
+//
+// The sums are of each sample's difference from a per-channel shift - a
+// recent mean - rather than of the samples themselves: a channel sitting
+// at 1000 with noise of 0.001 would otherwise lose its whole variance to
+// cancellation in sum_sq/n - mean^2.
+
+inline void window_add_sample(double* sum, double* sum_sq, const double* shift, const double* in, size_t num_channels)
+{
+    size_t c = 0;
+#if !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE)
+    using batch = xsimd::batch<double>;
+    constexpr size_t width = batch::size;
+    for (; c + width <= num_channels; c += width) {
+        batch x = batch::load_unaligned(in + c) - batch::load_unaligned(shift + c);
+        (batch::load_unaligned(sum + c) + x).store_unaligned(sum + c);
+        (batch::load_unaligned(sum_sq + c) + x * x).store_unaligned(sum_sq + c);
+    }
+#endif
+    for (; c < num_channels; c++) {
+        double x = in[c] - shift[c];
+        sum[c] += x;
+        sum_sq[c] += x * x;
+    }
+}
+
+inline void window_replace_sample(double* sum, double* sum_sq, const double* shift, const double* in, const double* out, size_t num_channels)
+{
+    size_t c = 0;
+#if !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE)
+    using batch = xsimd::batch<double>;
+    constexpr size_t width = batch::size;
+    for (; c + width <= num_channels; c += width) {
+        batch k = batch::load_unaligned(shift + c);
+        batch x = batch::load_unaligned(in + c) - k;
+        batch y = batch::load_unaligned(out + c) - k;
+        (batch::load_unaligned(sum + c) + (x - y)).store_unaligned(sum + c);
+        (batch::load_unaligned(sum_sq + c) + (x * x - y * y)).store_unaligned(sum_sq + c);
+    }
+#endif
+    for (; c < num_channels; c++) {
+        double x = in[c] - shift[c];
+        double y = out[c] - shift[c];
+        sum[c] += x - y;
+        sum_sq[c] += x * x - y * y;
+    }
+}
+
+inline void window_mean_variance(
+    const double* sum, const double* sum_sq, const double* shift, double* mean, double* variance,
+    size_t num_channels, size_t count)
+{
+    double scale = count == 0 ? 0.0 : 1.0 / count;
+    size_t c = 0;
+#if !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE)
+    using batch = xsimd::batch<double>;
+    constexpr size_t width = batch::size;
+    const batch scale_batch(scale);
+    const batch zero(0.0);
+    for (; c + width <= num_channels; c += width) {
+        batch d = batch::load_unaligned(sum + c) * scale_batch;
+        (batch::load_unaligned(shift + c) + d).store_unaligned(mean + c);
+        xsimd::max(batch::load_unaligned(sum_sq + c) * scale_batch - d * d, zero).store_unaligned(variance + c);
+    }
+#endif
+    for (; c < num_channels; c++) {
+        double d = sum[c] * scale;
+        mean[c] = shift[c] + d;
+        variance[c] = std::max(sum_sq[c] * scale - d * d, 0.0);
+    }
+}
+
+
+/**
+ * A Node that keeps statistics - mean, variance, min and max - of each
+ * channel of a signal over a sliding window of its last window_size
+ * samples, and signals them (as a WindowStatisticsMessage) for every
+ * message it receives.
+ *
+ * Incoming tensors are [channels, n]: n new samples of each channel, with
+ * time along the last dimension, as for TensorRightBuffer. A rank-1
+ * tensor is a single sample. The number of channels is fixed by the first
+ * message.
+ *
+ * The statistics are maintained incrementally, so each message costs
+ * O(channels * n), no matter how long the window: running sums and sums
+ * of squares of each sample's difference from the channel's mean as of
+ * the last re-sum (re-summed once per window, so that rounding can't
+ * drift), and monotonic queues for min and max. Nothing is signalled
+ * until the window holds at least one sample.
+ */
+template <typename T>
+class WindowStatistics: public Node {
+public:
+    WindowStatistics(
+        size_t window_size,
+        const std::string& tensor_key_in = "t",
+        const std::string& name = "WindowStatistics"):
+            Node(name),
+            window_size(window_size),
+            tensor_key_in(tensor_key_in),
+            tensor_key_in_handle(serialization::FlexKey::intern(tensor_key_in))
+    {
+        if (window_size == 0) {
+            throw std::runtime_error("WindowStatistics \"" + name + "\": window_size must be at least 1");
+        }
+    }
+
+    void receive(MessagePtr m) override;
+    std::string to_string() const override;
+
+    size_t get_window_size() const { return window_size; }
+    size_t get_num_channels() const { return num_channels; }
+    uint64_t get_num_samples() const { return num_samples; }
+
+protected:
+
+    // For each channel, the sequence numbers of the samples that can
+    // still be the window's extreme, oldest first, in a ring of
+    // window_size. Whether it tracks the min or the max is up to Better.
+    template <typename Better>
+    struct MonotonicQueues {
+
+        void reset(size_t num_channels, size_t window_size) {
+            this->window_size = window_size;
+            sequences.assign(num_channels * window_size, 0);
+            heads.assign(num_channels, 0);
+            sizes.assign(num_channels, 0);
+        }
+
+        // values[s % window_size * num_channels + c] is sample s of channel c
+        void push(size_t c, uint64_t sequence, const double* values, size_t num_channels) {
+            uint64_t* ring = sequences.data() + c * window_size;
+            double v = values[sequence % window_size * num_channels + c];
+
+            // whatever's no better than v, and older, can't be the extreme anymore
+            while (sizes[c] > 0) {
+                uint64_t back = ring[(heads[c] + sizes[c] - 1) % window_size];
+                if (Better()(values[back % window_size * num_channels + c], v)) {
+                    break;
+                }
+                sizes[c]--;
+            }
+
+            // the one that just left the window
+            if (sizes[c] > 0 && ring[heads[c]] + window_size <= sequence) {
+                heads[c] = (heads[c] + 1) % window_size;
+                sizes[c]--;
+            }
+
+            ring[(heads[c] + sizes[c]) % window_size] = sequence;
+            sizes[c]++;
+        }
+
+        uint64_t front(size_t c) const {
+            return sequences[c * window_size + heads[c]];
+        }
+
+        size_t window_size = 0;
+        std::vector<uint64_t> sequences;
+        std::vector<size_t> heads;
+        std::vector<size_t> sizes;
+    };
+
+    void reset(size_t num_channels);
+    void add_sample(const double* column);
+    void resum();
+
+    size_t window_size;
+    std::string tensor_key_in;
+    serialization::FlexKey tensor_key_in_handle;
+
+    mutable std::mutex stats_mutex;
+    size_t num_channels = 0;
+    uint64_t num_samples = 0;
+
+    // the window's samples, sample-major: [window_size, num_channels]
+    std::vector<double> samples;
+    std::vector<double> column;
+    std::vector<double> shift;
+    std::vector<double> sum;
+    std::vector<double> sum_sq;
+    MonotonicQueues<std::less<double>> min_queues;
+    MonotonicQueues<std::greater<double>> max_queues;
+
+    MessageLayout layout;
+    ArraySlot<double> mean_slot;
+    ArraySlot<double> variance_slot;
+    ArraySlot<double> min_slot;
+    ArraySlot<double> max_slot;
+    ScalarSlot<uint64_t> count_slot;
+};
+
+template <typename T>
+void WindowStatistics<T>::reset(size_t num_channels)
+{
+    this->num_channels = num_channels;
+    num_samples = 0;
+    samples.assign(window_size * num_channels, 0.0);
+    column.assign(num_channels, 0.0);
+    shift.assign(num_channels, 0.0);
+    sum.assign(num_channels, 0.0);
+    sum_sq.assign(num_channels, 0.0);
+    min_queues.reset(num_channels, window_size);
+    max_queues.reset(num_channels, window_size);
+
+    layout = MessageLayout();
+    mean_slot = layout.add_array<double>("mean", {num_channels});
+    variance_slot = layout.add_array<double>("variance", {num_channels});
+    min_slot = layout.add_array<double>("min", {num_channels});
+    max_slot = layout.add_array<double>("max", {num_channels});
+
+    count_slot = layout.add_scalar<uint64_t>("count");
+}
+
+template <typename T>
+void WindowStatistics<T>::add_sample(const double* column)
+{
+    uint64_t sequence = num_samples++;
+    double* row = samples.data() + sequence % window_size * num_channels;
+
+    if (sequence == 0) {
+        std::copy(column, column + num_channels, shift.begin());
+    }
+    if (sequence < window_size) {
+        window_add_sample(sum.data(), sum_sq.data(), shift.data(), column, num_channels);
+    } else {
+        window_replace_sample(sum.data(), sum_sq.data(), shift.data(), column, row, num_channels);
+    }
+    std::copy(column, column + num_channels, row);
+
+    for (size_t c = 0; c < num_channels; c++) {
+        min_queues.push(c, sequence, samples.data(), num_channels);
+        max_queues.push(c, sequence, samples.data(), num_channels);
+    }
+
+    if (num_samples % window_size == 0) {
+        resum();
+    }
+}
+
+template <typename T>
+void WindowStatistics<T>::resum()
+{
+    // re-center on the window's current mean, then sum afresh
+    size_t n = std::min<uint64_t>(num_samples, window_size);
+    if (n > 0) {
+        for (size_t c = 0; c < num_channels; c++) {
+            shift[c] += sum[c] / n;
+        }
+    }
+    std::fill(sum.begin(), sum.end(), 0.0);
+    std::fill(sum_sq.begin(), sum_sq.end(), 0.0);
+    for (size_t s = 0; s < n; s++) {
+        window_add_sample(sum.data(), sum_sq.data(), shift.data(), samples.data() + s * num_channels, num_channels);
+    }
+}
+
+template <typename T>
+void WindowStatistics<T>::receive(MessagePtr m)
+{
+    // deserialize into an xtensor adapter... no copy yet!
+    auto tensor = serialization::deserialize_flex_array<T>(m->root_val(tensor_key_in_handle));
+    const auto& shape = tensor.shape();
+    if (shape.size() != 1 && shape.size() != 2) {
+        throw std::runtime_error("WindowStatistics \"" + get_name() + "\" expected a tensor of rank 1 or 2, but got rank " + std::to_string(shape.size()));
+    }
+    size_t channels = shape[0];
+    size_t n = shape.size() == 2 ? shape[1] : 1;
+
+    std::lock_guard<std::mutex> lock(stats_mutex);
+
+    if (num_channels == 0) {
+        reset(channels);
+    } else if (channels != num_channels) {
+        throw std::runtime_error("WindowStatistics \"" + get_name() + "\" expected " + std::to_string(num_channels) + " channels, but got " + std::to_string(channels));
+    }
+
+    const T* data = tensor.data();
+    for (size_t j = 0; j < n; j++) {
+        for (size_t c = 0; c < num_channels; c++) {
+            column[c] = static_cast<double>(data[c * n + j]);
+        }
+        add_sample(column.data());
+    }
+
+    // an empty first message leaves nothing to take statistics of
+    size_t count = std::min<uint64_t>(num_samples, window_size);
+    if (count == 0) {
+        return;
+    }
+
+    auto out = std::make_shared<DirectWriteMessage>(CoreModuleName, WindowStatisticsMessage::WindowStatisticsMessageType, layout);
+    window_mean_variance(sum.data(), sum_sq.data(), shift.data(), out->data(mean_slot), out->data(variance_slot), num_channels, count);
+    double* mins = out->data(min_slot);
+    double* maxs = out->data(max_slot);
+    for (size_t c = 0; c < num_channels; c++) {
+        mins[c] = samples[min_queues.front(c) % window_size * num_channels + c];
+        maxs[c] = samples[max_queues.front(c) % window_size * num_channels + c];
+    }
+    out->set(count_slot, uint64_t(count));
+
+    this->signal(out);
+}
+
+template <typename T>
+std::string WindowStatistics<T>::to_string() const
+{
+    std::stringstream sst;
+    sst << "<WindowStatistics window_size=" << window_size
+        << " channels=" << num_channels
+        << " samples=" << num_samples
+        << " " << Node::to_string() << ">";
+    return sst.str();
+}
+
+} // namespace nodes
+} // namespace roboflex
+
+#endif // ROBOFLEX_WINDOW_STATISTICS__H
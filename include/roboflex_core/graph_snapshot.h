@@ -0,0 +1,56 @@
+#ifndef ROBOFLEX_CORE_GRAPH_SNAPSHOT__H
+#define ROBOFLEX_CORE_GRAPH_SNAPSHOT__H
+
+#include <string>
+#include <vector>
+#include "node.h"
+
+namespace roboflex::core {
+
+/**
+ * A picture of a graph as it is running: its nodes, what they are and
+ * whether they have threads, and its connections, with how much has
+ * gone over each (from the counters every node keeps as it signals - no
+ * MetricsNodes needed). Take one with node.snapshot_graph(); two taken a
+ * while apart give rates.
+ *
+ * Can be written as JSON, or as DOT for graphviz (edges labelled with
+ * their counts, and drawn heavier the more bytes went over them).
+ */
+struct GraphSnapshot {
+
+    struct NodeInfo {
+        uuid guid;
+        string name;
+
+        // the node's class, demangled where the compiler allows
+        string type;
+
+        bool runnable = false;
+        bool running = false;
+        string thread_name;
+
+        float congestion = 0;
+    };
+
+    struct EdgeInfo {
+        uuid parent_guid;
+        uuid child_guid;
+        uint64_t messages = 0;
+        uint64_t bytes = 0;
+        double last_time = 0;
+    };
+
+    // when it was taken
+    double time = 0;
+
+    std::vector<NodeInfo> nodes;
+    std::vector<EdgeInfo> edges;
+
+    string to_json() const;
+    string to_dot() const;
+};
+
+} // namespace roboflex::core
+
+#endif // ROBOFLEX_CORE_GRAPH_SNAPSHOT__H
@@ -4,6 +4,7 @@
 #include "message_backing_store.h"
 #include "flatbuffers/flexbuffers.h"
 #include "serialization/flex_utils.h"
+#include "serialization/flex_key.h"
 #include "util/uuid.h"
 #include "util/utils.h"
 
@@ -73,13 +74,21 @@ public:
         return root_map()[key];
     }
 
+    // The fast way: with a precomputed key. Positions of recently used keys
+    // are cached with the payload, so repeated lookups of the same key -
+    // through this message, or any other wrapping the same payload - skip
+    // the search.
+    flexbuffers::Reference root_val(const serialization::FlexKey& key) const;
+
     // Meta information is a vector off of the root
     // map under the key "_meta". The value is a
     // vector of values of different types, containing
     // the timestamp, message counter, source node info,
     // and so on...
+    inline static constexpr serialization::FlexKey MetaKey = serialization::FlexKey("_meta");
+
     flexbuffers::Vector get_meta() const {
-        return root_val("_meta").AsVector();
+        return root_val(MetaKey).AsVector();
     }
 
     // Position 0: timestamp
@@ -150,6 +159,17 @@ public:
         return get_meta()[5].AsString().str();
     }
 
+    // The same two, without copying: valid as long as the message is.
+    std::string_view module_name_view() const {
+        auto s = get_meta()[4].AsString();
+        return std::string_view(s.c_str(), s.size());
+    }
+
+    std::string_view message_name_view() const {
+        auto s = get_meta()[5].AsString();
+        return std::string_view(s.c_str(), s.size());
+    }
+
     const MessageBackingStorePtr payload() const { return _data; }
 
     // Get the actual active bytes and size
@@ -1,6 +1,8 @@
 #ifndef ROBOFLEX_CORE_MESSAGE_BACKING_STORE__H
 #define ROBOFLEX_CORE_MESSAGE_BACKING_STORE__H
 
+#include <array>
+#include <atomic>
 #include <cstring>
 #include <iostream>
 #include <iomanip>
@@ -74,6 +76,20 @@ struct MessageBackingStore
     virtual uint8_t* get_raw_data() = 0;
     virtual const uint8_t* get_raw_data() const = 0;
     virtual uint32_t get_raw_size() const = 0;
+
+    // Where keys were found in the root map, indexed by key hash (see
+    // Message::root_val). It lives with the bytes, so that every Message
+    // wrapping them - TensorMessage(*m) and the like - shares it. Each
+    // entry is (top of hash | position); readers on different threads may
+    // race to fill it, which is harmless since every hit is verified.
+    struct RootKeyCache {
+        static constexpr size_t NumEntries = 8;
+        mutable std::array<std::atomic<uint64_t>, NumEntries> entries = {};
+        RootKeyCache() {}
+        RootKeyCache(const RootKeyCache&) {}
+        RootKeyCache& operator=(const RootKeyCache&) { return *this; }
+    };
+    RootKeyCache root_key_cache;
 };
 
 inline std::ostream& operator<< (ostream& os, const MessageBackingStore& m)
@@ -88,7 +104,7 @@ using MessageBackingStorePtr = shared_ptr<MessageBackingStore>;
 struct MessageBackingStoreVector: public MessageBackingStore
 {
     MessageBackingStoreVector(vector<uint8_t> && bytes):
-        vec_bytes(bytes) {}
+        vec_bytes(std::move(bytes)) {}
 
     MessageBackingStoreVector(const uint8_t* bytes, size_t length):
         vec_bytes(bytes, bytes+length) {}
@@ -122,6 +138,29 @@ struct MessageBackingStoreNew: public MessageBackingStore
     size_t size;
 };
 
+// Copies the bytes into storage that starts on a MESSAGE_DATA_ALIGNMENT
+// boundary, so that data aligned relative to the message start (such as
+// tensor blobs - see serialize_flex_tensor) is aligned in memory.
+constexpr size_t MESSAGE_DATA_ALIGNMENT = 64;
+
+struct MessageBackingStoreAligned: public MessageBackingStore
+{
+    MessageBackingStoreAligned(const uint8_t* bytes, size_t length);
+    virtual ~MessageBackingStoreAligned();
+
+    MessageBackingStoreAligned(const MessageBackingStoreAligned&) = delete;
+    MessageBackingStoreAligned& operator=(const MessageBackingStoreAligned&) = delete;
+
+    uint8_t* get_raw_data() override { return data; }
+    const uint8_t* get_raw_data() const override { return data; }
+    uint32_t get_raw_size() const override { return size; }
+
+    void print_on(ostream& os) const override;
+
+    uint8_t * data;
+    size_t size;
+};
+
 } // namespace roboflex::core
 
 #endif // ROBOFLEX_CORE_MESSAGE_BACKING_STORE__H
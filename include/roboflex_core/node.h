@@ -1,23 +1,55 @@
 #ifndef ROBOFLEX_CORE_NODE__H
 #define ROBOFLEX_CORE_NODE__H
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <list>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 #include "message.h"
 #include "util/uuid.h"
+#include "util/thread_config.h"
 
 namespace roboflex::core {
 
 using std::string, std::shared_ptr, std::ostream, std::list, std::set, sole::uuid;
 
+class Node;
+struct GraphSnapshot;
+
+/**
+ * What has gone over one connection: kept by the parent as it signals,
+ * always, so it has to be cheap - relaxed atomics, bumped once per
+ * message per child.
+ */
+struct EdgeCounters {
+    std::atomic<uint64_t> messages = 0;
+    std::atomic<uint64_t> bytes = 0;
+
+    // when the last message went over it (as from get_current_time), or 0
+    std::atomic<double> last_time = 0;
+};
+
+// A copy of one connection's counters, and who it leads to.
+struct EdgeStats {
+    shared_ptr<Node> child;
+    uint64_t messages;
+    uint64_t bytes;
+    double last_time;
+};
+
 /**
  * A Node is a basic unit of computation. It can be connected to other nodes,
  * and it can signal and receive messages. Reception is done via inheritance.
+ * Every node is in the NodeRegistry (see node_registry.h) while it lives.
  */
-class Node {
+class Node: public std::enable_shared_from_this<Node> {
 public:
     using NodePtr = shared_ptr<Node>;
 
@@ -45,12 +77,20 @@ public:
     size_t num_observers() const;
     list<NodePtr> get_observers() const;
 
+    // Appends this node's observers to nodes: for walks, which
+    // reuse one vector instead of copying a list per node.
+    void append_observers(std::vector<NodePtr>& nodes) const;
+    std::vector<EdgeStats> get_edge_stats() const;
+
     // Sugar for .connect
     Node& operator > (Node& other);
     NodePtr operator > (NodePtr other);
 
     // Various ways to walk nodes and connections. Callbacks
     // are called with the node and the depth from this node.
+    // The order is worked out before the first callback (and
+    // remembered until the graph changes), so walks see the
+    // graph as it was when they began.
     using NodeWalkCallback = std::function<void(NodePtr, int)>;
     void walk_nodes(NodeWalkCallback node_fun, bool forwards) const;
     void walk_nodes_forwards(NodeWalkCallback node_fun) const;
@@ -67,6 +107,10 @@ public:
     using NodeFilterCallback = std::function<bool(NodePtr, int)>;
     void filter_nodes(NodeFilterCallback filter_fun);
 
+    // Everything reachable from this node (this one included), and what's
+    // flowing between them: see graph_snapshot.h.
+    GraphSnapshot snapshot_graph() const;
+
 
     // --- Signal and receive methods. ---
 
@@ -80,10 +124,65 @@ public:
     virtual void receive(MessagePtr m);
 
  
+    // --- Backpressure ---
+
+    // How backed-up this node is, from 0 (keeping up) to 1 (saturated).
+    // Plain nodes run in their parent's thread and so are never behind;
+    // nodes that hand messages off to another thread (such as Producer)
+    // override this.
+    virtual float get_congestion() const { return 0; }
+
+    // The highest congestion of any node downstream of this one. Producers
+    // can poll this to adapt: skip frames, reduce resolution, lower rate...
+    float get_downstream_congestion() const;
+
+
     // --- RPC --- 
 
+    // The rpc handlers every node of a class answers, by a hash of module
+    // and message name. Each class keeps one, in a function-local static
+    // (class_rpc_table), starting from a copy of its parent class's, and
+    // returns it from get_rpc_table. Adding the same names again replaces
+    // the handler, so a subclass can override its parent's.
+    class RpcTable {
+    public:
+        using Handler = std::function<MessagePtr(Node&, MessagePtr)>;
+
+        RpcTable& add(const string& module_name, const string& message_name, Handler handler);
+
+        // Adds a handler that takes the node as the class N that it's for.
+        template <typename N, typename F>
+        RpcTable& add_for(const string& module_name, const string& message_name, F f) {
+            return add(module_name, message_name, [f](Node& node, MessagePtr m) { return f(static_cast<N&>(node), m); });
+        }
+
+        const Handler* find(std::string_view module_name, std::string_view message_name) const;
+
+    protected:
+        struct Entry {
+            string module_name;
+            string message_name;
+            Handler handler;
+        };
+        std::unordered_map<uint64_t, Entry> entries;
+    };
+
+    static const RpcTable& class_rpc_table();
+    virtual const RpcTable& get_rpc_table() const { return class_rpc_table(); }
+
+    // Answers an rpc message with the handler registered for its module
+    // and message name - this node's own, else its class's - or nullptr
+    // if there isn't one.
     virtual MessagePtr handle_rpc(MessagePtr rpc_message);
 
+    // Registers what handle_rpc answers, for this node alone, for the given
+    // module and message name, ahead of its class's. For handlers made at
+    // run time (from python, say); classes should use their RpcTable.
+    // Handlers must not register handlers.
+    using RpcHandler = std::function<MessagePtr(MessagePtr)>;
+    void register_rpc_handler(const string& module_name, const string& message_name, RpcHandler handler);
+    bool has_rpc_handler(const string& module_name, const string& message_name) const;
+
 protected:
 
     // Every node has a name, but it is optional, 
@@ -96,7 +195,12 @@ protected:
     // Every node has a list of observers. We protect this 
     // list with a mutex. We can pay the cost of a mutex,
     // because we signal messages at a few kHz at most.
-    list<NodePtr> observers;
+    // Each connection counts what went over it.
+    struct Observer {
+        NodePtr node;
+        std::unique_ptr<EdgeCounters> counters;
+    };
+    list<Observer> observers;
     mutable std::recursive_mutex observer_collection_mutex;
 
     // locks mutex, incs count, calls receive on all observers or just on me
@@ -106,8 +210,19 @@ protected:
     // Used for out-of-order tracking and metrics.
     uint64_t message_send_counter = 0;
 
+    // This node's own RPC handlers; null until one is registered, which
+    // most nodes never do.
+    std::unique_ptr<RpcTable> rpc_handlers;
+    mutable std::shared_mutex rpc_handlers_mutex;
+
+    static uint64_t rpc_key(std::string_view module_name, std::string_view message_name);
+
     // called when I get connected to a node, both ways (whether I am the parent or child).
+    // The child is called first, before the connection is made: it can throw to refuse it.
     virtual void on_connect(const Node&, bool) {}
+
+    // called when a connection to a node is removed, once per connection, both ways.
+    virtual void on_disconnect(const Node&, bool) {}
 };
 
 
@@ -122,6 +237,9 @@ public:
     RunnableNode(const string& name = "");
     virtual ~RunnableNode();
 
+    static const RpcTable& class_rpc_table();
+    const RpcTable& get_rpc_table() const override { return class_rpc_table(); }
+
     string to_string() const override;
 
     virtual void start();
@@ -137,7 +255,15 @@ public:
     // another thread).
     void run();
 
-    MessagePtr handle_rpc(MessagePtr rpc_message) override;
+    // How the thread should be set up (cpu affinity, scheduling policy
+    // and priority, name, memory locking) before child_thread_fn runs.
+    // Applied by start() (and run()) - if anything can't be applied,
+    // the thread is not run, and start() throws a runtime_error that
+    // says what failed. Threads that start() launches are named after
+    // the node by default; run() renames the caller's thread only if
+    // thread_name is set.
+    void set_thread_config(const util::ThreadConfig& config) { thread_config = config; }
+    const util::ThreadConfig& get_thread_config() const { return thread_config; }
 
 protected:
 
@@ -148,6 +274,8 @@ protected:
     std::unique_ptr<std::thread> my_thread = nullptr;
     std::atomic<bool> stop_signal = {true};
 
+    util::ThreadConfig thread_config;
+
     // Child classes should override this 
     // method to run in a thread.
     virtual void child_thread_fn() {}
@@ -0,0 +1,118 @@
+#ifndef ROBOFLEX_CORE_NODE_REGISTRY__H
+#define ROBOFLEX_CORE_NODE_REGISTRY__H
+
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "node.h"
+#include "util/uuid_map.h"
+
+namespace roboflex::core {
+
+/**
+ * Every node in the process, found by guid or by name with one hash
+ * lookup instead of a walk. Nodes join it when they are constructed and
+ * leave it when they are destroyed; it never keeps one alive.
+ *
+ * Lookups only find nodes owned by shared_ptrs, and return an owning
+ * pointer. They skip nodes that have no owner: ones still being built
+ * by make_shared, ones being destroyed, and ones that never will have
+ * one (on the stack, say).
+ *
+ * It also remembers the order in which walk_nodes and walk_connections
+ * visit the graph below each node they start from, so that repeated
+ * walks (instrumenting metrics, starting and stopping, routing rpcs)
+ * don't traverse the graph again each time. Any connect, disconnect, or
+ * node destruction forgets them all.
+ */
+class NodeRegistry {
+public:
+
+    using NodePtr = Node::NodePtr;
+
+    // The process-wide instance, created on first use.
+    static NodeRegistry& instance();
+
+    // nullptr if there is no such node
+    NodePtr find(const uuid& guid) const;
+
+    // names need not be unique
+    std::vector<NodePtr> find_by_name(const string& name) const;
+
+    std::vector<NodePtr> get_nodes() const;
+    size_t size() const;
+
+    // bumped on every connect, disconnect, and node destruction
+    uint64_t get_topology_version() const;
+
+    struct NodeVisit {
+        NodePtr node;
+        int depth;
+    };
+
+    struct ConnectionVisit {
+        NodePtr parent;
+        NodePtr child;
+        int depth;
+    };
+
+    // Appends the order a walk from root last visited, if it is still
+    // current. On false, order may hold part of it: clear it.
+    bool get_node_order(const Node* root, bool forwards, std::vector<NodeVisit>& order) const;
+    bool get_connection_order(const Node* root, bool forwards, std::vector<ConnectionVisit>& order) const;
+
+    // Remembers the order a walk from root visited, unless the graph
+    // changed since topology_version was read.
+    void set_node_order(const Node* root, bool forwards, uint64_t topology_version, const std::vector<NodeVisit>& order);
+    void set_connection_order(const Node* root, bool forwards, uint64_t topology_version, const std::vector<ConnectionVisit>& order);
+
+protected:
+
+    friend class Node;
+
+    NodeRegistry() = default;
+
+    void add(Node* node);
+    void remove(Node* node);
+    void topology_changed();
+
+    // called with the lock held
+    void forget_orders();
+
+    // An owning pointer, or nullptr if the node has no owner.
+    static NodePtr pointer_to(Node* node);
+
+    // For cached walks: as above if the walk found the node through an
+    // owning pointer, else the same non-owning one connect(Node&) makes.
+    static NodePtr pointer_to(Node* node, bool owned);
+
+    util::UuidMap<Node*> nodes_by_guid;
+    std::unordered_multimap<string, Node*> nodes_by_name;
+
+    struct CachedNodeVisit {
+        Node* node;
+        bool owned;
+        int depth;
+    };
+
+    struct CachedConnectionVisit {
+        Node* parent;
+        bool parent_owned;
+        Node* child;
+        bool child_owned;
+        int depth;
+    };
+
+    // by direction: [0] backwards, [1] forwards
+    std::unordered_map<const Node*, std::vector<CachedNodeVisit>> node_orders[2];
+    std::unordered_map<const Node*, std::vector<CachedConnectionVisit>> connection_orders[2];
+
+    uint64_t topology_version = 0;
+
+    mutable std::shared_mutex registry_mutex;
+};
+
+} // namespace roboflex::core
+
+#endif // ROBOFLEX_CORE_NODE_REGISTRY__H
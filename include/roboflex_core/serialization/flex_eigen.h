@@ -12,8 +12,13 @@
 namespace roboflex {
 namespace serialization {
 
+/**
+ * Serialize an eigen matrix the same way as serialize_flex_tensor does
+ * an xtensor. If aligned (the default), the data is padded to start on a
+ * TensorDataAlignment-byte boundary from the start of the buffer.
+ */
 template <typename T, int NRows, int NCols, int Options=Eigen::ColMajor>
-void serialize_eigen_matrix(flexbuffers::Builder& fbb, const Eigen::Matrix<T, NRows, NCols, Options>& matrix, const std::string& name="")
+void serialize_eigen_matrix(flexbuffers::Builder& fbb, const Eigen::Matrix<T, NRows, NCols, Options>& matrix, const std::string& name="", bool aligned=true)
 {
     // get a vector of the shape
     std::vector<uint64_t> shape_vector = { (uint64_t)matrix.rows(), (uint64_t)matrix.cols() };
@@ -33,8 +38,14 @@ void serialize_eigen_matrix(flexbuffers::Builder& fbb, const Eigen::Matrix<T, NR
         fbb.Key(ShapeKey);
         fbb.Vector(shape_vector);
         fbb.Key(DataKey);
+        if (aligned) {
+            pad_for_aligned_blob(fbb, num_bytes);
+        }
         fbb.Blob(byte_data, num_bytes);
         fbb.Int(DTypeKey, tensor_dtype_indexer<T>::index);
+        if (aligned) {
+            fbb.Int(AlignKey, TensorDataAlignment);
+        }
     });
 }
 
@@ -48,6 +59,9 @@ Eigen::Map<const Eigen::Matrix<T, NRows, NCols, Options>> deserialize_eigen_matr
     if (!is_tensor(r)) {
         throw std::runtime_error("flex_tensor::deserialize_eigen_matrix was not handed a tensor");
     }
+    if (tensor_encoding(r) != EncodingNone) {
+        throw std::runtime_error("flex_tensor::deserialize_eigen_matrix was handed an encoded tensor; decode it first (see TensorDecoder)");
+    }
 
     flexbuffers::Map m = r.AsMap();
 
@@ -89,7 +103,7 @@ Eigen::Map<const Eigen::Matrix<T, NRows, NCols, Options>> deserialize_eigen_matr
     }
 
     // read actual data
-    auto blob = m[DataKey].AsBlob();
+    auto blob = lookup(m, DataFlexKey).AsBlob();
     const uint8_t * data_bytes = blob.data();
     const T * data_typed = (const T*)data_bytes;
 
@@ -104,6 +118,25 @@ Eigen::Map<const Eigen::Matrix<T, NRows, NCols, Options>> deserialize_eigen_matr
     return retval;
 }
 
+/**
+ * Like deserialize_eigen_matrix, but returns a map that eigen may use
+ * aligned loads and stores on. Throws if the data is not actually aligned.
+ */
+template <typename T, int NRows, int NCols, int Options=Eigen::ColMajor>
+Eigen::Map<const Eigen::Matrix<T, NRows, NCols, Options>, Eigen::Aligned64> deserialize_eigen_matrix_aligned(flexbuffers::Reference r)
+{
+    auto unaligned = deserialize_eigen_matrix<T, NRows, NCols, Options>(r);
+    if (reinterpret_cast<uintptr_t>(unaligned.data()) % 64 != 0) {
+        throw std::runtime_error(
+            "flex_eigen::deserialize_eigen_matrix_aligned found matrix data that is not 64-byte aligned "
+            "(declared alignment: " + std::to_string(tensor_alignment(r)) + ").");
+    }
+    return Eigen::Map<const Eigen::Matrix<T, NRows, NCols, Options>, Eigen::Aligned64>(
+        unaligned.data(),
+        unaligned.rows(),
+        unaligned.cols());
+}
+
 } // namespace serialization
 } // namespace roboflex
 
@@ -0,0 +1,72 @@
+#ifndef ROBOFLEX_SERIALIZATION_CORE_FLEX_KEY__H
+#define ROBOFLEX_SERIALIZATION_CORE_FLEX_KEY__H
+
+#include <cstdint>
+#include <string>
+#include <flatbuffers/flexbuffers.h>
+
+namespace roboflex {
+namespace serialization {
+
+/**
+ * A precomputed handle to a flexbuffer map key: the characters, their
+ * length, and a hash. Looking a FlexKey up in a map builds no std::string
+ * and compares lengths before bytes; Message::root_val also caches where
+ * each key was found, by hash.
+ *
+ * Make them from string literals at compile time:
+ *
+ *   constexpr FlexKey TimestampKey("t");
+ *
+ * or from runtime strings with FlexKey::intern, which keeps one copy
+ * of each distinct string alive for the life of the process. Interning
+ * a key a thread has interned before takes no lock, but still hashes
+ * the string: nodes should intern their keys once, not per message.
+ */
+struct FlexKey {
+
+    const char* str;
+    uint32_t length;
+    uint64_t hash;
+
+    template <size_t N>
+    constexpr FlexKey(const char (&s)[N]):
+        str(s), length(N - 1), hash(hash_of(s, N - 1)) {}
+
+    static FlexKey intern(const std::string& s);
+
+    // Like intern(s), but if s is known's key, returns known without
+    // taking the intern lock: for runtime keys that are usually a default.
+    static FlexKey intern(const std::string& s, const FlexKey& known) {
+        return s.compare(0, s.size(), known.str, known.length) == 0 ? known : intern(s);
+    }
+
+    // FNV-1a
+    static constexpr uint64_t hash_of(const char* s, size_t n) {
+        uint64_t h = 14695981039346656037ull;
+        for (size_t i = 0; i < n; i++) {
+            h = (h ^ uint8_t(s[i])) * 1099511628211ull;
+        }
+        return h;
+    }
+
+    std::string to_string() const { return std::string(str, length); }
+
+private:
+    constexpr FlexKey(const char* s, uint32_t length, uint64_t hash):
+        str(s), length(length), hash(hash) {}
+};
+
+// strcmp, against a null-terminated key in a flexbuffer.
+int compare_key(const char* flex_key, const FlexKey& key);
+
+// Binary search of the map's keys; returns -1 if the key isn't there.
+int lookup_index(flexbuffers::Map m, const FlexKey& key);
+
+// Like m[key], but with a FlexKey. Null if the key isn't there.
+flexbuffers::Reference lookup(flexbuffers::Map m, const FlexKey& key);
+
+} // namespace serialization
+} // namespace roboflex
+
+#endif // ROBOFLEX_SERIALIZATION_CORE_FLEX_KEY__H
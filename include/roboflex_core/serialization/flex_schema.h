@@ -0,0 +1,199 @@
+#ifndef ROBOFLEX_SERIALIZATION_CORE_FLEX_SCHEMA__H
+#define ROBOFLEX_SERIALIZATION_CORE_FLEX_SCHEMA__H
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <flatbuffers/flexbuffers.h>
+#include "roboflex_core/serialization/flex_utils.h"
+
+namespace roboflex {
+namespace serialization {
+
+/**
+ * A string usable as a template parameter: Field<"elapsed_time", double>.
+ */
+template <size_t N>
+struct FixedString {
+    char value[N] = {};
+
+    constexpr FixedString(const char (&s)[N]) {
+        std::copy_n(s, N, value);
+    }
+
+    constexpr std::string_view view() const { return std::string_view(value, N - 1); }
+    constexpr const char* c_str() const { return value; }
+};
+
+/**
+ * One field of a FlexSchema: a key in the root map, and the c++ type its
+ * value is read as. Supported types: bool, integers, float, double,
+ * std::string, std::string_view, sole::uuid (16-byte blob),
+ * flexbuffers::Map, and flexbuffers::Reference (untyped).
+ */
+template <FixedString Name, typename T>
+struct Field {
+    static constexpr auto name = Name;
+    using type = T;
+};
+
+template <typename T>
+T flex_value_as(flexbuffers::Reference r)
+{
+    if constexpr (std::is_same_v<T, bool>) {
+        return r.AsBool();
+    } else if constexpr (std::is_same_v<T, float>) {
+        return r.AsFloat();
+    } else if constexpr (std::is_same_v<T, double>) {
+        return r.AsDouble();
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        return static_cast<T>(r.AsInt64());
+    } else if constexpr (std::is_integral_v<T>) {
+        return static_cast<T>(r.AsUInt64());
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return r.AsString().str();
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+        auto s = r.AsString();
+        return std::string_view(s.c_str(), s.size());
+    } else if constexpr (std::is_same_v<T, sole::uuid>) {
+        auto blob = r.AsBlob();
+        return deserialize_uuid(blob);
+    } else if constexpr (std::is_same_v<T, flexbuffers::Map>) {
+        return r.AsMap();
+    } else if constexpr (std::is_same_v<T, flexbuffers::Reference>) {
+        return r;
+    } else {
+        static_assert(sizeof(T) == 0, "flex_value_as: unsupported field type");
+    }
+}
+
+/**
+ * A schema, declared at compile time, for a flexbuffer map: which keys
+ * it has, and what type each value is. Constructing one over a map
+ * resolves every field in a single merge pass over the map's (sorted)
+ * keys; after that, get<"name">() is a typed, constant-time read of the
+ * value - no string comparisons. For example:
+ *
+ *   using ImuSchema = FlexSchema<
+ *       Field<"t", double>,
+ *       Field<"accel", flexbuffers::Reference>,
+ *       Field<"seq", uint64_t>>;
+ *
+ *   ImuSchema imu(message->root_map());
+ *   double t = imu.get<"t">();
+ *
+ * Naming a field that isn't in the schema is a compile error. Fields
+ * missing from the map read as flexbuffers' null (0, "", etc.); use has<>()
+ * to tell. It is only a view: the encoding is plain FlexBuffers, so
+ * messages stay readable by anything else (DynoFlex, python). Like the
+ * map it was constructed over, it is only valid while the message's
+ * payload is alive.
+ */
+template <typename... Fields>
+class FlexSchema {
+public:
+
+    static constexpr size_t NumFields = sizeof...(Fields);
+
+    FlexSchema() {
+        value_indexes.fill(Missing);
+    }
+
+    explicit FlexSchema(flexbuffers::Map m):
+        values(m.Values())
+    {
+        resolve(m);
+    }
+
+    template <FixedString Name>
+    static constexpr size_t index_of() {
+        constexpr size_t i = find_index(Name.view());
+        static_assert(i < NumFields, "FlexSchema has no field with that name");
+        return i;
+    }
+
+    template <FixedString Name>
+    bool has() const {
+        return value_indexes[index_of<Name>()] != Missing;
+    }
+
+    template <FixedString Name>
+    flexbuffers::Reference ref() const {
+        size_t value_index = value_indexes[index_of<Name>()];
+        return value_index == Missing ? flexbuffers::Reference() : values[value_index];
+    }
+
+    template <FixedString Name>
+    auto get() const {
+        using T = typename std::tuple_element_t<index_of<Name>(), std::tuple<Fields...>>::type;
+        return flex_value_as<T>(ref<Name>());
+    }
+
+    // Writes a value under a field's key, so that writers can't
+    // misspell keys either.
+    template <FixedString Name, typename V>
+    static void write(flexbuffers::Builder& fbb, const V& v) {
+        index_of<Name>();
+        if constexpr (std::is_same_v<V, sole::uuid>) {
+            serialize_uuid(v, Name.c_str(), fbb);
+        } else {
+            fbb.Key(Name.c_str());
+            fbb.Add(v);
+        }
+    }
+
+protected:
+
+    static constexpr size_t Missing = size_t(-1);
+
+    static constexpr std::array<std::string_view, NumFields> names = { Fields::name.view()... };
+
+    static constexpr size_t find_index(std::string_view name) {
+        for (size_t i = 0; i < NumFields; i++) {
+            if (names[i] == name) {
+                return i;
+            }
+        }
+        return NumFields;
+    }
+
+    // The schema's fields, ordered the same way flexbuffers orders map keys.
+    static constexpr std::array<size_t, NumFields> sorted_field_indexes = []() {
+        std::array<size_t, NumFields> indexes = {};
+        for (size_t i = 0; i < NumFields; i++) {
+            indexes[i] = i;
+        }
+        std::sort(indexes.begin(), indexes.end(), [](size_t a, size_t b) { return names[a] < names[b]; });
+        return indexes;
+    }();
+
+    void resolve(flexbuffers::Map m) {
+        value_indexes.fill(Missing);
+        auto keys = m.Keys();
+        size_t num_keys = keys.size();
+        size_t k = 0;
+        for (size_t f = 0; f < NumFields && k < num_keys; f++) {
+            size_t field_index = sorted_field_indexes[f];
+            const char* name = names[field_index].data();
+            int c = -1;
+            while (k < num_keys && (c = strcmp(keys[k].AsKey(), name)) < 0) {
+                k++;
+            }
+            if (k < num_keys && c == 0) {
+                value_indexes[field_index] = k;
+            }
+        }
+    }
+
+    flexbuffers::Vector values = flexbuffers::Vector::EmptyVector();
+    std::array<size_t, NumFields> value_indexes = {};
+};
+
+} // namespace serialization
+} // namespace roboflex
+
+#endif // ROBOFLEX_SERIALIZATION_CORE_FLEX_SCHEMA__H
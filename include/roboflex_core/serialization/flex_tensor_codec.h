@@ -0,0 +1,106 @@
+#ifndef ROBOFLEX_SERIALIZATION_CORE_FLEX_TENSOR_CODEC__H
+#define ROBOFLEX_SERIALIZATION_CORE_FLEX_TENSOR_CODEC__H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <flatbuffers/flexbuffers.h>
+#include "roboflex_core/serialization/flex_tensor_format.h"
+
+namespace roboflex {
+namespace serialization {
+
+/**
+ * Lossless codecs for tensor data, for sensor streams such as depth
+ * images and point clouds. See flex_tensor_format.h for how an encoded
+ * tensor is laid out. Encoding applies, in order: frame delta, byte
+ * shuffle, lz4. Decoding undoes them in reverse.
+ *
+ * EncodingFrameDelta: xor with the previous frame of the same stream, so
+ *   unchanged values become zero. Decoding needs the previous decoded
+ *   frame - see TensorEncoder and TensorDecoder, which keep that state,
+ *   and send periodic keyframes (frames without this flag).
+ *
+ * EncodingShuffle: groups the bytes of every element by significance
+ *   (all first bytes, then all second bytes...). High bytes of depth
+ *   and float data vary slowly, so this makes them compress far better.
+ *
+ * EncodingLZ4: compresses with lz4's block format, so that other
+ *   languages can decode it with any lz4 library (python: lz4.block).
+ */
+
+// The number of bytes of the tensor once decoded.
+size_t tensor_decoded_size(flexbuffers::Reference r);
+
+
+// -- the building blocks --
+
+void byte_shuffle(const uint8_t* src, uint8_t* dst, size_t num_bytes, size_t element_size);
+void byte_unshuffle(const uint8_t* src, uint8_t* dst, size_t num_bytes, size_t element_size);
+
+// dst[i] = a[i] ^ b[i]. dst may be a or b.
+void xor_bytes(const uint8_t* a, const uint8_t* b, uint8_t* dst, size_t num_bytes);
+
+// The most bytes lz4_compress can produce from num_bytes.
+size_t lz4_compress_bound(size_t num_bytes);
+
+// Compresses into dst, which must hold lz4_compress_bound(num_bytes).
+// Returns the compressed size.
+size_t lz4_compress(const uint8_t* src, size_t num_bytes, uint8_t* dst);
+
+// Decompresses exactly decompressed_size bytes into dst. Throws
+// std::runtime_error if the input is malformed.
+void lz4_decompress(const uint8_t* src, size_t num_bytes, uint8_t* dst, size_t decompressed_size);
+
+
+// -- whole tensors --
+
+// Encodes raw tensor data. previous is the previous frame's raw data
+// (the same size), required if encoding has EncodingFrameDelta.
+std::vector<uint8_t> encode_tensor_data(
+    const uint8_t* data,
+    size_t num_bytes,
+    size_t element_size,
+    int encoding,
+    const uint8_t* previous = nullptr);
+
+// Decodes into dst, which must hold num_bytes (the decoded size).
+// previous is the previous frame's decoded data, required if
+// encoding has EncodingFrameDelta.
+void decode_tensor_data(
+    const uint8_t* encoded,
+    size_t encoded_size,
+    uint8_t* dst,
+    size_t num_bytes,
+    size_t element_size,
+    int encoding,
+    const uint8_t* previous = nullptr);
+
+// Writes the raw tensor r into the builder as an encoded tensor.
+void serialize_encoded_tensor(
+    flexbuffers::Builder& fbb,
+    flexbuffers::Reference r,
+    const std::string& name,
+    int encoding,
+    const uint8_t* previous = nullptr,
+    uint64_t frame = 0);
+
+// Decodes the encoded tensor r into decoded (resized to fit).
+void decode_tensor(
+    flexbuffers::Reference r,
+    std::vector<uint8_t>& decoded,
+    const uint8_t* previous = nullptr);
+
+// Writes a raw, aligned tensor of the given dtype and shape into the builder.
+void serialize_raw_tensor(
+    flexbuffers::Builder& fbb,
+    const std::string& name,
+    int dtype,
+    const std::vector<size_t>& shape,
+    const uint8_t* data,
+    size_t num_bytes);
+
+} // namespace serialization
+} // namespace roboflex
+
+#endif // ROBOFLEX_SERIALIZATION_CORE_FLEX_TENSOR_CODEC__H
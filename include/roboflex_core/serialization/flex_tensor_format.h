@@ -26,6 +26,18 @@
  *      "dtype": data type index, UInt8
  *    }
  *
+ * plus, optionally, "align": Int. If present, the data was padded so that it
+ * starts on a multiple of that many bytes from the start of the buffer (the
+ * start of the message, for messages). Readers that get the buffer in aligned
+ * storage (see MessageBackingStoreAligned) can then rely on aligned loads.
+ *
+ * plus, optionally, "encoding": Int. If present and not 0, "data" holds
+ * the tensor's bytes encoded with one or more lossless codecs (a bitmask
+ * of the Encoding* flags below - see flex_tensor_codec.h), and "frame":
+ * UInt, the tensor's position in its stream. "shape" and "dtype" always
+ * describe the decoded tensor. Encoded tensors can't be deserialized in
+ * place; decode them first (TensorDecoder, or decode_tensor).
+ *
  * That data type index is an index representing the tensor numeric type
  * (int32, float, etc), and is an index into this array:
  *
@@ -35,7 +47,8 @@
         np.intp, np.uintp,
         np.float32, np.float64,
         np.complex64, np.complex128,
-        np.float16
+        np.float16,
+        bfloat16 (ml_dtypes.bfloat16, where available)
     ]
  *
  * All the fancy template code you see is designed to turn a numeric
@@ -54,6 +67,8 @@
 
 #include <flatbuffers/flexbuffers.h>
 #include <xtl/xhalf_float.hpp>
+#include "roboflex_core/serialization/flex_key.h"
+#include "roboflex_core/util/half_precision.h"
 
 namespace roboflex {
 namespace serialization {
@@ -61,6 +76,26 @@ namespace serialization {
 constexpr char DataKey[] = "data";
 constexpr char ShapeKey[] = "shape";
 constexpr char DTypeKey[] = "dtype";
+constexpr char AlignKey[] = "align";
+
+constexpr FlexKey DataFlexKey = FlexKey(DataKey);
+constexpr FlexKey ShapeFlexKey = FlexKey(ShapeKey);
+constexpr FlexKey DTypeFlexKey = FlexKey(DTypeKey);
+constexpr FlexKey AlignFlexKey = FlexKey(AlignKey);
+
+constexpr char EncodingKey[] = "encoding";
+constexpr char FrameKey[] = "frame";
+
+constexpr FlexKey EncodingFlexKey = FlexKey(EncodingKey);
+constexpr FlexKey FrameFlexKey = FlexKey(FrameKey);
+
+constexpr int EncodingNone = 0;
+constexpr int EncodingFrameDelta = 1;
+constexpr int EncodingShuffle = 2;
+constexpr int EncodingLZ4 = 4;
+
+// Tensor data is aligned to this (a cache line, and the widest simd register).
+constexpr size_t TensorDataAlignment = 64;
 
 bool is_tensor(flexbuffers::Reference r);
 int tensor_type_code(flexbuffers::Reference r);
@@ -68,8 +103,29 @@ std::string tensor_type_name(flexbuffers::Reference r);
 int tensor_rank(flexbuffers::Reference r);
 std::vector<size_t> tensor_shape(flexbuffers::Reference r);
 
+// The alignment the tensor's data was written with, or 0 if none.
+int tensor_alignment(flexbuffers::Reference r);
+
+// Whether the tensor's data pointer actually is on its declared alignment.
+bool is_tensor_aligned(flexbuffers::Reference r);
+
+// Whether any of the map's values is a tensor written with alignment.
+bool has_aligned_tensors(flexbuffers::Map m);
+
+// The tensor's encoding flags, or EncodingNone.
+int tensor_encoding(flexbuffers::Reference r);
+
+// The tensor's frame number, or 0.
+uint64_t tensor_frame(flexbuffers::Reference r);
+
+// Pads the builder so that a Blob of num_bytes, written next, has its
+// data start on a TensorDataAlignment boundary relative to the start of
+// the builder's buffer.
+void pad_for_aligned_blob(flexbuffers::Builder& fbb, size_t num_bytes);
+
 std::string type_name_from_code(int type_code);
 int type_code_from_name(const std::string& type_name);
+size_t type_size_from_code(int type_code);
 
 template <typename T> struct tensor_dtype_indexer { constexpr static int index = -1; };
 template <> struct tensor_dtype_indexer<int8_t> { constexpr static int index = 0; };
@@ -87,6 +143,7 @@ template <> struct tensor_dtype_indexer<double> { constexpr static int index = 1
 //template <> struct tensor_dtype_indexer<complex64> { constexpr static int index = 12; };
 //template <> struct tensor_dtype_indexer<complex128> { constexpr static int index = 13; };
 template <> struct tensor_dtype_indexer<xtl::half_float> { constexpr static int index = 14; };
+template <> struct tensor_dtype_indexer<util::bfloat16> { constexpr static int index = 15; };
 
 template <typename T> struct tensor_dtype_namer { constexpr static std::string_view name = "wat"; };
 template <> struct tensor_dtype_namer<int8_t> { constexpr static std::string_view name = "int8_t"; };
@@ -104,6 +161,7 @@ template <> struct tensor_dtype_namer<double> { constexpr static std::string_vie
 //template <> struct tensor_dtype_namer<complex64> { constexpr static std::string_view name = "complex64"; };
 //template <> struct tensor_dtype_namer<complex128> { constexpr static std::string_view name = "complex128"; };
 template <> struct tensor_dtype_namer<xtl::half_float> { constexpr static std::string_view name = "float16"; };
+template <> struct tensor_dtype_namer<util::bfloat16> { constexpr static std::string_view name = "bfloat16"; };
 
 
 // useful for debugging
@@ -2,6 +2,8 @@
 #define ROBOFLEX_CORE_FLEX_TENSOR__H
 
 #include <iostream>
+#include <array>
+#include <cstring>
 #include <list>
 #include <vector>
 #include <string_view>
@@ -23,10 +25,14 @@ namespace serialization {
  *    "shape": [3, 480, 640],
  *    "dtype": 5,
  *    "data": <blob>,
+ *    "align": 64,
  * }
+ *
+ * If aligned (the default), the data is padded to start on a
+ * TensorDataAlignment-byte boundary from the start of the buffer.
  */
 template <typename T, size_t NDimensions>
-void serialize_flex_tensor(flexbuffers::Builder& fbb, const xt::xtensor<T, NDimensions>& tensor, const std::string& name="")
+void serialize_flex_tensor(flexbuffers::Builder& fbb, const xt::xtensor<T, NDimensions>& tensor, const std::string& name="", bool aligned=true)
 {
     // get a vector of the shape
     auto shape_vector = std::vector<uint64_t>(tensor.shape().begin(), tensor.shape().end());
@@ -46,13 +52,19 @@ void serialize_flex_tensor(flexbuffers::Builder& fbb, const xt::xtensor<T, NDime
         fbb.Key(ShapeKey);
         fbb.Vector(shape_vector);
         fbb.Key(DataKey);
+        if (aligned) {
+            pad_for_aligned_blob(fbb, num_bytes);
+        }
         fbb.Blob(byte_data, num_bytes);
         fbb.Int(DTypeKey, tensor_dtype_indexer<T>::index);
+        if (aligned) {
+            fbb.Int(AlignKey, TensorDataAlignment);
+        }
     });
 }
 
 template <typename T>
-void serialize_flex_array(flexbuffers::Builder& fbb, const xt::xarray<T>& tensor, const std::string& name="")
+void serialize_flex_array(flexbuffers::Builder& fbb, const xt::xarray<T>& tensor, const std::string& name="", bool aligned=true)
 {
     // get a vector of the shape
     auto shape_vector = std::vector<uint64_t>(tensor.shape().begin(), tensor.shape().end());
@@ -72,8 +84,14 @@ void serialize_flex_array(flexbuffers::Builder& fbb, const xt::xarray<T>& tensor
         fbb.Key(ShapeKey);
         fbb.Vector(shape_vector);
         fbb.Key(DataKey);
+        if (aligned) {
+            pad_for_aligned_blob(fbb, num_bytes);
+        }
         fbb.Blob(byte_data, num_bytes);
         fbb.Int(DTypeKey, tensor_dtype_indexer<T>::index);
+        if (aligned) {
+            fbb.Int(AlignKey, TensorDataAlignment);
+        }
     });
 }
 
@@ -92,7 +110,7 @@ void serialize_flex_array(flexbuffers::Builder& fbb, const xt::xarray<T>& tensor
  * }
  */
 template <typename T, size_t NDimensions>
-void serialize_flex_tensor(flexbuffers::Builder& fbb, const std::array<size_t, NDimensions>& tensor_shape, const std::string& name="")
+void serialize_flex_tensor(flexbuffers::Builder& fbb, const std::array<size_t, NDimensions>& tensor_shape, const std::string& name="", bool aligned=true)
 {
     // get a vector of the shape
     auto shape_vector = std::vector<uint64_t>(tensor_shape.begin(), tensor_shape.end());
@@ -118,13 +136,19 @@ void serialize_flex_tensor(flexbuffers::Builder& fbb, const std::array<size_t, N
         fbb.Key(ShapeKey);
         fbb.Vector(shape_vector);
         fbb.Key(DataKey);
+        if (aligned) {
+            pad_for_aligned_blob(fbb, num_bytes);
+        }
         fbb.Blob(nullptr, num_bytes);
         fbb.Int(DTypeKey, tensor_dtype_indexer<T>::index);
+        if (aligned) {
+            fbb.Int(AlignKey, TensorDataAlignment);
+        }
     });
 }
 
 template <typename T>
-void serialize_flex_array(flexbuffers::Builder& fbb, const std::vector<size_t>& tensor_shape, const std::string& name="")
+void serialize_flex_array(flexbuffers::Builder& fbb, const std::vector<size_t>& tensor_shape, const std::string& name="", bool aligned=true)
 {
     // get a vector of the shape
     auto shape_vector = std::vector<uint64_t>(tensor_shape.begin(), tensor_shape.end());
@@ -150,8 +174,14 @@ void serialize_flex_array(flexbuffers::Builder& fbb, const std::vector<size_t>&
         fbb.Key(ShapeKey);
         fbb.Vector(shape_vector);
         fbb.Key(DataKey);
+        if (aligned) {
+            pad_for_aligned_blob(fbb, num_bytes);
+        }
         fbb.Blob(nullptr, num_bytes);
         fbb.Int(DTypeKey, tensor_dtype_indexer<T>::index);
+        if (aligned) {
+            fbb.Int(AlignKey, TensorDataAlignment);
+        }
     });
 }
 
@@ -184,6 +214,9 @@ flextensor_adaptor<T> deserialize_flex_array(flexbuffers::Reference r, bool prin
     if (!is_tensor(r)) {
         throw std::runtime_error("flex_tensor::deserialize_flex_array was not handed a tensor");
     }
+    if (tensor_encoding(r) != EncodingNone) {
+        throw std::runtime_error("flex_tensor::deserialize_flex_array was handed an encoded tensor; decode it first (see TensorDecoder)");
+    }
 
     flexbuffers::Map m = r.AsMap();
 
@@ -205,7 +238,7 @@ flextensor_adaptor<T> deserialize_flex_array(flexbuffers::Reference r, bool prin
     }
 
     // read actual data
-    auto blob = m[DataKey].AsBlob();
+    auto blob = lookup(m, DataFlexKey).AsBlob();
     const uint8_t * data_bytes = blob.data();
     const T * data_typed_const = (const T*)data_bytes;
 
@@ -238,6 +271,9 @@ flextensor_adaptor<T> deserialize_flex_tensor(flexbuffers::Reference r, bool pri
     if (!is_tensor(r)) {
         throw std::runtime_error("flex_tensor::deserialize_flex_tensor was not handed a tensor");
     }
+    if (tensor_encoding(r) != EncodingNone) {
+        throw std::runtime_error("flex_tensor::deserialize_flex_tensor was handed an encoded tensor; decode it first (see TensorDecoder)");
+    }
 
     flexbuffers::Map m = r.AsMap();
 
@@ -263,7 +299,7 @@ flextensor_adaptor<T> deserialize_flex_tensor(flexbuffers::Reference r, bool pri
     }
 
     // read actual data
-    auto blob = m[DataKey].AsBlob();
+    auto blob = lookup(m, DataFlexKey).AsBlob();
     const uint8_t * data_bytes = blob.data();
     const T * data_typed_const = (const T*)data_bytes;
 
@@ -297,6 +333,9 @@ flextensor_adaptor<T> deserialize_flex_tensor_no_dim_check(flexbuffers::Referenc
     if (!is_tensor(r)) {
         throw std::runtime_error("flex_tensor::deserialize_flex_tensor_no_dim_check was not handed a tensor");
     }
+    if (tensor_encoding(r) != EncodingNone) {
+        throw std::runtime_error("flex_tensor::deserialize_flex_tensor_no_dim_check was handed an encoded tensor; decode it first (see TensorDecoder)");
+    }
 
     flexbuffers::Map m = r.AsMap();
     
@@ -315,7 +354,7 @@ flextensor_adaptor<T> deserialize_flex_tensor_no_dim_check(flexbuffers::Referenc
     }
 
     // read actual data
-    auto blob = m[DataKey].AsBlob();
+    auto blob = lookup(m, DataFlexKey).AsBlob();
     const uint8_t * data_bytes = blob.data();
     const T * data_typed_const = (const T*)data_bytes;
 
@@ -331,6 +370,108 @@ flextensor_adaptor<T> deserialize_flex_tensor_no_dim_check(flexbuffers::Referenc
         vshape);
 }
 
+
+/**
+ * The 16-bit float formats a float32 tensor can be sent in: IEEE half
+ * (dtype 14), or bfloat16 (dtype 15), which keeps float32's range but
+ * less precision - usually the better choice for neural net activations.
+ */
+enum class ReducedPrecision {
+    Float16,
+    BFloat16
+};
+
+/**
+ * Serialize a float32 xtensor in reduced precision, at half the size.
+ * It's an ordinary float16 or bfloat16 tensor: read it as-is with
+ * deserialize_flex_tensor<xtl::half_float> (or <util::bfloat16>), or
+ * convert it back with deserialize_flex_tensor_as_float.
+ */
+template <size_t NDimensions>
+void serialize_flex_tensor_reduced(flexbuffers::Builder& fbb, const xt::xtensor<float, NDimensions>& tensor, ReducedPrecision precision, const std::string& name="", bool aligned=true)
+{
+    auto shape_vector = std::vector<uint64_t>(tensor.shape().begin(), tensor.shape().end());
+
+    std::vector<uint16_t> reduced(tensor.size());
+    int dtype;
+    if (precision == ReducedPrecision::Float16) {
+        util::float_to_half(tensor.data(), reduced.data(), reduced.size());
+        dtype = tensor_dtype_indexer<xtl::half_float>::index;
+    } else {
+        util::float_to_bfloat16(tensor.data(), reduced.data(), reduced.size());
+        dtype = tensor_dtype_indexer<util::bfloat16>::index;
+    }
+    size_t num_bytes = reduced.size() * sizeof(uint16_t);
+
+    if (!name.empty()) {
+        fbb.Key(name);
+    }
+
+    fbb.Map([&]() {
+        fbb.Key(ShapeKey);
+        fbb.Vector(shape_vector);
+        fbb.Key(DataKey);
+        if (aligned) {
+            pad_for_aligned_blob(fbb, num_bytes);
+        }
+        fbb.Blob(reduced.data(), num_bytes);
+        fbb.Int(DTypeKey, dtype);
+        if (aligned) {
+            fbb.Int(AlignKey, TensorDataAlignment);
+        }
+    });
+}
+
+/**
+ * Deserialize a float32, float16, or bfloat16 tensor into a new float32
+ * xtensor, converting as needed. Unlike deserialize_flex_tensor, this copies.
+ */
+template <size_t NDimensions>
+xt::xtensor<float, NDimensions> deserialize_flex_tensor_as_float(flexbuffers::Reference r)
+{
+    if (r.IsNull()) {
+        throw std::runtime_error("flex_tensor::deserialize_flex_tensor_as_float was handed a null reference");
+    }
+    if (!is_tensor(r)) {
+        throw std::runtime_error("flex_tensor::deserialize_flex_tensor_as_float was not handed a tensor");
+    }
+    if (tensor_encoding(r) != EncodingNone) {
+        throw std::runtime_error("flex_tensor::deserialize_flex_tensor_as_float was handed an encoded tensor; decode it first (see TensorDecoder)");
+    }
+
+    std::vector<size_t> vshape = tensor_shape(r);
+    if (vshape.size() != NDimensions) {
+        throw std::runtime_error(
+            "flex_tensor::deserialize_flex_tensor_as_float attempted to deserialize a tensor of rank " + std::to_string(NDimensions) +
+            ", but found a tensor of rank " + std::to_string(vshape.size()) + " (read shape as " + _vec_to_string(vshape) + ").");
+    }
+
+    std::array<size_t, NDimensions> shape;
+    std::copy(vshape.begin(), vshape.end(), shape.begin());
+    xt::xtensor<float, NDimensions> result(shape);
+
+    auto blob = lookup(r.AsMap(), DataFlexKey).AsBlob();
+    auto dtype = tensor_type_code(r);
+    if (blob.size() != result.size() * type_size_from_code(dtype)) {
+        throw std::runtime_error("flex_tensor::deserialize_flex_tensor_as_float found " + std::to_string(blob.size()) +
+            " bytes of data for a tensor of shape " + _vec_to_string(vshape));
+    }
+
+    if (dtype == tensor_dtype_indexer<float>::index) {
+        memcpy(result.data(), blob.data(), blob.size());
+    } else if (dtype == tensor_dtype_indexer<xtl::half_float>::index) {
+        util::half_to_float(reinterpret_cast<const uint16_t*>(blob.data()), result.data(), result.size());
+    } else if (dtype == tensor_dtype_indexer<util::bfloat16>::index) {
+        util::bfloat16_to_float(reinterpret_cast<const uint16_t*>(blob.data()), result.data(), result.size());
+    } else {
+        throw std::runtime_error(
+            "flex_tensor::deserialize_flex_tensor_as_float can read float, float16, and bfloat16 tensors, "
+            "but found a tensor of type " + type_name_from_code(dtype) + " (type code: " + std::to_string(dtype) + ").");
+    }
+
+    return result;
+}
+
 } // namespace serialization
 } // namespace roboflex
 
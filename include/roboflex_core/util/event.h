@@ -1,67 +1,158 @@
 #ifndef ROBOFLEX_EVENT__H
 #define ROBOFLEX_EVENT__H
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <mutex>
-#include <condition_variable>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 using namespace std::chrono_literals;
 
 namespace roboflex {
 namespace util {
 
-// https://codereview.stackexchange.com/questions/250647/c-reimplementation-of-pythons-threading-event
+// After python's threading.Event.
+//
+// One 32-bit word of state: whether it's set, and whether anyone might be
+// asleep waiting for it. Waiters sleep on that word itself (a futex, on
+// linux), so setting, clearing and testing take no lock, and setting only
+// makes a system call when someone is actually asleep.
+//
+// Waits can spin for a while before sleeping: pass spin_microseconds, for
+// consumers that would rather burn a core than pay for being woken up.
 
 class Event {
 private:
-    bool isSet_ = false;
-    std::mutex mutex;
-    std::condition_variable cv;
+
+    static constexpr uint32_t SetBit = 1;
+    static constexpr uint32_t WaitersBit = 2;
+
+    // Only ever 0, SetBit or WaitersBit: setting clears WaitersBit (and
+    // wakes them), and waiters only flag themselves while it's not set.
+    std::atomic<uint32_t> state = 0;
+    int spin_microseconds;
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free);
+
+    static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    // Sleeps while state is still expected, for at most timeout (or
+    // forever, if negative). May return early.
+    void park(uint32_t expected, std::chrono::nanoseconds timeout) {
+#if defined(__linux__)
+        struct timespec ts;
+        struct timespec* tsp = nullptr;
+        if (timeout.count() >= 0) {
+            ts.tv_sec = timeout.count() / 1000000000;
+            ts.tv_nsec = timeout.count() % 1000000000;
+            tsp = &ts;
+        }
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state), FUTEX_WAIT_PRIVATE, expected, tsp, nullptr, 0);
+#else
+        // std::atomic::wait can't time out, so timed waits nap instead
+        if (timeout.count() < 0) {
+            state.wait(expected, std::memory_order_acquire);
+        } else {
+            std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, 100us));
+        }
+#endif
+    }
+
+    void wake_all() {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+        state.notify_all();
+#endif
+    }
 
 public:
 
-    Event(): isSet_(false) {}
+    Event(int spin_microseconds = 0): spin_microseconds(spin_microseconds) {}
 
-    bool isSet() {
-        std::scoped_lock<std::mutex> lock(mutex);
-        return isSet_;
+    Event(const Event&) = delete;
+    Event& operator=(const Event&) = delete;
+
+    bool isSet() const {
+        return state.load(std::memory_order_acquire) & SetBit;
     };
 
     void set() {
-        std::scoped_lock<std::mutex> lock(mutex);
-        isSet_ = true;
-        cv.notify_all();
+        if (state.load(std::memory_order_relaxed) == SetBit) {
+            return;
+        }
+        if (state.exchange(SetBit, std::memory_order_acq_rel) & WaitersBit) {
+            wake_all();
+        }
     };
 
     void clear() {
-        std::scoped_lock<std::mutex> lock(mutex);
-        isSet_ = false;
+        if (state.load(std::memory_order_relaxed) & SetBit) {
+            state.fetch_and(~SetBit, std::memory_order_acq_rel);
+        }
     };
 
-    void wait(int timeout_milliseconds=0) {
-        std::unique_lock<std::mutex> unique_lock(mutex);
-        while (!isSet_) {
-            if (timeout_milliseconds > 0) {
-                cv.wait_for(unique_lock, timeout_milliseconds*1ms);
-            } else {
-                cv.wait(unique_lock);
+    // Waits until it's set, or timeout_milliseconds pass (0: forever).
+    // Returns whether it's set.
+    bool wait(int timeout_milliseconds=0) {
+        if (isSet()) {
+            return true;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (spin_microseconds > 0) {
+            auto spin_until = start + spin_microseconds * 1us;
+            while (std::chrono::steady_clock::now() < spin_until) {
+                for (int i = 0; i < 64; i++) {
+                    if (isSet()) {
+                        return true;
+                    }
+                    cpu_relax();
+                }
             }
         }
-    };
 
-    bool wait_once(int timeout_milliseconds=0) {
-        std::unique_lock<std::mutex> unique_lock(mutex);
-        if (isSet_) {
-            return true;
-        } else {
+        auto deadline = start + timeout_milliseconds * 1ms;
+        while (true) {
+            uint32_t s = state.load(std::memory_order_acquire);
+            if (s & SetBit) {
+                return true;
+            }
+            if (s != WaitersBit && !state.compare_exchange_weak(s, WaitersBit, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                continue;
+            }
             if (timeout_milliseconds > 0) {
-                cv.wait_for(unique_lock, timeout_milliseconds*1ms);
+                auto remaining = deadline - std::chrono::steady_clock::now();
+                if (remaining <= 0ns) {
+                    return isSet();
+                }
+                park(WaitersBit, remaining);
             } else {
-                cv.wait(unique_lock);
+                park(WaitersBit, -1ns);
             }
         }
-        return isSet_;
     };
+
+    // The same as wait: kept for existing callers.
+    bool wait_once(int timeout_milliseconds=0) {
+        return wait(timeout_milliseconds);
+    };
+
+    int get_spin_microseconds() const { return spin_microseconds; }
 };
 
 } // namespace util
@@ -0,0 +1,123 @@
+#ifndef ROBOFLEX_HALF_PRECISION__H
+#define ROBOFLEX_HALF_PRECISION__H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <xtl/xhalf_float.hpp>
+
+namespace roboflex {
+namespace util {
+
+/**
+ * Conversions between float32 and the two 16-bit float formats: IEEE
+ * half (float16: 5 exponent bits, 10 mantissa bits) and bfloat16 (float32
+ * with the low 16 mantissa bits dropped: same range, less precision).
+ * Both round to nearest even.
+ *
+ * The array versions are vectorized: F16C on x86 (chosen at runtime, so
+ * it works without -mf16c), NEON on arm64, plain loops otherwise.
+ */
+
+inline uint16_t float_to_half_bits(float value)
+{
+    const uint32_t f32_infinity = 255u << 23;
+    const uint32_t f16_max = (127u + 16) << 23;
+    const uint32_t denorm_magic_bits = ((127u - 15) + (23 - 10) + 1) << 23;
+
+    uint32_t f;
+    memcpy(&f, &value, 4);
+    uint32_t sign = f & 0x80000000u;
+    f ^= sign;
+
+    uint16_t h;
+    if (f >= f16_max) {
+        // too big: infinity, or nan
+        h = f > f32_infinity ? 0x7E00 : 0x7C00;
+    } else if (f < (113u << 23)) {
+        // a half denormal, or zero: let the fpu round it
+        float v, magic;
+        memcpy(&v, &f, 4);
+        memcpy(&magic, &denorm_magic_bits, 4);
+        v += magic;
+        memcpy(&f, &v, 4);
+        h = uint16_t(f - denorm_magic_bits);
+    } else {
+        uint32_t mantissa_odd = (f >> 13) & 1;
+        f += (uint32_t(15 - 127) << 23) + 0xFFF;
+        f += mantissa_odd;
+        h = uint16_t(f >> 13);
+    }
+    return h | uint16_t(sign >> 16);
+}
+
+inline float half_bits_to_float(uint16_t h)
+{
+    const uint32_t shifted_exponent = 0x7C00u << 13;
+    uint32_t f = (h & 0x7FFFu) << 13;
+    uint32_t exponent = f & shifted_exponent;
+    f += (127u - 15) << 23;
+    if (exponent == shifted_exponent) {
+        // infinity, or nan
+        f += (128u - 16) << 23;
+    } else if (exponent == 0) {
+        // zero, or denormal: renormalize
+        const uint32_t magic_bits = 113u << 23;
+        float v, magic;
+        f += 1u << 23;
+        memcpy(&v, &f, 4);
+        memcpy(&magic, &magic_bits, 4);
+        v -= magic;
+        memcpy(&f, &v, 4);
+    }
+    f |= uint32_t(h & 0x8000u) << 16;
+    float value;
+    memcpy(&value, &f, 4);
+    return value;
+}
+
+inline uint16_t float_to_bfloat16_bits(float value)
+{
+    uint32_t f;
+    memcpy(&f, &value, 4);
+    uint16_t rounded = uint16_t((f + 0x7FFFu + ((f >> 16) & 1)) >> 16);
+    uint16_t quiet_nan = uint16_t((f >> 16) | 0x40);
+    return (f & 0x7FFFFFFFu) > 0x7F800000u ? quiet_nan : rounded;
+}
+
+inline float bfloat16_bits_to_float(uint16_t b)
+{
+    uint32_t f = uint32_t(b) << 16;
+    float value;
+    memcpy(&value, &f, 4);
+    return value;
+}
+
+/**
+ * A bfloat16 value, so that it can be a tensor element type (dtype 15).
+ */
+struct bfloat16 {
+    uint16_t bits = 0;
+
+    bfloat16() = default;
+    bfloat16(float value): bits(float_to_bfloat16_bits(value)) {}
+    operator float() const { return bfloat16_bits_to_float(bits); }
+};
+
+static_assert(sizeof(bfloat16) == 2, "bfloat16 must be 16 bits");
+static_assert(sizeof(xtl::half_float) == 2, "xtl::half_float must be 16 bits");
+
+void float_to_half(const float* src, uint16_t* dst, size_t n);
+void half_to_float(const uint16_t* src, float* dst, size_t n);
+void float_to_bfloat16(const float* src, uint16_t* dst, size_t n);
+void bfloat16_to_float(const uint16_t* src, float* dst, size_t n);
+
+inline void float_to_half(const float* src, xtl::half_float* dst, size_t n) { float_to_half(src, reinterpret_cast<uint16_t*>(dst), n); }
+inline void half_to_float(const xtl::half_float* src, float* dst, size_t n) { half_to_float(reinterpret_cast<const uint16_t*>(src), dst, n); }
+inline void float_to_bfloat16(const float* src, bfloat16* dst, size_t n) { float_to_bfloat16(src, reinterpret_cast<uint16_t*>(dst), n); }
+inline void bfloat16_to_float(const bfloat16* src, float* dst, size_t n) { bfloat16_to_float(reinterpret_cast<const uint16_t*>(src), dst, n); }
+
+} // namespace util
+} // namespace roboflex
+
+#endif // ROBOFLEX_HALF_PRECISION__H
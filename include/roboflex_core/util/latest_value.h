@@ -0,0 +1,200 @@
+#ifndef ROBOFLEX_LATEST_VALUE__H
+#define ROBOFLEX_LATEST_VALUE__H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace roboflex {
+namespace util {
+
+/**
+ * A single slot holding a shared_ptr, that any number of threads may
+ * load from and store to at once, without locks: loading never blocks a
+ * store, nor the other way around. It's for values that one side keeps
+ * replacing and the other polls, such as the latest message from a
+ * sensor.
+ *
+ * (std::atomic<std::shared_ptr> would do, but isn't everywhere yet, and
+ * where it is, it's usually a spinlock.)
+ *
+ * How: each stored value lives in a Holder, and the slot is one 64-bit
+ * word packing a pointer to the Holder with a count of readers that are
+ * in the middle of copying its value out. A reader bumps the count as it
+ * loads the pointer, so the Holder can't go away under it, and then
+ * gives its count back - to the slot if the Holder is still there, and
+ * otherwise to the Holder, where the store that replaced it moved the
+ * slot's count. Whoever brings the Holder's count to zero deletes it.
+ *
+ * Assumes pointers fit in 48 bits (true of user space on x86-64 and
+ * arm64), and that fewer than 65536 threads load at once.
+ */
+template <typename T>
+class LatestValue {
+public:
+
+    LatestValue() = default;
+    explicit LatestValue(std::shared_ptr<T> value) { store(std::move(value)); }
+
+    LatestValue(const LatestValue&) = delete;
+    LatestValue& operator=(const LatestValue&) = delete;
+
+    ~LatestValue() { retire(slot.exchange(0, std::memory_order_acq_rel)); }
+
+    std::shared_ptr<T> load() const {
+        if (slot.load(std::memory_order_relaxed) == 0) {
+            return nullptr;
+        }
+        uint64_t packed = slot.fetch_add(OneReader, std::memory_order_acquire);
+        Holder* holder = pointer(packed);
+        std::shared_ptr<T> value = holder == nullptr ? nullptr : holder->value;
+        release(holder);
+        return value;
+    }
+
+    void store(std::shared_ptr<T> value) {
+        retire(slot.exchange(pack(std::move(value)), std::memory_order_acq_rel));
+    }
+
+    // Stores value, and returns what it replaced.
+    std::shared_ptr<T> exchange(std::shared_ptr<T> value) {
+        uint64_t old = slot.exchange(pack(std::move(value)), std::memory_order_acq_rel);
+        Holder* holder = pointer(old);
+        std::shared_ptr<T> previous = holder == nullptr ? nullptr : holder->value;
+        retire(old);
+        return previous;
+    }
+
+    // Cheaper than load() != nullptr.
+    bool has_value() const {
+        return pointer(slot.load(std::memory_order_acquire)) != nullptr;
+    }
+
+protected:
+
+    struct Holder {
+        Holder(std::shared_ptr<T>&& value): value(std::move(value)) {}
+        const std::shared_ptr<T> value;
+        std::atomic<int64_t> count = 0;
+    };
+
+    static constexpr int CountShift = 48;
+    static constexpr uint64_t PointerMask = (uint64_t(1) << CountShift) - 1;
+    static constexpr uint64_t OneReader = uint64_t(1) << CountShift;
+
+    static Holder* pointer(uint64_t packed) {
+        return reinterpret_cast<Holder*>(packed & PointerMask);
+    }
+
+    static uint64_t pack(std::shared_ptr<T>&& value) {
+        if (value == nullptr) {
+            return 0;
+        }
+        auto holder = new Holder(std::move(value));
+        uint64_t packed = reinterpret_cast<uintptr_t>(holder);
+        if ((packed & ~PointerMask) != 0) {
+            delete holder;
+            throw std::runtime_error("LatestValue: pointer does not fit in 48 bits");
+        }
+        return packed;
+    }
+
+    // Gives back a reader's count on holder.
+    void release(Holder* holder) const {
+        uint64_t current = slot.load(std::memory_order_relaxed);
+        while (pointer(current) == holder) {
+            if (slot.compare_exchange_weak(current, current - OneReader, std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        // it was replaced, and our count moved to the holder
+        if (holder != nullptr && holder->count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete holder;
+        }
+    }
+
+    // Takes the word a store replaced: moves its readers' counts to the
+    // holder, which goes once they've all given them back.
+    static void retire(uint64_t old) {
+        Holder* holder = pointer(old);
+        if (holder == nullptr) {
+            return;
+        }
+        int64_t readers = int64_t(old >> CountShift);
+        if (holder->count.fetch_add(readers, std::memory_order_acq_rel) == -readers) {
+            delete holder;
+        }
+    }
+
+    mutable std::atomic<uint64_t> slot = 0;
+};
+
+/**
+ * A LatestValue per key. Loads, and stores to keys already seen, take no
+ * locks. The map of keys is itself a LatestValue, replaced by a copy when
+ * a new key turns up - so only the first store to each key locks, and
+ * only against other new keys.
+ */
+template <typename T>
+class KeyedLatestValue {
+public:
+
+    KeyedLatestValue(): slots(std::make_shared<const Slots>()) {}
+
+    std::shared_ptr<T> load(const std::string& key) const {
+        auto current = slots.load();
+        auto it = current->find(key);
+        return it == current->end() ? nullptr : it->second->load();
+    }
+
+    void store(const std::string& key, std::shared_ptr<T> value) {
+        get_slot(key)->store(std::move(value));
+    }
+
+    std::vector<std::string> keys() const {
+        auto current = slots.load();
+        std::vector<std::string> result;
+        result.reserve(current->size());
+        for (auto& [key, slot]: *current) {
+            result.push_back(key);
+        }
+        return result;
+    }
+
+protected:
+
+    using Slots = std::unordered_map<std::string, std::shared_ptr<LatestValue<T>>>;
+
+    std::shared_ptr<LatestValue<T>> get_slot(const std::string& key) {
+        auto current = slots.load();
+        auto it = current->find(key);
+        if (it != current->end()) {
+            return it->second;
+        }
+
+        std::lock_guard<std::mutex> lock(new_key_mutex);
+        current = slots.load();
+        it = current->find(key);
+        if (it != current->end()) {
+            return it->second;
+        }
+        auto replacement = std::make_shared<Slots>(*current);
+        auto slot = std::make_shared<LatestValue<T>>();
+        replacement->emplace(key, slot);
+        slots.store(std::move(replacement));
+        return slot;
+    }
+
+    LatestValue<const Slots> slots;
+    std::mutex new_key_mutex;
+};
+
+} // namespace util
+} // namespace roboflex
+
+#endif // ROBOFLEX_LATEST_VALUE__H
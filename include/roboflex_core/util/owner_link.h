@@ -0,0 +1,88 @@
+#ifndef ROBOFLEX_OWNER_LINK__H
+#define ROBOFLEX_OWNER_LINK__H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace roboflex {
+namespace util {
+
+/**
+ * Lets a helper call into the object that made it - an input node calling
+ * into its TimestampMerge, say - for only as long as that object lives,
+ * from any thread.
+ *
+ * Copies share one link. The owner cuts it from its destructor, before
+ * its members go: cut() waits for any call under way to finish, and
+ * calls after that do nothing. So the owner must not be destroyed from
+ * inside a call through its own link.
+ *
+ * A call takes no lock: it bumps a count of calls under way, then checks
+ * that the link is still whole; cut() marks it cut, then waits for the
+ * count to drain. Give each producer its own link, so that they don't
+ * share the count's cache line.
+ */
+template <typename T>
+class OwnerLink {
+public:
+
+    OwnerLink() = default;
+    explicit OwnerLink(T* owner): state(std::make_shared<State>(owner)) {}
+
+    // Calls f(owner), unless the link is cut. Returns whether it did.
+    template <typename F>
+    bool call(F&& f) const {
+        if (state == nullptr) {
+            return false;
+        }
+        State& s = *state;
+        s.num_calls.fetch_add(1, std::memory_order_seq_cst);
+        if (s.is_cut.load(std::memory_order_seq_cst)) {
+            s.finish_call();
+            return false;
+        }
+        struct Finish {
+            State& s;
+            ~Finish() { s.finish_call(); }
+        } finish{s};
+        f(*s.owner);
+        return true;
+    }
+
+    void cut() {
+        if (state == nullptr) {
+            return;
+        }
+        State& s = *state;
+        s.is_cut.store(true, std::memory_order_seq_cst);
+        for (uint32_t n = s.num_calls.load(std::memory_order_seq_cst); n != 0; n = s.num_calls.load(std::memory_order_seq_cst)) {
+            s.num_calls.wait(n, std::memory_order_seq_cst);
+        }
+    }
+
+    bool is_cut() const { return state == nullptr || state->is_cut.load(std::memory_order_acquire); }
+
+protected:
+
+    struct State {
+        explicit State(T* owner): owner(owner) {}
+
+        void finish_call() {
+            if (num_calls.fetch_sub(1, std::memory_order_seq_cst) == 1 && is_cut.load(std::memory_order_seq_cst)) {
+                num_calls.notify_all();
+            }
+        }
+
+        T* owner;
+        std::atomic<uint32_t> num_calls = 0;
+        std::atomic<bool> is_cut = false;
+    };
+
+    std::shared_ptr<State> state;
+};
+
+} // namespace util
+} // namespace roboflex
+
+#endif // ROBOFLEX_OWNER_LINK__H
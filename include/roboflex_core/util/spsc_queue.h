@@ -0,0 +1,89 @@
+#ifndef ROBOFLEX_SPSC_QUEUE__H
+#define ROBOFLEX_SPSC_QUEUE__H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace roboflex {
+namespace util {
+
+/**
+ * A bounded, lock-free, single-producer single-consumer queue. One thread
+ * (at a time) may push, and one thread (at a time) may pop; neither ever
+ * blocks or takes a lock. "At a time" means producers may change, as long
+ * as something else (such as a mutex) orders them.
+ *
+ * Capacity is rounded up to a power of two.
+ */
+template <typename T>
+class SpscQueue {
+public:
+
+    explicit SpscQueue(size_t min_capacity = 256) {
+        size_t capacity = 2;
+        while (capacity < min_capacity) {
+            capacity *= 2;
+        }
+        slots.resize(capacity);
+        mask = capacity - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Returns false, and leaves value alone, if the queue is full.
+    bool try_push(T&& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head_cache == slots.size()) {
+            head_cache = head.load(std::memory_order_acquire);
+            if (t - head_cache == slots.size()) {
+                return false;
+            }
+        }
+        slots[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if the queue is empty.
+    bool try_pop(T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail_cache) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (h == tail_cache) {
+                return false;
+            }
+        }
+        value = std::move(slots[h & mask]);
+        slots[h & mask] = T();
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate, when called while others push or pop.
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return slots.size(); }
+
+protected:
+
+    std::vector<T> slots;
+    size_t mask;
+
+    // The producer's and consumer's indexes live on separate cache lines,
+    // each next to that side's cached copy of the other's index.
+    alignas(64) std::atomic<size_t> tail = 0;
+    size_t head_cache = 0;
+    alignas(64) std::atomic<size_t> head = 0;
+    size_t tail_cache = 0;
+};
+
+} // namespace util
+} // namespace roboflex
+
+#endif // ROBOFLEX_SPSC_QUEUE__H
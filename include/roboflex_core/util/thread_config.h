@@ -0,0 +1,74 @@
+#ifndef ROBOFLEX_THREAD_CONFIG__H
+#define ROBOFLEX_THREAD_CONFIG__H
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+
+namespace roboflex {
+namespace util {
+
+enum class SchedulingPolicy {
+    Default,    // whatever the os gives us (SCHED_OTHER on linux)
+    FIFO,       // SCHED_FIFO: real-time, requires priority 1..99
+    RoundRobin  // SCHED_RR: real-time, requires priority 1..99
+};
+
+/**
+ * How a thread should be set up before it runs: which cores it may
+ * run on, its scheduling policy and priority, its name (as seen by
+ * top, htop, perf, gdb...), and whether to lock the process's memory.
+ *
+ * Real-time policies and memory locking usually need privileges
+ * (CAP_SYS_NICE, CAP_IPC_LOCK, or an rtprio/memlock ulimit).
+ */
+struct ThreadConfig {
+    std::vector<int> cpu_affinity = {};
+    SchedulingPolicy scheduling_policy = SchedulingPolicy::Default;
+    int priority = 0;
+    std::string thread_name = "";
+
+    // Locks all current and future pages of the process into memory.
+    // NOTE: this is process-wide, not per-thread.
+    bool lock_memory = false;
+
+    std::string to_string() const;
+};
+
+/**
+ * Applies the config to the calling thread. If config.thread_name is
+ * empty, default_thread_name is used. Names are truncated to the 15
+ * characters that linux allows. Returns a description of each thing that
+ * failed; empty on success.
+ */
+std::vector<std::string> apply_thread_config(
+    const ThreadConfig& config,
+    const std::string& default_thread_name = "");
+
+/**
+ * What apply_thread_config may change about a thread, so that a caller
+ * that lends its own thread (RunnableNode::run) can put it back the way
+ * it was. Memory locking is process-wide and is not part of it.
+ */
+struct ThreadState {
+    std::string thread_name = "";
+    int scheduling_policy = SCHED_OTHER;
+    sched_param scheduling_param = {};
+#if defined(__linux__)
+    cpu_set_t cpu_affinity;
+    bool has_cpu_affinity = false;
+#endif
+};
+
+// Snapshots the calling thread's name, scheduling and cpu affinity.
+ThreadState capture_thread_state();
+
+// Restores a snapshot taken by capture_thread_state on the calling thread.
+// Best effort: anything that can't be restored is left as it is.
+void restore_thread_state(const ThreadState& state);
+
+} // namespace util
+} // namespace roboflex
+
+#endif // ROBOFLEX_THREAD_CONFIG__H
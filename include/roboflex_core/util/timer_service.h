@@ -0,0 +1,136 @@
+#ifndef ROBOFLEX_TIMER_SERVICE__H
+#define ROBOFLEX_TIMER_SERVICE__H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace roboflex {
+namespace util {
+
+/**
+ * A hierarchical timer wheel that fires callbacks, once or periodically,
+ * on a small pool of worker threads. Lets any number of periodic nodes
+ * share two or three threads, instead of each sleeping on its own.
+ *
+ * One thread advances the wheel in ticks (1ms by default); timers that
+ * expire are handed to the workers. It only wakes for ticks that have
+ * something to do - timers to expire, or a cascade of timers from a
+ * higher level - so a single 1 Hz timer wakes it about once a second,
+ * not a thousand times. The wheel has 4 levels of 64 slots, so inserting
+ * and expiring are O(1), and timers up to ~4.6 hours out (at 1ms ticks)
+ * need no more than 3 cascades; cancelling looks the timer up by id, in
+ * O(log n). Accuracy is one tick: use a FrequencyGenerator on its own
+ * thread when you need better than that.
+ *
+ * A periodic timer is rescheduled only once its callback returns, so a
+ * callback never overlaps with itself; periods that were missed while
+ * it ran are skipped. Callbacks should not block for long: they hold up
+ * a worker.
+ */
+class TimerService {
+public:
+    using TimerId = uint64_t;
+    using Callback = std::function<void()>;
+    using clock = std::chrono::steady_clock;
+
+    TimerService(
+        std::chrono::nanoseconds tick = std::chrono::milliseconds(1),
+        size_t num_workers = 2);
+    ~TimerService();
+
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+
+    // The process-wide instance, created on first use.
+    static TimerService& instance();
+
+    TimerId schedule_periodic(double period_seconds, Callback callback);
+    TimerId schedule_once(double delay_seconds, Callback callback);
+
+    // Changes the period of a periodic timer, from its next firing on.
+    void set_period(TimerId id, double period_seconds);
+
+    // After cancel returns, the callback is not running and will not
+    // run again - unless cancel is called from the callback itself, in
+    // which case the current invocation just finishes. Cancelling an
+    // unknown (or already cancelled) timer does nothing.
+    void cancel(TimerId id);
+
+    size_t num_timers() const;
+    size_t num_workers() const { return workers.size(); }
+    std::chrono::nanoseconds get_tick() const { return tick; }
+
+protected:
+
+    static constexpr int NumLevels = 4;
+    static constexpr int SlotBits = 6;
+    static constexpr uint64_t NumSlots = 1 << SlotBits;
+    static constexpr uint64_t SlotMask = NumSlots - 1;
+
+    struct Timer {
+        TimerId id;
+        Callback callback;
+        clock::time_point deadline;
+        clock::duration period;
+        uint64_t expiry_tick = 0;
+        bool cancelled = false;
+        bool running = false;
+        std::thread::id running_thread;
+    };
+    using TimerPtr = std::shared_ptr<Timer>;
+    using Slot = std::vector<TimerPtr>;
+
+    TimerId schedule(clock::duration delay, clock::duration period, Callback callback);
+
+    // all of these expect the mutex to be held
+    uint64_t tick_for(clock::time_point t) const;
+    uint64_t now_tick() const;
+    void catch_up_if_idle();
+    void insert(TimerPtr timer, uint64_t min_tick);
+    void cascade(int level);
+    void advance();
+
+    // The first tick after current_tick at which advance() has anything
+    // to do.
+    uint64_t next_busy_tick() const;
+
+    void wheel_thread_fn();
+    void worker_thread_fn();
+
+    const std::chrono::nanoseconds tick;
+    const clock::time_point epoch;
+
+    mutable std::mutex mutex;
+    std::condition_variable wheel_cv;
+    std::condition_variable dispatch_cv;
+    std::condition_variable finished_cv;
+
+    std::array<std::array<Slot, NumSlots>, NumLevels> wheel;
+    uint64_t current_tick = 0;
+    size_t num_in_wheel = 0;
+
+    // set when a timer is added from outside the wheel thread, which may
+    // be due before the wheel thread was going to wake
+    bool wheel_changed = false;
+
+    std::map<TimerId, TimerPtr> timers;
+    std::deque<TimerPtr> ready;
+    TimerId next_id = 1;
+    bool stopping = false;
+
+    std::thread wheel_thread;
+    std::vector<std::thread> workers;
+};
+
+} // namespace util
+} // namespace roboflex
+
+#endif // ROBOFLEX_TIMER_SERVICE__H
@@ -39,6 +39,17 @@ void sleep_until_next_interval(
     const std::chrono::time_point<std::chrono::steady_clock> & start_t,
     double interval);
 
+/**
+ * Sleeps the thread until the given absolute deadline. Where the os
+ * supports it (linux) this uses clock_nanosleep with TIMER_ABSTIME, so
+ * wake-up error does not accumulate across periodic sleeps. The last
+ * spin_tail of the wait is spent busy-waiting, which trades cpu for
+ * accuracy: a spin_tail of ~100us gets most systems to within a few us.
+ */
+void sleep_until_precise(
+    const std::chrono::time_point<std::chrono::steady_clock> & deadline,
+    std::chrono::nanoseconds spin_tail = std::chrono::nanoseconds(0));
+
 } // namespace roboflex::core
 
 #endif // ROBOFLEX_CORE_UTILS__H
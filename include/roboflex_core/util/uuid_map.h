@@ -0,0 +1,228 @@
+#ifndef ROBOFLEX_UUID_MAP__H
+#define ROBOFLEX_UUID_MAP__H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "roboflex_core/util/uuid.h"
+
+namespace roboflex {
+namespace util {
+
+/**
+ * Generates a version 4 (random) uuid, like sole::uuid4(), but without
+ * touching a shared std::random_device on every call: each thread seeds
+ * its own xoshiro256** generator once, then generating an id is a handful
+ * of shifts and multiplies - no syscalls, no locks.
+ *
+ * Not suitable for anything cryptographic; plenty for naming nodes.
+ */
+inline sole::uuid fast_uuid4()
+{
+    struct Generator {
+        uint64_t s[4];
+
+        static uint64_t splitmix64(uint64_t& x) {
+            uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        static uint64_t rotl(uint64_t x, int k) {
+            return (x << k) | (x >> (64 - k));
+        }
+
+        Generator() {
+            std::random_device rd;
+            uint64_t seed = (uint64_t(rd()) << 32) ^ uint64_t(rd());
+            seed ^= uint64_t(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+            seed ^= uint64_t(std::hash<std::thread::id>()(std::this_thread::get_id())) << 1;
+            for (auto& v: s) {
+                v = splitmix64(seed);
+            }
+        }
+
+        uint64_t next() {
+            uint64_t result = rotl(s[1] * 5, 7) * 9;
+            uint64_t t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+            return result;
+        }
+    };
+
+    thread_local Generator generator;
+
+    sole::uuid u;
+    u.ab = (generator.next() & 0xFFFFFFFFFFFF0FFFULL) | 0x0000000000004000ULL;
+    u.cd = (generator.next() & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;
+    return u;
+}
+
+/**
+ * A hash for uuids that mixes all 128 bits. std::hash<sole::uuid> just
+ * xors the halves, which is fine for random uuids but poor for anything
+ * with structure (such as uuid1, or the all-zero "no source" id).
+ */
+struct UuidHash {
+    size_t operator()(const sole::uuid& u) const {
+        uint64_t h = u.ab ^ (u.cd * 0x9E3779B97F4A7C15ULL);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return size_t(h);
+    }
+};
+
+/**
+ * A small open-addressing (linear probing) hash map keyed by uuid. Keys
+ * and values live in one contiguous array, so a lookup is a hash and
+ * usually a single cache line - compared to a std::map<string, V> keyed
+ * by uuid.str(), which allocates a string per lookup and then walks a
+ * tree of string comparisons.
+ *
+ * Not thread-safe. Pointers to values are invalidated by inserting.
+ */
+template <typename V>
+class UuidMap {
+public:
+
+    explicit UuidMap(size_t initial_capacity = 16) {
+        size_t capacity = 8;
+        while (capacity < initial_capacity) {
+            capacity *= 2;
+        }
+        slots.resize(capacity);
+    }
+
+    size_t size() const { return num_entries; }
+    bool empty() const { return num_entries == 0; }
+
+    // Returns a pointer to the value for the key, or nullptr.
+    V* find(const sole::uuid& key) {
+        size_t i = probe(key);
+        return slots[i].occupied ? &slots[i].value : nullptr;
+    }
+
+    const V* find(const sole::uuid& key) const {
+        size_t i = probe(key);
+        return slots[i].occupied ? &slots[i].value : nullptr;
+    }
+
+    bool contains(const sole::uuid& key) const {
+        return find(key) != nullptr;
+    }
+
+    // Returns the value for the key, inserting a default one if needed.
+    V& operator[](const sole::uuid& key) {
+        size_t i = probe(key);
+        if (!slots[i].occupied) {
+            if ((num_entries + 1) * 4 > slots.size() * 3) {
+                grow();
+                i = probe(key);
+            }
+            slots[i].key = key;
+            slots[i].value = V();
+            slots[i].occupied = true;
+            num_entries++;
+        }
+        return slots[i].value;
+    }
+
+    void insert_or_assign(const sole::uuid& key, V value) {
+        (*this)[key] = std::move(value);
+    }
+
+    bool erase(const sole::uuid& key) {
+        size_t i = probe(key);
+        if (!slots[i].occupied) {
+            return false;
+        }
+        // Backward-shift deletion: no tombstones, so probe
+        // sequences stay short no matter how much churn there is.
+        size_t mask = slots.size() - 1;
+        size_t j = i;
+        while (true) {
+            j = (j + 1) & mask;
+            if (!slots[j].occupied) {
+                break;
+            }
+            size_t home = UuidHash()(slots[j].key) & mask;
+            bool can_move = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+            if (can_move) {
+                slots[i] = std::move(slots[j]);
+                i = j;
+            }
+        }
+        slots[i].occupied = false;
+        slots[i].value = V();
+        num_entries--;
+        return true;
+    }
+
+    void clear() {
+        for (auto& slot: slots) {
+            slot.occupied = false;
+            slot.value = V();
+        }
+        num_entries = 0;
+    }
+
+    // Calls f(key, value) for every entry, in no particular order.
+    template <typename F>
+    void for_each(F&& f) const {
+        for (auto& slot: slots) {
+            if (slot.occupied) {
+                f(slot.key, slot.value);
+            }
+        }
+    }
+
+protected:
+
+    struct Slot {
+        sole::uuid key = {0, 0};
+        V value = V();
+        bool occupied = false;
+    };
+
+    // The slot holding the key, or the empty slot where it would go.
+    size_t probe(const sole::uuid& key) const {
+        size_t mask = slots.size() - 1;
+        size_t i = UuidHash()(key) & mask;
+        while (slots[i].occupied && !(slots[i].key == key)) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow() {
+        std::vector<Slot> old_slots(slots.size() * 2);
+        old_slots.swap(slots);
+        for (auto& slot: old_slots) {
+            if (slot.occupied) {
+                size_t i = probe(slot.key);
+                slots[i] = std::move(slot);
+            }
+        }
+    }
+
+    std::vector<Slot> slots;
+    size_t num_entries = 0;
+};
+
+} // namespace util
+} // namespace roboflex
+
+#endif // ROBOFLEX_UUID_MAP__H
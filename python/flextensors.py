@@ -1,6 +1,16 @@
 import time
 import numpy as np
 
+try:
+    import lz4.block as _lz4_block
+except ImportError:
+    _lz4_block = None
+
+try:
+    from ml_dtypes import bfloat16 as _bfloat16
+except ImportError:
+    _bfloat16 = None
+
 
 # --- utils ---
 
@@ -19,12 +29,19 @@ def _dicthasonlykeys(d, keys):
 #   shape: list of ints i.e. (3, 4)
 #   data: raw byte data
 #   dtype: int
+#   align: int (optional: the c++ side pads data to this alignment)
+#   encoding: int (optional: data is encoded - see "encodings" below)
+#   frame: int (optional: the tensor's frame number in its stream)
 # }
 # that can be serialized to and from a numpy tensor via flexbuffer
+_tensormap_keys = ["shape", "data", "dtype"]
+_tensormap_optional_keys = ["align", "encoding", "frame"]
+
 def _istensormap(v):
     return (
         isinstance(v, dict)
-        and _dicthaskeys(v, ["shape", "data", "dtype"])
+        and _dicthaskeys(v, _tensormap_keys + _tensormap_optional_keys)
+        and all([k in v for k in _tensormap_keys])
         and isinstance(v["shape"], list)
         and isinstance(v["data"], bytes)
         and isinstance(v["dtype"], int)
@@ -49,20 +66,128 @@ supported_numpy_types = [
     np.complex64,
     np.complex128,
     np.float16,
+    _bfloat16,  # None without ml_dtypes: such tensors decode as float32
 ]
 
+_BFLOAT16_DTYPE_CODE = 15
+
 def _encode_dtype(t):
     return supported_numpy_types.index(t)
 
 def _decode_dtype(i):
     return supported_numpy_types[i]
 
+def bfloat16_to_float32(buffer):
+    """bfloat16 is the top half of a float32."""
+    return (np.frombuffer(buffer, np.uint16).astype(np.uint32) << 16).view(np.float32)
+
+
+# --- encodings ---
+#
+# Same as flex_tensor_codec.h: a bitmask, applied in this order when
+# encoding, and in reverse when decoding.
+
+EncodingNone = 0
+EncodingFrameDelta = 1  # xor with the previous frame of the stream
+EncodingShuffle = 2     # group bytes of elements by significance
+EncodingLZ4 = 4         # lz4 block format
+
+
+def _lz4_decompress(data, decompressed_size):
+    if _lz4_block is not None:
+        return _lz4_block.decompress(data, uncompressed_size=decompressed_size)
+
+    # slow, but dependency-free
+    src = memoryview(data)
+    dst = bytearray()
+    ip = 0
+    n = len(src)
+
+    def read_length(length):
+        nonlocal ip
+        while True:
+            b = src[ip]
+            ip += 1
+            length += b
+            if b != 255:
+                return length
+
+    while True:
+        token = src[ip]
+        ip += 1
+        literal_length = token >> 4
+        if literal_length == 15:
+            literal_length = read_length(literal_length)
+        dst += src[ip:ip + literal_length]
+        ip += literal_length
+        if ip >= n:
+            break
+        offset = src[ip] | (src[ip + 1] << 8)
+        ip += 2
+        match_length = token & 15
+        if match_length == 15:
+            match_length = read_length(match_length)
+        match_length += 4
+        start = len(dst) - offset
+        if offset >= match_length:
+            dst += dst[start:start + match_length]
+        else:
+            for i in range(match_length):
+                dst.append(dst[start + i])
+
+    if len(dst) != decompressed_size:
+        raise ValueError(f"lz4: expected {decompressed_size} bytes, got {len(dst)}")
+    return bytes(dst)
+
+
+def _shuffle(data, itemsize):
+    n = len(data) // itemsize
+    whole = np.frombuffer(data, np.uint8, n * itemsize).reshape(n, itemsize)
+    return whole.T.tobytes() + data[n * itemsize:]
+
+
+def _unshuffle(data, itemsize):
+    n = len(data) // itemsize
+    whole = np.frombuffer(data, np.uint8, n * itemsize).reshape(itemsize, n)
+    return whole.T.tobytes() + data[n * itemsize:]
+
+
+def _xor(a, b):
+    return (np.frombuffer(a, np.uint8) ^ np.frombuffer(b, np.uint8)).tobytes()
+
+
+def encode_tensor_data(data: bytes, itemsize: int, encoding: int, previous: bytes = None):
+    if encoding & EncodingFrameDelta:
+        if previous is None:
+            raise ValueError("frame delta encoding needs the previous frame")
+        data = _xor(data, previous)
+    if encoding & EncodingShuffle:
+        data = _shuffle(data, itemsize)
+    if encoding & EncodingLZ4:
+        if _lz4_block is None:
+            raise ImportError("lz4 encoding needs the lz4 package")
+        data = _lz4_block.compress(data, store_size=False)
+    return data
+
+
+def decode_tensor_data(data: bytes, num_bytes: int, itemsize: int, encoding: int, previous: bytes = None):
+    if encoding & EncodingFrameDelta and previous is None:
+        raise ValueError("this tensor is frame-delta encoded: it can only be decoded "
+            "given the previous frame (or decode it with a TensorDecoder node)")
+    if encoding & EncodingLZ4:
+        data = _lz4_decompress(data, num_bytes)
+    if encoding & EncodingShuffle:
+        data = _unshuffle(data, itemsize)
+    if encoding & EncodingFrameDelta:
+        data = _xor(data, previous)
+    return data
+
 
 # --- serialize tensor ---
 
 def build_tensor(
     #fbb_builder: flexbuffers.Builder, np_tensor: np.ndarray, name: str = None
-    fbb_builder, np_tensor: np.ndarray, name: str = None
+    fbb_builder, np_tensor: np.ndarray, name: str = None, encoding: int = EncodingNone
 ):
 
     """Use during normal flexbuffer construction when you want to add a tensor.
@@ -72,24 +197,41 @@ def build_tensor(
         build_tensor(fbb, t, "sometensor")
         fbb.String("somestring", "check out FlexMessageCallback")
         ...
+
+    encoding may be any of the stateless encodings (EncodingShuffle,
+    EncodingLZ4); lz4 needs the lz4 package.
     """
     t = np_tensor
+    if encoding & EncodingFrameDelta:
+        raise ValueError("build_tensor does not support frame delta encoding")
     with fbb_builder.Map(name):
         fbb_builder.TypedVectorFromElements("shape", t.shape) #_shape_padded(t.shape))
-        fbb_builder.Blob("data", bytes(t.data)) # the expensive part
+        if encoding == EncodingNone:
+            fbb_builder.Blob("data", bytes(t.data)) # the expensive part
+        else:
+            data = np.ascontiguousarray(t).tobytes()
+            fbb_builder.Blob("data", encode_tensor_data(data, t.dtype.itemsize, encoding))
+            fbb_builder.Int("encoding", encoding)
         fbb_builder.Int("dtype", _encode_dtype(t.dtype))
 
 
 # --- numpify flex-deserialized maps ---
 
-def _numpy_tensor_from_tensor_map(m):
+def _numpy_tensor_from_tensor_map(m, previous: bytes = None):
     assert _istensormap(m)
     shape = m["shape"]
     if len(shape) == 0:
         return None
     dtype = _decode_dtype(m["dtype"])
     buffer = m["data"]
-    npv = np.frombuffer(buffer, dtype)
+    encoding = m.get("encoding", EncodingNone)
+    if encoding != EncodingNone:
+        itemsize = 2 if dtype is None else np.dtype(dtype).itemsize
+        buffer = decode_tensor_data(buffer, itemsize * int(np.prod(shape)), itemsize, encoding, previous)
+    if dtype is None and m["dtype"] == _BFLOAT16_DTYPE_CODE:
+        npv = bfloat16_to_float32(buffer)
+    else:
+        npv = np.frombuffer(buffer, dtype)
     r = npv.reshape(shape)
     return r
 
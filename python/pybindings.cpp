@@ -78,6 +78,63 @@ public:
         
         //.def_property_readonly("buffer", &XArrayRightBuf<T>::chop)
 
+#define REGISTER_WINDOW_STATISTICS(T, NodeName) \
+    py::class_<WindowStatistics<T>, Node, std::shared_ptr<WindowStatistics<T>>>(m, NodeName) \
+        .def(py::init<size_t, const std::string&, const std::string&>(), \
+             "Create a WindowStatistics node.", \
+             py::arg("window_size"), \
+             py::arg("tensor_key_in") = "t", \
+             py::arg("name") = NodeName) \
+        .def_property_readonly("window_size", &WindowStatistics<T>::get_window_size) \
+        .def_property_readonly("num_channels", &WindowStatistics<T>::get_num_channels) \
+        .def_property_readonly("num_samples", &WindowStatistics<T>::get_num_samples)
+
+#define REGISTER_RESAMPLER(T, NodeName) \
+    py::class_<Resampler<T>, Node, std::shared_ptr<Resampler<T>>>(m, NodeName) \
+        .def(py::init<size_t, size_t, size_t, double, double, const std::string&, const std::string&, const std::string&>(), \
+             "Create a Resampler node, which resamples the last dimension of tensors by up / down.", \
+             py::arg("up"), \
+             py::arg("down"), \
+             py::arg("half_width") = 10, \
+             py::arg("kaiser_beta") = 5.0, \
+             py::arg("input_sample_rate") = 0.0, \
+             py::arg("tensor_key_in") = "t", \
+             py::arg("tensor_key_out") = "t", \
+             py::arg("name") = NodeName) \
+        .def("reset", &Resampler<T>::reset) \
+        .def_property_readonly("up", &Resampler<T>::get_up) \
+        .def_property_readonly("down", &Resampler<T>::get_down) \
+        .def_property_readonly("filter", &Resampler<T>::get_filter) \
+        .def_property_readonly("input_sample_rate", &Resampler<T>::get_input_sample_rate)
+
+#define REGISTER_TENSOR_BATCHER(T, NodeName) \
+    py::class_<TensorBatcher<T>, Node, std::shared_ptr<TensorBatcher<T>>>(m, NodeName) \
+        .def(py::init<size_t, \
+                      const std::vector<size_t>&, \
+                      double, \
+                      bool, \
+                      T, \
+                      const std::string&, \
+                      const std::string&, \
+                      size_t, \
+                      const std::string&>(), \
+             "Create a TensorBatcher node.", \
+             py::arg("batch_size"), \
+             py::arg("shape"), \
+             py::arg("timeout") = 0.0, \
+             py::arg("pad") = false, \
+             py::arg("pad_value") = T(0), \
+             py::arg("tensor_key_in") = "t", \
+             py::arg("tensor_key_out") = "t", \
+             py::arg("pool_size") = 4, \
+             py::arg("name") = NodeName) \
+        .def_property_readonly("batch_size", &TensorBatcher<T>::get_batch_size) \
+        .def_property_readonly("shape", &TensorBatcher<T>::get_shape) \
+        .def_property_readonly("timeout", &TensorBatcher<T>::get_timeout) \
+        .def_property_readonly("num_batches", &TensorBatcher<T>::get_num_batches) \
+        .def_property_readonly("num_timed_out", &TensorBatcher<T>::get_num_timed_out) \
+        .def_property_readonly("num_pool_misses", &TensorBatcher<T>::get_num_pool_misses)
+
 
 PYBIND11_MODULE(roboflex_core_python_ext, m) 
 {
@@ -153,12 +210,25 @@ PYBIND11_MODULE(roboflex_core_python_ext, m)
         .def("walk_connections_forwards", &Node::walk_connections_forwards)
         .def("walk_connections_backwards", &Node::walk_connections_backwards)
         .def("filter_nodes", &Node::filter_nodes)
+        .def("snapshot_graph", &Node::snapshot_graph, py::call_guard<py::gil_scoped_release>())
+
+        .def("handle_rpc", &Node::handle_rpc, py::call_guard<py::gil_scoped_release>())
+        .def("register_rpc_handler", &Node::register_rpc_handler,
+            "Register what handle_rpc answers for rpc messages with the given module and message name.",
+            py::arg("module_name"),
+            py::arg("message_name"),
+            py::arg("handler"))
+        .def("has_rpc_handler", &Node::has_rpc_handler,
+            py::arg("module_name"),
+            py::arg("message_name"))
 
         .def("connect", (std::shared_ptr<Node> (Node::*) (std::shared_ptr<Node>)) &Node::connect, py::keep_alive<1, 2>(), py::call_guard<py::gil_scoped_release>())
         .def("disconnect", (void (Node::*) (std::shared_ptr<Node>)) &Node::disconnect, py::call_guard<py::gil_scoped_release>())
         .def("has_observers", &Node::has_observers)
         .def("num_observers", &Node::num_observers)
         .def("get_observers", &Node::get_observers)
+        .def("get_congestion", &Node::get_congestion)
+        .def("get_downstream_congestion", &Node::get_downstream_congestion, py::call_guard<py::gil_scoped_release>())
 
         .def("receive_from", static_cast<void (Node::*)(MessagePtr, const Node&)>(&Node::receive_from), py::call_guard<py::gil_scoped_release>())
         .def("receive", static_cast<void (Node::*)(MessagePtr)>(&Node::receive), py::call_guard<py::gil_scoped_release>())
@@ -201,6 +271,70 @@ PYBIND11_MODULE(roboflex_core_python_ext, m)
         }, py::keep_alive<1, 2>()) //, py::call_guard<py::gil_scoped_release>())
     ;
 
+    py::class_<GraphSnapshot::NodeInfo>(m, "GraphSnapshotNode")
+        .def_property_readonly("guid", [](const GraphSnapshot::NodeInfo& n){ return n.guid.str(); })
+        .def_readonly("name", &GraphSnapshot::NodeInfo::name)
+        .def_readonly("type", &GraphSnapshot::NodeInfo::type)
+        .def_readonly("runnable", &GraphSnapshot::NodeInfo::runnable)
+        .def_readonly("running", &GraphSnapshot::NodeInfo::running)
+        .def_readonly("thread_name", &GraphSnapshot::NodeInfo::thread_name)
+        .def_readonly("congestion", &GraphSnapshot::NodeInfo::congestion)
+    ;
+
+    py::class_<GraphSnapshot::EdgeInfo>(m, "GraphSnapshotEdge")
+        .def_property_readonly("parent_guid", [](const GraphSnapshot::EdgeInfo& e){ return e.parent_guid.str(); })
+        .def_property_readonly("child_guid", [](const GraphSnapshot::EdgeInfo& e){ return e.child_guid.str(); })
+        .def_readonly("messages", &GraphSnapshot::EdgeInfo::messages)
+        .def_readonly("bytes", &GraphSnapshot::EdgeInfo::bytes)
+        .def_readonly("last_time", &GraphSnapshot::EdgeInfo::last_time)
+    ;
+
+    py::class_<GraphSnapshot>(m, "GraphSnapshot")
+        .def_readonly("time", &GraphSnapshot::time)
+        .def_readonly("nodes", &GraphSnapshot::nodes)
+        .def_readonly("edges", &GraphSnapshot::edges)
+        .def("to_json", &GraphSnapshot::to_json)
+        .def("to_dot", &GraphSnapshot::to_dot)
+    ;
+
+    m.def("find_node", [](const std::string& guid) { return NodeRegistry::instance().find(sole::rebuild(guid)); },
+        "Finds any live node in the process by guid, or None.",
+        py::arg("guid"));
+    m.def("find_nodes_by_name", [](const std::string& name) { return NodeRegistry::instance().find_by_name(name); },
+        "Finds every live node in the process with the given name.",
+        py::arg("name"));
+    m.def("get_all_nodes", []() { return NodeRegistry::instance().get_nodes(); },
+        "Every live node in the process.");
+
+    py::enum_<util::SchedulingPolicy>(m, "SchedulingPolicy")
+        .value("DEFAULT", util::SchedulingPolicy::Default)
+        .value("FIFO", util::SchedulingPolicy::FIFO)
+        .value("ROUND_ROBIN", util::SchedulingPolicy::RoundRobin)
+    ;
+
+    py::class_<util::ThreadConfig>(m, "ThreadConfig")
+        .def(py::init([](
+                const std::vector<int>& cpu_affinity,
+                util::SchedulingPolicy scheduling_policy,
+                int priority,
+                const std::string& thread_name,
+                bool lock_memory) {
+            return util::ThreadConfig{cpu_affinity, scheduling_policy, priority, thread_name, lock_memory};
+        }),
+            "How a RunnableNode's thread should be set up.",
+            py::arg("cpu_affinity") = std::vector<int>(),
+            py::arg("scheduling_policy") = util::SchedulingPolicy::Default,
+            py::arg("priority") = 0,
+            py::arg("thread_name") = "",
+            py::arg("lock_memory") = false)
+        .def_readwrite("cpu_affinity", &util::ThreadConfig::cpu_affinity)
+        .def_readwrite("scheduling_policy", &util::ThreadConfig::scheduling_policy)
+        .def_readwrite("priority", &util::ThreadConfig::priority)
+        .def_readwrite("thread_name", &util::ThreadConfig::thread_name)
+        .def_readwrite("lock_memory", &util::ThreadConfig::lock_memory)
+        .def("__repr__", &util::ThreadConfig::to_string)
+    ;
+
     py::class_<RunnableNode, Node, PyRunnableNode<>, std::shared_ptr<RunnableNode>>(m, "RunnableNode", py::dynamic_attr())
         .def(py::init<const std::string&>(),
             "Everything is a node!",
@@ -210,6 +344,7 @@ PYBIND11_MODULE(roboflex_core_python_ext, m)
         .def("request_stop", &RunnableNode::request_stop, py::call_guard<py::gil_scoped_release>())
         .def("stop_requested", &RunnableNode::stop_requested)       
         .def("run", &RunnableNode::run, py::call_guard<py::gil_scoped_release>())
+        .def_property("thread_config", &RunnableNode::get_thread_config, &RunnableNode::set_thread_config)
     ;
 
 
@@ -254,6 +389,17 @@ PYBIND11_MODULE(roboflex_core_python_ext, m)
             py::arg("name") = "null")
     ;
 
+    py::enum_<BackpressurePolicy>(m, "BackpressurePolicy")
+        .value("NONE", BackpressurePolicy::None)
+        .value("SKIP", BackpressurePolicy::Skip)
+        .value("THROTTLE", BackpressurePolicy::Throttle)
+    ;
+
+    py::enum_<OverrunPolicy>(m, "OverrunPolicy")
+        .value("SKIP", OverrunPolicy::Skip)
+        .value("CATCH_UP", OverrunPolicy::CatchUp)
+    ;
+
     py::class_<FrequencyGenerator, RunnableNode, PyFrequencyGenerator<>, std::shared_ptr<FrequencyGenerator>>(m, "FrequencyGenerator")
         .def(py::init<const float, const std::string &>(),
             "Create a Frequency Generator node. Be sure to call start()!",
@@ -261,6 +407,18 @@ PYBIND11_MODULE(roboflex_core_python_ext, m)
             py::arg("name") = "FrequencyGenerator")
         .def("set_frequency", &FrequencyGenerator::set_frequency)
         .def("get_frequency", &FrequencyGenerator::get_frequency)
+        .def("set_backpressure", &FrequencyGenerator::set_backpressure,
+            py::arg("policy"),
+            py::arg("congestion_threshold") = 1.0)
+        .def_property_readonly("backpressure_policy", &FrequencyGenerator::get_backpressure_policy)
+        .def_property_readonly("congestion_threshold", &FrequencyGenerator::get_congestion_threshold)
+        .def_property_readonly("num_skipped_triggers", &FrequencyGenerator::get_num_skipped_triggers)
+        .def_property("overrun_policy", &FrequencyGenerator::get_overrun_policy, &FrequencyGenerator::set_overrun_policy)
+        .def_property("spin_tail", &FrequencyGenerator::get_spin_tail, &FrequencyGenerator::set_spin_tail)
+        .def_property_readonly("jitter", &FrequencyGenerator::get_jitter)
+        .def_property_readonly("num_missed_deadlines", &FrequencyGenerator::get_num_missed_deadlines)
+        .def("reset_timing_stats", &FrequencyGenerator::reset_timing_stats)
+        .def_property("use_timer_service", &FrequencyGenerator::get_use_timer_service, &FrequencyGenerator::set_use_timer_service)
     ;
 
     py::class_<MessagePrinter, Node, std::shared_ptr<MessagePrinter>>(m, "MessagePrinter")
@@ -306,6 +464,30 @@ PYBIND11_MODULE(roboflex_core_python_ext, m)
             py::arg("name") = "EveryN")
     ;
 
+    m.attr("EncodingNone") = serialization::EncodingNone;
+    m.attr("EncodingFrameDelta") = serialization::EncodingFrameDelta;
+    m.attr("EncodingShuffle") = serialization::EncodingShuffle;
+    m.attr("EncodingLZ4") = serialization::EncodingLZ4;
+
+    py::class_<TensorEncoder, Node, std::shared_ptr<TensorEncoder>>(m, "TensorEncoder")
+        .def(py::init<const std::vector<std::string>&, int, unsigned int, const std::string &>(),
+            "Create a TensorEncoder node, which encodes the tensors under the given keys with lossless codecs.",
+            py::arg("tensor_keys"),
+            py::arg("encoding") = serialization::EncodingShuffle | serialization::EncodingLZ4,
+            py::arg("keyframe_interval") = 30,
+            py::arg("name") = "TensorEncoder")
+        .def_property_readonly("tensor_keys", &TensorEncoder::get_tensor_keys)
+        .def_property_readonly("encoding", &TensorEncoder::get_encoding)
+        .def_property_readonly("keyframe_interval", &TensorEncoder::get_keyframe_interval)
+    ;
+
+    py::class_<TensorDecoder, Node, std::shared_ptr<TensorDecoder>>(m, "TensorDecoder")
+        .def(py::init<const std::string &>(),
+            "Create a TensorDecoder node, which decodes all encoded tensors in messages.",
+            py::arg("name") = "TensorDecoder")
+        .def_property_readonly("num_dropped", &TensorDecoder::get_num_dropped)
+    ;
+
     py::class_<LastOne, Node, std::shared_ptr<LastOne>>(m, "LastOne")
         .def(py::init<const std::string &>(),
             "Create a node that just remembers the last message, in a thread-safe way.",
@@ -313,6 +495,16 @@ PYBIND11_MODULE(roboflex_core_python_ext, m)
         .def_property_readonly("last_message", &LastOne::get_last_message)
     ;
 
+    py::class_<LastOneByName, Node, std::shared_ptr<LastOneByName>>(m, "LastOneByName")
+        .def(py::init<const std::string &>(),
+            "Create a node that remembers the last message of each message_name, in a thread-safe way.",
+            py::arg("name") = "LastOneByName")
+        .def("get_last_message", &LastOneByName::get_last_message,
+            "The last message with the given message_name, or None.",
+            py::arg("message_name"))
+        .def_property_readonly("message_names", &LastOneByName::get_message_names)
+    ;
+
     REGISTER_TENSOR_RIGHT_BUFFER(int8_t, "XArrayRightBufInt8", "TensorRightBufferInt8");
     REGISTER_TENSOR_RIGHT_BUFFER(int16_t, "XArrayRightBufInt16", "TensorRightBufferInt16");
     REGISTER_TENSOR_RIGHT_BUFFER(int32_t, "XArrayRightBufInt32", "TensorRightBufferInt32");
@@ -325,6 +517,36 @@ PYBIND11_MODULE(roboflex_core_python_ext, m)
     REGISTER_TENSOR_RIGHT_BUFFER(double, "XArrayRightBufDouble", "TensorRightBufferDouble");
     REGISTER_TENSOR_RIGHT_BUFFER(xtl::half_float, "XArrayRightBufFloat16", "TensorRightBufferFloat16");
 
+    REGISTER_TENSOR_BATCHER(int8_t, "TensorBatcherInt8");
+    REGISTER_TENSOR_BATCHER(int16_t, "TensorBatcherInt16");
+    REGISTER_TENSOR_BATCHER(int32_t, "TensorBatcherInt32");
+    REGISTER_TENSOR_BATCHER(int64_t, "TensorBatcherInt64");
+    REGISTER_TENSOR_BATCHER(uint8_t, "TensorBatcherUInt8");
+    REGISTER_TENSOR_BATCHER(uint16_t, "TensorBatcherUInt16");
+    REGISTER_TENSOR_BATCHER(uint32_t, "TensorBatcherUInt32");
+    REGISTER_TENSOR_BATCHER(uint64_t, "TensorBatcherUInt64");
+    REGISTER_TENSOR_BATCHER(float, "TensorBatcherFloat");
+    REGISTER_TENSOR_BATCHER(double, "TensorBatcherDouble");
+
+    REGISTER_WINDOW_STATISTICS(int16_t, "WindowStatisticsInt16");
+    REGISTER_WINDOW_STATISTICS(int32_t, "WindowStatisticsInt32");
+    REGISTER_WINDOW_STATISTICS(uint8_t, "WindowStatisticsUInt8");
+    REGISTER_WINDOW_STATISTICS(uint16_t, "WindowStatisticsUInt16");
+    REGISTER_WINDOW_STATISTICS(float, "WindowStatisticsFloat");
+    REGISTER_WINDOW_STATISTICS(double, "WindowStatisticsDouble");
+
+    REGISTER_RESAMPLER(float, "ResamplerFloat");
+    REGISTER_RESAMPLER(double, "ResamplerDouble");
+
+    py::class_<WindowStatisticsMessage, Message, std::shared_ptr<WindowStatisticsMessage>>(m, "WindowStatisticsMessage")
+        .def(py::init<Message&>())
+        .def_property_readonly("mean", [](const WindowStatisticsMessage& m) { return xt::xtensor<double, 1>(m.mean()); })
+        .def_property_readonly("variance", [](const WindowStatisticsMessage& m) { return xt::xtensor<double, 1>(m.variance()); })
+        .def_property_readonly("min", [](const WindowStatisticsMessage& m) { return xt::xtensor<double, 1>(m.min()); })
+        .def_property_readonly("max", [](const WindowStatisticsMessage& m) { return xt::xtensor<double, 1>(m.max()); })
+        .def_property_readonly("count", &WindowStatisticsMessage::count)
+    ;
+
 
     // ---------- FRP-style helper functions -----------
 
@@ -344,12 +566,79 @@ PYBIND11_MODULE(roboflex_core_python_ext, m)
         py::arg("timeout_milliseconds")=0);
 
     py::class_<Producer, RunnableNode, PyProducer<>, std::shared_ptr<Producer>>(m, "Producer")
-        .def(py::init<int, const std::string &>(),
+        .def(py::init<int, const std::string &, int>(),
             "Create a Producer node. Be sure to call start()!",
             py::arg("timeout_milliseconds") = 1000,
-            py::arg("name") = "Producer")
+            py::arg("name") = "Producer",
+            py::arg("spin_microseconds") = 0)
         .def_property_readonly("timeout_milliseconds", &Producer::get_timeout_milliseconds)
+        .def_property_readonly("spin_microseconds", &Producer::get_spin_microseconds)
         .def_property_readonly("latest_message", &Producer::get_latest_message)
+        .def_property_readonly("num_dropped_messages", &Producer::get_num_dropped_messages)
+    ;
+
+    py::enum_<TimestampMerge::Clock>(m, "MergeClock")
+        .value("EventTime", TimestampMerge::Clock::EventTime)
+        .value("WallClock", TimestampMerge::Clock::WallClock)
+    ;
+
+    py::class_<TimestampMerge, RunnableNode, std::shared_ptr<TimestampMerge>>(m, "TimestampMerge")
+        .def(py::init<double, size_t, TimestampMerge::Clock, const std::string &>(),
+            "Create a TimestampMerge node, which merges several inputs into one stream in timestamp order. Be sure to call start()!",
+            py::arg("lateness_window") = 0.05,
+            py::arg("queue_capacity") = 256,
+            py::arg("clock") = TimestampMerge::Clock::EventTime,
+            py::arg("name") = "TimestampMerge")
+        .def("add_input", &TimestampMerge::add_input,
+            py::arg("name") = "")
+        .def("get_input", &TimestampMerge::get_input,
+            py::arg("index"))
+        .def_property_readonly("num_inputs", &TimestampMerge::get_num_inputs)
+        .def_property_readonly("lateness_window", &TimestampMerge::get_lateness_window)
+        .def_property_readonly("clock", &TimestampMerge::get_clock)
+        .def_property_readonly("num_signalled", &TimestampMerge::get_num_signalled)
+        .def_property_readonly("num_late", &TimestampMerge::get_num_late)
+        .def_property_readonly("num_overflowed", &TimestampMerge::get_num_overflowed)
+    ;
+
+    py::class_<SynchronizedMessage, Message, std::shared_ptr<SynchronizedMessage>>(m, "SynchronizedMessage")
+        .def(py::init<Message&>())
+        .def_property_readonly("names", &SynchronizedMessage::get_names)
+        .def("__len__", &SynchronizedMessage::get_num_messages)
+        .def_property_readonly("has_embedded_messages", &SynchronizedMessage::has_embedded_messages)
+        .def("get_message", (MessagePtr (SynchronizedMessage::*)(size_t) const) &SynchronizedMessage::get_message,
+            py::arg("index"))
+        .def("get_message", (MessagePtr (SynchronizedMessage::*)(const std::string&) const) &SynchronizedMessage::get_message,
+            py::arg("name"))
+    ;
+
+    py::enum_<TimeSynchronizer::Policy>(m, "SyncPolicy")
+        .value("Exact", TimeSynchronizer::Policy::Exact)
+        .value("ApproximateTime", TimeSynchronizer::Policy::ApproximateTime)
+    ;
+
+    py::class_<TimeSynchronizer, Node, std::shared_ptr<TimeSynchronizer>>(m, "TimeSynchronizer")
+        .def(py::init<TimeSynchronizer::Policy, double, size_t, const std::string &>(),
+            "Create a TimeSynchronizer node, which matches up messages from several inputs by timestamp.",
+            py::arg("policy") = TimeSynchronizer::Policy::ApproximateTime,
+            py::arg("slop") = 0.01,
+            py::arg("buffer_capacity") = 32,
+            py::arg("name") = "TimeSynchronizer")
+        .def("add_input", &TimeSynchronizer::add_input,
+            py::arg("name") = "")
+        .def("get_input", &TimeSynchronizer::get_input,
+            py::arg("index"))
+        .def("set_callback", &TimeSynchronizer::set_callback,
+            py::arg("callback"))
+        .def_property("embed_messages", &TimeSynchronizer::get_embed_messages, &TimeSynchronizer::set_embed_messages,
+            "Whether to copy each matched message into the SynchronizedMessage, so it can be sent through a transport.")
+        .def_property_readonly("num_inputs", &TimeSynchronizer::get_num_inputs)
+        .def_property_readonly("input_names", &TimeSynchronizer::get_input_names)
+        .def_property_readonly("policy", &TimeSynchronizer::get_policy)
+        .def_property_readonly("slop", &TimeSynchronizer::get_slop)
+        .def_property_readonly("buffer_capacity", &TimeSynchronizer::get_buffer_capacity)
+        .def_property_readonly("num_matched", &TimeSynchronizer::get_num_matched)
+        .def_property_readonly("num_dropped", &TimeSynchronizer::get_num_dropped)
     ;
 
 
@@ -360,6 +649,7 @@ PYBIND11_MODULE(roboflex_core_python_ext, m)
 
         .def("record_value", &MetricTracker::record_value)
         .def("reset", &MetricTracker::reset)
+        .def("enable_histogram", &MetricTracker::enable_histogram)
         .def("pretty_print", &MetricTracker::pretty_print)
 
         .def_readonly("count", &MetricTracker::count)
@@ -368,6 +658,7 @@ PYBIND11_MODULE(roboflex_core_python_ext, m)
         .def_property_readonly("variance", &MetricTracker::variance_value)
         .def_readonly("max", &MetricTracker::max_value)
         .def_readonly("min", &MetricTracker::min_value)
+        .def_readonly("bucket_counts", &MetricTracker::bucket_counts)
 
         .def("to_string", &MetricTracker::to_string)
         .def("to_pretty_string", &MetricTracker::to_pretty_string)
@@ -394,7 +685,14 @@ PYBIND11_MODULE(roboflex_core_python_ext, m)
             "Create a metrics publisher node",
             py::arg("name") = "MetricsPublisherNode")
         .def("publish_and_reset", &MetricsPublisherNode::publish_and_reset)
-        .def("record_metrics", &MetricsPublisherNode::record_metrics)
+        .def("record_metrics", &MetricsPublisherNode::record_metrics,
+            py::arg("receive_time"),
+            py::arg("bytes"),
+            py::arg("time_since_last_receive"),
+            py::arg("latency"),
+            py::arg("num_missed_messages"),
+            py::arg("num_reordered_messages") = 0,
+            py::arg("num_duplicate_messages") = 0)
     ;
 
     py::class_<MetricsNode, Node, std::shared_ptr<MetricsNode>>(m, "MetricsNode")
@@ -411,6 +709,67 @@ PYBIND11_MODULE(roboflex_core_python_ext, m)
         .def("reset", &MetricsNode::reset)
         .def_readonly("publisher_node", &MetricsNode::publisher_node)
         .def_readonly("passive_frequency_hz", &MetricsNode::passive_frequency_hz)
+        .def("start_passive_publishing_timer", &MetricsNode::start_passive_publishing_timer)
+        .def("stop_passive_publishing_timer", &MetricsNode::stop_passive_publishing_timer,
+            py::call_guard<py::gil_scoped_release>())
+    ;
+
+    py::class_<MetricsExporter, RunnableNode, std::shared_ptr<MetricsExporter>>(m, "MetricsExporter")
+        .def(py::init<int, const std::string &, const std::string &>(),
+            "Create a MetricsExporter node, which serves the metrics it receives in OpenMetrics text format, at http://address:port/metrics. Be sure to call start()!",
+            py::arg("port") = 9464,
+            py::arg("address") = "127.0.0.1",
+            py::arg("name") = "MetricsExporter")
+        .def("render", &MetricsExporter::render)
+        .def_property_readonly("port", &MetricsExporter::get_port)
+        .def_property_readonly("address", &MetricsExporter::get_address)
+        .def_property_readonly("num_edges", &MetricsExporter::get_num_edges)
+        .def_property_readonly("num_scrapes", &MetricsExporter::get_num_scrapes)
+    ;
+
+    py::class_<RemoteCallMessage, Message, std::shared_ptr<RemoteCallMessage>>(m, "RemoteCallMessage")
+        .def(py::init<Message&>())
+        .def(py::init([](const std::string& target, MessagePtr call, uint64_t call_id) {
+                return std::make_shared<RemoteCallMessage>(sole::rebuild(target), call, call_id);
+            }),
+            "A request for an RpcRouter to make the rpc call on the node with guid target.",
+            py::arg("target"),
+            py::arg("call"),
+            py::arg("call_id") = 0)
+        .def_property_readonly("target", [](const RemoteCallMessage& m){ return m.target().str(); })
+        .def_property_readonly("call_id", &RemoteCallMessage::call_id)
+        .def_property_readonly("call", &RemoteCallMessage::call)
+    ;
+
+    py::class_<RemoteCallResultMessage, Message, std::shared_ptr<RemoteCallResultMessage>>(m, "RemoteCallResultMessage")
+        .def(py::init<Message&>())
+        .def_property_readonly("target", [](const RemoteCallResultMessage& m){ return m.target().str(); })
+        .def_property_readonly("call_id", &RemoteCallResultMessage::call_id)
+        .def_property_readonly("handled", &RemoteCallResultMessage::handled)
+        .def_property_readonly("error", &RemoteCallResultMessage::error)
+        .def_property_readonly("result", &RemoteCallResultMessage::result)
+    ;
+
+    py::class_<RpcRouter, Node, std::shared_ptr<RpcRouter>>(m, "RpcRouter")
+        .def(py::init<const std::string &>(),
+            "Create an RpcRouter node, which routes rpc calls (and RemoteCallMessages) to the nodes it knows, by guid.",
+            py::arg("name") = "RpcRouter")
+        .def("add_node", &RpcRouter::add_node,
+            py::arg("node"))
+        .def("add_graph", &RpcRouter::add_graph,
+            py::arg("root"))
+        .def("remove_node", [](RpcRouter& r, const std::string& guid){ return r.remove_node(sole::rebuild(guid)); },
+            py::arg("guid"))
+        .def("find_node", [](const RpcRouter& r, const std::string& guid){ return r.find_node(sole::rebuild(guid)); },
+            py::arg("guid"))
+        .def("call", [](const RpcRouter& r, const std::string& guid, MessagePtr rpc_message){ return r.call(sole::rebuild(guid), rpc_message); },
+            "Make the rpc call on the node with the given guid; None if it is unknown, or answers nothing.",
+            py::arg("guid"),
+            py::arg("rpc_message"),
+            py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("num_nodes", &RpcRouter::get_num_nodes)
+        .def_property_readonly("num_calls", &RpcRouter::get_num_calls)
+        .def_property_readonly("num_unhandled", &RpcRouter::get_num_unhandled)
     ;
 
 
@@ -492,11 +851,39 @@ PYBIND11_MODULE(roboflex_core_python_ext, m)
             py::arg("node_to_run") = nullptr,
             py::call_guard<py::gil_scoped_release>())
         .def_property_readonly("metrics_instrumented", &GraphRoot::is_metrics_instrumented)
+        .def("set_node_thread_config", &GraphRoot::set_node_thread_config,
+            "Set the thread config to apply to the RunnableNode with this name when it is started.",
+            py::arg("node_name"),
+            py::arg("config"))
+        .def("set_default_thread_config", &GraphRoot::set_default_thread_config,
+            "Set the thread config to apply to all other RunnableNodes when they are started.",
+            py::arg("config"))
     ;
 
 
     // ------------ utilities ------------
 
+    py::class_<util::TimerService, std::unique_ptr<util::TimerService, py::nodelete>>(m, "TimerService")
+        .def_static("instance", &util::TimerService::instance, py::return_value_policy::reference,
+            "The process-wide timer service.")
+        .def("schedule_periodic", &util::TimerService::schedule_periodic,
+            "Call callback every period_seconds, on a timer service thread. Returns a timer id.",
+            py::arg("period_seconds"),
+            py::arg("callback"))
+        .def("schedule_once", &util::TimerService::schedule_once,
+            "Call callback once, after delay_seconds, on a timer service thread. Returns a timer id.",
+            py::arg("delay_seconds"),
+            py::arg("callback"))
+        .def("set_period", &util::TimerService::set_period,
+            py::arg("timer_id"),
+            py::arg("period_seconds"))
+        .def("cancel", &util::TimerService::cancel,
+            py::arg("timer_id"),
+            py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("num_timers", &util::TimerService::num_timers)
+        .def_property_readonly("num_workers", &util::TimerService::num_workers)
+    ;
+
     m.def("get_current_time", &get_current_time, "Gets the current time the same way that everything else in roboflex does.");
     m.def("get_roboflex_core_version", &get_roboflex_core_version, "Gets the current roboflex version.");
     //m.def("initialize_module_loading", &pybind11::detail::initialize_module_loading, "Initializes module loading. Must be called from the main thread.");
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <thread>
 #include <chrono>
 #include "roboflex_core/core_messages/core_messages.h"
@@ -11,60 +12,206 @@ FrequencyGenerator::FrequencyGenerator(
     const std::string &name):
         RunnableNode(name),
         frequency_hz(frequency_hz),
-        invocation_count(0)
+        invocation_count(0),
+        nominal_frequency_hz(frequency_hz)
 {
     assert(frequency_hz != 0);
 }
 
+const Node::RpcTable& FrequencyGenerator::class_rpc_table()
+{
+    static const RpcTable table = [] {
+        RpcTable t = RunnableNode::class_rpc_table();
+        t.add_for<FrequencyGenerator>(CoreModuleName, GetFrequency, [](FrequencyGenerator& node, MessagePtr) {
+            return make_shared<FloatMessage>(GotFrequency, node.get_frequency());
+        });
+        t.add_for<FrequencyGenerator>(CoreModuleName, SetFrequency, [](FrequencyGenerator& node, MessagePtr m) {
+            node.set_frequency(FloatMessage(*m).value());
+            return make_shared<BlankMessage>(OKMessageName);
+        });
+        return t;
+    }();
+    return table;
+}
+
+FrequencyGenerator::~FrequencyGenerator()
+{
+    // RunnableNode's destructor can't reach our stop_and_join.
+    this->stop();
+}
+
+void FrequencyGenerator::start()
+{
+    if (!use_timer_service) {
+        RunnableNode::start();
+        return;
+    }
+
+    if (timer_id == 0 && my_thread == nullptr) {
+        this->stop_signal = false;
+        timer_frequency_hz = frequency_hz;
+        if (timer_frequency_hz <= 0) {
+            throw std::runtime_error("FrequencyGenerator \"" + get_name() + "\" cannot use the timer service without a positive frequency");
+        }
+        timer_id = util::TimerService::instance().schedule_periodic(1.0 / timer_frequency_hz, [this]{ on_timer(); });
+    }
+}
+
+void FrequencyGenerator::stop_and_join()
+{
+    if (timer_id != 0) {
+        this->request_stop();
+        util::TimerService::instance().cancel(timer_id);
+        timer_id = 0;
+    }
+    RunnableNode::stop_and_join();
+}
+
+void FrequencyGenerator::on_timer()
+{
+    // The frequency_hz can change out from under us at any time.
+    float current_frequency = frequency_hz;
+    if (current_frequency != timer_frequency_hz && current_frequency > 0) {
+        timer_frequency_hz = current_frequency;
+        util::TimerService::instance().set_period(timer_id, 1.0 / current_frequency);
+        invocation_count = 0;
+    }
+
+    if (this->apply_backpressure()) {
+        return;
+    }
+
+    this->on_trigger(get_current_time());
+
+    invocation_count += 1;
+}
+
 void FrequencyGenerator::set_frequency(float new_frequency_hz)
 {
     frequency_hz = new_frequency_hz;
+    nominal_frequency_hz = new_frequency_hz;
     assert(frequency_hz != 0);
 }
 
-MessagePtr FrequencyGenerator::handle_rpc(MessagePtr rpc_message)
+void FrequencyGenerator::set_backpressure(BackpressurePolicy policy, float congestion_threshold)
+{
+    this->backpressure_policy = policy;
+    this->congestion_threshold = congestion_threshold;
+    if (policy != BackpressurePolicy::Throttle) {
+        frequency_hz = nominal_frequency_hz.load();
+    }
+}
+
+bool FrequencyGenerator::apply_backpressure()
 {
-    if (rpc_message->module_name() == CoreModuleName) {
+    BackpressurePolicy policy = backpressure_policy;
+    if (policy == BackpressurePolicy::None) {
+        return false;
+    }
 
-        const auto message_name = rpc_message->message_name();
+    float congestion = get_downstream_congestion();
+    bool congested = congestion >= congestion_threshold;
+    if (congested) {
+        on_backpressure(congestion);
+    }
 
-        if (message_name == GetFrequency) {
-            return make_shared<FloatMessage>(GotFrequency, frequency_hz);
+    if (policy == BackpressurePolicy::Skip) {
+        if (congested) {
+            num_skipped_triggers += 1;
         }
-        else if (message_name == SetFrequency) {
-            this->set_frequency(FloatMessage(*rpc_message).value());
-            return make_shared<BlankMessage>(OKMessageName);
+        return congested;
+    }
+
+    // Throttle: back off quickly, recover slowly.
+    float nominal = nominal_frequency_hz;
+    float current = frequency_hz;
+    if (nominal > 0) {
+        if (congested) {
+            frequency_hz = std::max(current * 0.5f, nominal / 16.0f);
+        } else if (current < nominal) {
+            frequency_hz = std::min(current * 1.25f, nominal);
         }
     }
+    return false;
+}
 
-    // let (force?) superclass to handle it
-    return RunnableNode::handle_rpc(rpc_message);
+void FrequencyGenerator::set_spin_tail(double spin_tail_seconds)
+{
+    spin_tail_ns = int64_t(spin_tail_seconds * 1.0e9);
+}
+
+MetricTracker FrequencyGenerator::get_jitter() const
+{
+    const std::lock_guard<std::mutex> lock(jitter_mutex);
+    return jitter;
+}
+
+void FrequencyGenerator::reset_timing_stats()
+{
+    const std::lock_guard<std::mutex> lock(jitter_mutex);
+    jitter.reset();
+    num_missed_deadlines = 0;
 }
 
 void FrequencyGenerator::child_thread_fn()
 {
+    using clock = std::chrono::steady_clock;
+
     float prev_frequency = frequency_hz;
 
-    auto start_t = std::chrono::steady_clock::now();
+    auto start_t = clock::now();
+    auto period = clock::duration(0);
+    if (prev_frequency > 0) {
+        period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / prev_frequency));
+    }
+    auto deadline = start_t + period;
 
     while (!this->stop_requested()) {
 
         // The frequency_hz can change out from under us at any time.
         // So, if we find that the frequency_hz HAS changed, then
-        // reset the start time and invocation count, so we operate correctly.
+        // reset the schedule and invocation count, so we operate correctly.
         float current_frequency = frequency_hz;
         if (current_frequency != prev_frequency) {
-            start_t = std::chrono::steady_clock::now();
+            start_t = clock::now();
             invocation_count = 0;
             prev_frequency = current_frequency;
+            if (current_frequency > 0) {
+                period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / current_frequency));
+                deadline = start_t + period;
+            }
         }
 
-        if (frequency_hz > 0) {
-            sleep_until_next_interval(start_t, 1.0 / this->frequency_hz);
+        if (current_frequency > 0) {
+            sleep_until_precise(deadline, std::chrono::nanoseconds(spin_tail_ns.load()));
+
+            auto lateness = clock::now() - deadline;
+            {
+                const std::lock_guard<std::mutex> lock(jitter_mutex);
+                jitter.record_value(std::chrono::duration<double>(lateness).count());
+            }
+
+            // If we woke up a whole period (or more) late, then we've
+            // missed deadlines. Either drop them, or fire them late.
+            auto num_periods_late = lateness / period;
+            if (num_periods_late > 0) {
+                if (overrun_policy == OverrunPolicy::Skip) {
+                    num_missed_deadlines += num_periods_late;
+                    deadline += num_periods_late * period;
+                } else {
+                    num_missed_deadlines += 1;
+                }
+            }
+            deadline += period;
         }
 
         // ------------------------------
-        // do whatever we actually want to do.
+        // do whatever we actually want to do,
+        // unless downstream can't take it.
+
+        if (this->apply_backpressure()) {
+            continue;
+        }
 
         this->on_trigger(get_current_time());
 
@@ -80,7 +227,9 @@ void FrequencyGenerator::on_trigger(double /*wall_clock_time*/)
 
 std::string FrequencyGenerator::to_string() const
 {
-    return "<FrequencyGenerator hz=" + std::to_string(frequency_hz) + " " + RunnableNode::to_string() + ">";
+    return "<FrequencyGenerator hz=" + std::to_string(frequency_hz) +
+        " missed_deadlines=" + std::to_string(num_missed_deadlines) +
+        " " + RunnableNode::to_string() + ">";
 }
 
 } // namespace nodes
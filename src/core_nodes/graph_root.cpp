@@ -38,17 +38,19 @@ void GraphRoot::start_all(RunnableNodePtr node_to_run)
 {
     this->_node_to_run = node_to_run;
 
-    this->walk_nodes_backwards([node_to_run, debug=debug](NodePtr node, int){
+    this->walk_nodes_backwards([this, node_to_run, debug=debug](NodePtr node, int){
         auto rn = std::dynamic_pointer_cast<RunnableNode>(node);
         if (rn && rn != node_to_run) {
             if (debug) {
                 std::cerr << "GraphRoot starting " << rn->get_name() << "\n";
             }
+            apply_thread_config_to(rn);
             rn->start();
         }
     });
 
     if (node_to_run) {
+        apply_thread_config_to(node_to_run);
         if (debug) {
             std::cerr << "GraphRoot running " << node_to_run->get_name() << "\n";
         }
@@ -56,6 +58,16 @@ void GraphRoot::start_all(RunnableNodePtr node_to_run)
     }
 }
 
+void GraphRoot::apply_thread_config_to(RunnableNodePtr rn) const
+{
+    auto it = thread_configs.find(rn->get_name());
+    if (it != thread_configs.end()) {
+        rn->set_thread_config(it->second);
+    } else if (default_thread_config) {
+        rn->set_thread_config(*default_thread_config);
+    }
+}
+
 void GraphRoot::profile(RunnableNodePtr node_to_run) 
 {
     instrument_metrics();
@@ -127,6 +139,7 @@ void GraphRoot::instrument_metrics()
     if (metrics_publishing_frequency_hz > 0) {
         this->metrics_trigger = std::make_shared<FrequencyGenerator>(
             metrics_publishing_frequency_hz, "MetricsPublishingTrigger");
+        this->metrics_trigger->set_use_timer_service(true);
     }
 
     // Create an aggregator node to receive all results
@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <thread>
 #include <chrono>
 #include <limits>
+#include <bit>
 #include <iomanip>
 #include "flatbuffers/flexbuffers.h"
 #include "roboflex_core/core_messages/core_messages.h"
@@ -115,6 +117,11 @@ void MetricTracker::record_value(double value)
 
     min_value = std::min(min_value, value);
     max_value = std::max(max_value, value);
+
+    if (!bucket_counts.empty()) {
+        auto bucket = std::lower_bound(HistogramBounds.begin(), HistogramBounds.end(), value) - HistogramBounds.begin();
+        bucket_counts[bucket] += 1;
+    }
 }
 
 void MetricTracker::reset()
@@ -125,6 +132,56 @@ void MetricTracker::reset()
     m2_value = 0;
     max_value = std::numeric_limits<double>::min();
     min_value = std::numeric_limits<double>::max();
+    std::fill(bucket_counts.begin(), bucket_counts.end(), 0);
+}
+
+
+// -- SequenceTracker --
+
+SequenceTracker::Update SequenceTracker::record(uint64_t counter)
+{
+    Update update;
+
+    if (!started) {
+        // whatever came before isn't ours to count
+        started = true;
+        highest = counter;
+        received = ~uint64_t(0);
+        return update;
+    }
+
+    if (counter > highest) {
+        uint64_t shift = counter - highest;
+        if (shift >= WindowSize) {
+            // the whole window leaves, and so do the oldest of the skipped
+            update.lost = (WindowSize - std::popcount(received)) + (shift - WindowSize);
+            received = 1;
+        } else {
+            uint64_t leaving = received >> (WindowSize - shift);
+            update.lost = shift - std::popcount(leaving);
+            received = (received << shift) | 1;
+        }
+        highest = counter;
+    } else {
+        uint64_t age = highest - counter;
+        if (age >= WindowSize) {
+            update.restarted = true;
+            highest = counter;
+            received = ~uint64_t(0);
+        } else if (received & (uint64_t(1) << age)) {
+            update.duplicates = 1;
+        } else {
+            received |= uint64_t(1) << age;
+            update.reordered = 1;
+        }
+    }
+
+    return update;
+}
+
+uint64_t SequenceTracker::num_missing() const
+{
+    return started ? WindowSize - std::popcount(received) : 0;
 }
 
 
@@ -135,6 +192,7 @@ MetricsMessage::MetricsMessage(Message& other):
 {
     // just deserialize the whole map now....
     auto root = root_map();
+    fields = Schema(root);
     //elapsed_time = root["elapsed_time"].AsDouble();
     //current_mem_usage = root["current_mem_usage"].AsUInt64();
     auto keys = root.Keys();
@@ -151,6 +209,13 @@ MetricsMessage::MetricsMessage(Message& other):
                     submap["max"].AsDouble(),
                     submap["min"].AsDouble()
                 );
+                if (submap["buckets"].IsTypedVector()) {
+                    auto buckets = submap["buckets"].AsTypedVector();
+                    auto& bucket_counts = metrics[name].bucket_counts;
+                    for (size_t j = 0; j < buckets.size(); j++) {
+                        bucket_counts.push_back(buckets[j].AsUInt64());
+                    }
+                }
             }
         }
     }
@@ -170,15 +235,15 @@ MetricsMessage::MetricsMessage(
     flexbuffers::Builder fbb = get_builder();
     WriteMapRoot(fbb, [&]() {
 
-        fbb.String("host_name", host_name);
-        fbb.String("parent_node_name", parent_node_name);
-        fbb.String("child_node_name", child_node_name);
+        Schema::write<"host_name">(fbb, host_name);
+        Schema::write<"parent_node_name">(fbb, parent_node_name);
+        Schema::write<"child_node_name">(fbb, child_node_name);
 
-        serialization::serialize_uuid(parent_node_guid, "parent_node_guid", fbb);
-        serialization::serialize_uuid(child_node_guid, "child_node_guid", fbb);
+        Schema::write<"parent_node_guid">(fbb, parent_node_guid);
+        Schema::write<"child_node_guid">(fbb, child_node_guid);
 
-        fbb.Double("elapsed_time", elapsed_time);
-        fbb.UInt("current_mem_usage", util::getCurrentRSS());
+        Schema::write<"elapsed_time">(fbb, elapsed_time);
+        Schema::write<"current_mem_usage">(fbb, uint64_t(util::getCurrentRSS()));
 
         for (auto const& x: metrics) {
             auto name = x.first;
@@ -190,9 +255,14 @@ MetricsMessage::MetricsMessage(
                 fbb.Double("variance", tracker.variance_value());
                 fbb.Double("max", tracker.max_value);
                 fbb.Double("min", tracker.min_value);
+                if (!tracker.bucket_counts.empty()) {
+                    fbb.Vector("buckets", tracker.bucket_counts.data(), tracker.bucket_counts.size());
+                }
             });
         }
     });
+
+    fields = Schema(root_map());
 }
 
 void MetricsMessage::print_on(ostream& os) const
@@ -275,6 +345,9 @@ void MetricsMessage::pretty_print(const std::string& title, bool compact) const
 MetricsPublisherNode::MetricsPublisherNode(const std::string& name):
     Node(name)
 {
+    tracked_receive_time.enable_histogram();
+    tracked_dt.enable_histogram();
+    tracked_latency.enable_histogram();
     this->reset();
 
     char hostname[HOST_NAME_MAX + 1];
@@ -307,7 +380,8 @@ void MetricsPublisherNode::receive_from(core::MessagePtr, const core::Node&)
     publish_and_reset();
 }
 
-void MetricsPublisherNode::record_metrics(double receive_time, long unsigned int bytes, double time_since_last_receive, double latency, int num_missed_messages)
+void MetricsPublisherNode::record_metrics(double receive_time, long unsigned int bytes, double time_since_last_receive, double latency,
+    uint64_t num_missed_messages, uint64_t num_reordered_messages, uint64_t num_duplicate_messages)
 {
     std::unique_lock<std::mutex> lck(mtx);
 
@@ -318,6 +392,8 @@ void MetricsPublisherNode::record_metrics(double receive_time, long unsigned int
     }
     tracked_latency.record_value(latency);
     tracked_missed_messages.record_value((double)num_missed_messages);
+    tracked_reordered_messages.record_value((double)num_reordered_messages);
+    tracked_duplicate_messages.record_value((double)num_duplicate_messages);
 }
 
 void MetricsPublisherNode::reset()
@@ -328,6 +404,8 @@ void MetricsPublisherNode::reset()
     tracked_dt.reset();
     tracked_latency.reset();
     tracked_missed_messages.reset();
+    tracked_reordered_messages.reset();
+    tracked_duplicate_messages.reset();
 }
 
 void MetricsPublisherNode::publish_and_reset()
@@ -341,7 +419,9 @@ void MetricsPublisherNode::publish_and_reset()
         { std::string("bytes"), tracked_bytes },
         { std::string("dt"), tracked_dt },
         { std::string("latency"), tracked_latency },
-        { std::string("missed"), tracked_missed_messages }
+        { std::string("missed"), tracked_missed_messages },
+        { std::string("reordered"), tracked_reordered_messages },
+        { std::string("duplicates"), tracked_duplicate_messages }
     };
 
     this->signal(std::make_shared<MetricsMessage>(elapsed_time, m,
@@ -365,6 +445,8 @@ void MetricsPublisherNode::pretty_print(const std::string& title, bool compact)
     tracked_dt.pretty_print("  dt, seconds", compact);
     tracked_latency.pretty_print("  latency, seconds", compact);
     tracked_missed_messages.pretty_print("  missed messages", compact);
+    tracked_reordered_messages.pretty_print("  reordered messages", compact);
+    tracked_duplicate_messages.pretty_print("  duplicate messages", compact);
 }
 
 
@@ -400,6 +482,30 @@ MetricsNode::MetricsNode(shared_ptr<Node> publisher_target_node, const string& n
     publisher_node->connect(publisher_target_node);
 }
 
+MetricsNode::~MetricsNode()
+{
+    stop_passive_publishing_timer();
+}
+
+void MetricsNode::start_passive_publishing_timer()
+{
+    if (passive_frequency_hz <= 0 || passive_timer_id != 0) {
+        return;
+    }
+    auto publisher = publisher_node;
+    passive_timer_id = util::TimerService::instance().schedule_periodic(
+        1.0 / passive_frequency_hz,
+        [publisher]{ publisher->publish_and_reset(); });
+}
+
+void MetricsNode::stop_passive_publishing_timer()
+{
+    auto timer_id = passive_timer_id.exchange(0);
+    if (timer_id != 0) {
+        util::TimerService::instance().cancel(timer_id);
+    }
+}
+
 void MetricsNode::on_connect(const core::Node& node, bool node_is_child)
 {
     if (node_is_child) {
@@ -435,24 +541,22 @@ void MetricsNode::receive(core::MessagePtr m)
     // the message's timestamp (when it was created, or broadcast).
     double latency = t0 - m->timestamp();
 
-    // compute the number of messages we skipped from that source
-    auto guid = m->source_node_guid().str();
-    auto new_message_index = m->message_counter();
-    int last_received_message_index = 0;
-    auto lmip = node_uuids_to_last_received_message_indexes.find(guid);
-    if (lmip != node_uuids_to_last_received_message_indexes.end()) {
-        last_received_message_index = lmip->second;
+    // compute the number of messages we lost from that source, as
+    // opposed to ones that arrived out of order, or twice
+    SequenceTracker::Update sequence;
+    uint64_t counter = m->message_counter();
+    if (counter != std::numeric_limits<uint64_t>::max()) {
+        sequence = source_sequences[m->source_node_guid()].record(counter);
     }
-    node_uuids_to_last_received_message_indexes[guid] = new_message_index;
-    int missed_messages = std::max<int>(0, new_message_index - last_received_message_index - 1);
 
     // record all the above
-    publisher_node->record_metrics(receive_dt, bytes, first_time ? -1 : time_since_last_receive, latency, missed_messages);
+    publisher_node->record_metrics(receive_dt, bytes, first_time ? -1 : time_since_last_receive, latency,
+        sequence.lost, sequence.reordered, sequence.duplicates);
 
 
     // 'passive publishing' is just publishing that happens upon the
     // signaller's thread, if we haven't published for some time
-    if (passive_frequency_hz != 0) {
+    if (passive_frequency_hz != 0 && passive_timer_id == 0) {
         if (last_passive_publish_time == 0) {
             last_passive_publish_time = t0;
         }
@@ -0,0 +1,381 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <tuple>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "roboflex_core/core_nodes/metrics_exporter.h"
+
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace roboflex {
+namespace nodes {
+
+// How often the server thread checks whether it should stop.
+constexpr int PollTimeoutMilliseconds = 100;
+
+// A scrape's request has to fit in this, and the whole exchange - request
+// and response - has to be over within this.
+constexpr size_t MaxRequestBytes = 8192;
+constexpr int ClientTimeoutMilliseconds = 1000;
+
+// Label values in quotes: backslash, quote and newline are escaped.
+static string escape_label_value(const string& value)
+{
+    string escaped;
+    escaped.reserve(value.size());
+    for (char c: value) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '"': escaped += "\\\""; break;
+            case '\n': escaped += "\\n"; break;
+            default: escaped += c;
+        }
+    }
+    return escaped;
+}
+
+
+// -- MetricsExporter --
+
+void MetricsExporter::Histogram::add(const MetricTracker& tracker)
+{
+    if (bucket_counts.empty()) {
+        bucket_counts.assign(tracker.bucket_counts.size(), 0);
+    }
+    if (tracker.bucket_counts.size() == bucket_counts.size()) {
+        for (size_t i = 0; i < bucket_counts.size(); i++) {
+            bucket_counts[i] += tracker.bucket_counts[i];
+        }
+    }
+    count += tracker.count;
+    sum += tracker.total;
+}
+
+MetricsExporter::MetricsExporter(
+    int port,
+    const string& address,
+    const string& name):
+        RunnableNode(name),
+        port(port),
+        address(address)
+{
+
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    // stop our thread while our members are still alive
+    this->stop();
+}
+
+void MetricsExporter::start()
+{
+    if (listen_socket < 0) {
+        int s = socket(AF_INET, SOCK_STREAM, 0);
+        if (s < 0) {
+            throw std::runtime_error("MetricsExporter \"" + get_name() + "\" could not create a socket: " + std::strerror(errno));
+        }
+
+        int one = 1;
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port.load());
+        if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+            close(s);
+            throw std::runtime_error("MetricsExporter \"" + get_name() + "\": \"" + address + "\" is not an IPv4 address");
+        }
+        if (bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(s, 16) != 0) {
+            string error = std::strerror(errno);
+            close(s);
+            throw std::runtime_error("MetricsExporter \"" + get_name() + "\" could not listen on " + address + ":" + std::to_string(port.load()) + ": " + error);
+        }
+
+        // in case we asked for any port
+        socklen_t length = sizeof(addr);
+        getsockname(s, reinterpret_cast<sockaddr*>(&addr), &length);
+        port = ntohs(addr.sin_port);
+
+        listen_socket = s;
+    }
+    RunnableNode::start();
+}
+
+void MetricsExporter::stop()
+{
+    RunnableNode::stop();
+    close_socket();
+}
+
+void MetricsExporter::close_socket()
+{
+    if (listen_socket >= 0) {
+        close(listen_socket);
+        listen_socket = -1;
+    }
+}
+
+void MetricsExporter::receive(MessagePtr m)
+{
+    if (m->message_name() != MetricsMessage::MetricsMessageType) {
+        return;
+    }
+
+    MetricsMessage metrics(*m);
+    auto tracker = [&metrics](const char* key) -> const MetricTracker* {
+        auto it = metrics.metrics.find(key);
+        return it == metrics.metrics.end() ? nullptr : &it->second;
+    };
+
+    {
+        const std::lock_guard<std::mutex> lock(registry_mutex);
+
+        Edge& edge = edges[{metrics.parent_node_guid(), metrics.child_node_guid()}];
+        edge.parent_name = metrics.parent_node_name();
+        edge.child_name = metrics.child_node_name();
+        edge.host_name = metrics.host_name();
+
+        if (auto t = tracker("time")) {
+            edge.messages += t->count;
+            edge.receive_time.add(*t);
+            edge.frequency_hz = metrics.elapsed_time() > 0 ? t->count / metrics.elapsed_time() : 0;
+        }
+        if (auto t = tracker("bytes")) {
+            edge.bytes += t->total;
+        }
+        if (auto t = tracker("missed")) {
+            edge.missed += uint64_t(std::llround(t->total));
+        }
+        if (auto t = tracker("reordered")) {
+            edge.reordered += uint64_t(std::llround(t->total));
+        }
+        if (auto t = tracker("duplicates")) {
+            edge.duplicates += uint64_t(std::llround(t->total));
+        }
+        if (auto t = tracker("latency")) {
+            edge.latency.add(*t);
+        }
+        if (auto t = tracker("dt")) {
+            edge.interval.add(*t);
+        }
+
+        host_memory_bytes[metrics.host_name()] = metrics.current_mem_usage();
+    }
+
+    this->signal(m);
+}
+
+string MetricsExporter::render() const
+{
+    std::ostringstream out;
+    out.precision(12);
+
+    const std::lock_guard<std::mutex> lock(registry_mutex);
+
+    // every series of a family has to be together; within that, by edge
+    std::vector<const Edge*> sorted;
+    for (auto& [guids, edge]: edges) {
+        sorted.push_back(&edge);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Edge* a, const Edge* b) {
+        return std::tie(a->parent_name, a->child_name, a->host_name) < std::tie(b->parent_name, b->child_name, b->host_name);
+    });
+
+    auto labels = [](const Edge& edge) {
+        return "parent=\"" + escape_label_value(edge.parent_name) +
+            "\",child=\"" + escape_label_value(edge.child_name) +
+            "\",host=\"" + escape_label_value(edge.host_name) + "\"";
+    };
+
+    auto family = [&out](const string& name, const char* type, const char* unit, const char* help) {
+        out << "# TYPE " << name << " " << type << "\n";
+        if (unit != nullptr) {
+            out << "# UNIT " << name << " " << unit << "\n";
+        }
+        out << "# HELP " << name << " " << help << "\n";
+    };
+
+    auto counter = [&](const string& name, const char* unit, const char* help, auto value) {
+        family(name, "counter", unit, help);
+        for (auto edge: sorted) {
+            out << name << "_total{" << labels(*edge) << "} " << value(*edge) << "\n";
+        }
+    };
+
+    auto histogram = [&](const string& name, const char* help, Histogram Edge::* member) {
+        family(name, "histogram", "seconds", help);
+        for (auto edge: sorted) {
+            const Histogram& h = edge->*member;
+            string edge_labels = labels(*edge);
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < MetricTracker::HistogramBounds.size() && i < h.bucket_counts.size(); i++) {
+                cumulative += h.bucket_counts[i];
+                out << name << "_bucket{" << edge_labels << ",le=\"" << MetricTracker::HistogramBounds[i] << "\"} " << cumulative << "\n";
+            }
+            out << name << "_bucket{" << edge_labels << ",le=\"+Inf\"} " << h.count << "\n"
+                << name << "_count{" << edge_labels << "} " << h.count << "\n"
+                << name << "_sum{" << edge_labels << "} " << h.sum << "\n";
+        }
+    };
+
+    counter("roboflex_edge_messages", nullptr, "Messages that crossed the edge.", [](const Edge& e) { return e.messages; });
+    counter("roboflex_edge_bytes", "bytes", "Bytes that crossed the edge.", [](const Edge& e) { return e.bytes; });
+    counter("roboflex_edge_missed_messages", nullptr, "Messages lost before the edge.", [](const Edge& e) { return e.missed; });
+    counter("roboflex_edge_reordered_messages", nullptr, "Messages that reached the edge out of order.", [](const Edge& e) { return e.reordered; });
+    counter("roboflex_edge_duplicate_messages", nullptr, "Messages that reached the edge more than once.", [](const Edge& e) { return e.duplicates; });
+
+    histogram("roboflex_edge_latency_seconds", "Time from a message's timestamp to its crossing the edge.", &Edge::latency);
+    histogram("roboflex_edge_receive_seconds", "Time the edge's child took to receive a message.", &Edge::receive_time);
+    histogram("roboflex_edge_interval_seconds", "Time between messages crossing the edge.", &Edge::interval);
+
+    family("roboflex_edge_frequency_hertz", "gauge", "hertz", "Rate of messages over the edge, in the last metrics period.");
+    for (auto edge: sorted) {
+        out << "roboflex_edge_frequency_hertz{" << labels(*edge) << "} " << edge->frequency_hz << "\n";
+    }
+
+    family("roboflex_host_memory_bytes", "gauge", "bytes", "Resident memory of the process reporting metrics.");
+    for (auto& [host, bytes]: host_memory_bytes) {
+        out << "roboflex_host_memory_bytes{host=\"" << escape_label_value(host) << "\"} " << bytes << "\n";
+    }
+
+    out << "# EOF\n";
+    return out.str();
+}
+
+size_t MetricsExporter::get_num_edges() const
+{
+    const std::lock_guard<std::mutex> lock(registry_mutex);
+    return edges.size();
+}
+
+void MetricsExporter::child_thread_fn()
+{
+    while (!this->stop_requested()) {
+        pollfd listening = { listen_socket, POLLIN, 0 };
+        if (poll(&listening, 1, PollTimeoutMilliseconds) <= 0) {
+            continue;
+        }
+        int client = accept(listen_socket, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+        serve(client);
+        close(client);
+    }
+}
+
+bool MetricsExporter::wait_for_client(int client, short events, std::chrono::steady_clock::time_point deadline) const
+{
+    while (!this->stop_requested()) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            return false;
+        }
+        pollfd p = { client, events, 0 };
+        int r = poll(&p, 1, int(std::min<int64_t>(remaining, PollTimeoutMilliseconds)));
+        if (r > 0) {
+            return true;
+        }
+        if (r < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+    return false;
+}
+
+void MetricsExporter::serve(int client)
+{
+    // One deadline for the whole exchange, so a client that trickles its
+    // request in a byte at a time can't hold up other scrapes, or stop().
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ClientTimeoutMilliseconds);
+#if defined(SO_NOSIGPIPE)
+    int one = 1;
+    setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+    // we only need the request line, but read the headers too, to be polite
+    string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == string::npos && request.size() < MaxRequestBytes) {
+        if (!wait_for_client(client, POLLIN, deadline)) {
+            break;
+        }
+        ssize_t n = recv(client, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        request.append(buffer, n);
+    }
+    if (this->stop_requested()) {
+        return;
+    }
+
+    std::istringstream request_line(request.substr(0, request.find("\r\n")));
+    string method, target;
+    request_line >> method >> target;
+    target = target.substr(0, target.find('?'));
+
+    string status = "200 OK";
+    string content_type = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+    string body;
+    if (method != "GET") {
+        status = "405 Method Not Allowed";
+        content_type = "text/plain; charset=utf-8";
+        body = "Only GET is supported\n";
+    } else if (target != "/metrics") {
+        status = "404 Not Found";
+        content_type = "text/plain; charset=utf-8";
+        body = "Metrics are at /metrics\n";
+    } else {
+        body = render();
+        num_scrapes++;
+    }
+
+    string response =
+        "HTTP/1.1 " + status + "\r\n"
+        "Content-Type: " + content_type + "\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: close\r\n"
+        "\r\n" + body;
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        if (!wait_for_client(client, POLLOUT, deadline)) {
+            break;
+        }
+        ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        sent += n;
+    }
+}
+
+string MetricsExporter::to_string() const
+{
+    std::stringstream sst;
+    sst << "<MetricsExporter " << address << ":" << port
+        << " edges=" << get_num_edges()
+        << " scrapes=" << num_scrapes
+        << " " << RunnableNode::to_string() << ">";
+    return sst.str();
+}
+
+} // namespace nodes
+} // namespace roboflex
@@ -0,0 +1,207 @@
+#include <sstream>
+#include "roboflex_core/core_nodes/rpc_router.h"
+#include "roboflex_core/core_messages/core_messages.h"
+
+namespace roboflex {
+namespace nodes {
+
+// A message, carried whole as a blob; nullptr if there isn't one.
+static MessagePtr message_from_blob(flexbuffers::Reference r)
+{
+    if (!r.IsBlob()) {
+        return nullptr;
+    }
+    auto blob = r.AsBlob();
+    if (blob.size() == 0) {
+        return nullptr;
+    }
+    auto payload = std::make_shared<MessageBackingStoreAligned>(blob.data(), blob.size());
+    return std::make_shared<Message>(payload);
+}
+
+
+// -- RemoteCallMessage --
+
+RemoteCallMessage::RemoteCallMessage(Message& other):
+    Message(other)
+{
+    fields = Schema(root_map());
+}
+
+RemoteCallMessage::RemoteCallMessage(const uuid& target, MessagePtr call, uint64_t call_id):
+    Message(CoreModuleName, RemoteCallMessageName)
+{
+    if (call == nullptr) {
+        throw std::runtime_error("RemoteCallMessage needs a call");
+    }
+    flexbuffers::Builder fbb = get_builder();
+    WriteMapRoot(fbb, [&]() {
+        Schema::write<"target">(fbb, target);
+        Schema::write<"call_id">(fbb, call_id);
+        fbb.Key("call");
+        fbb.Blob(call->get_raw_data(), call->get_raw_size());
+    });
+    fields = Schema(root_map());
+}
+
+MessagePtr RemoteCallMessage::call() const
+{
+    return message_from_blob(fields.ref<"call">());
+}
+
+void RemoteCallMessage::print_on(ostream& os) const
+{
+    os << "<RemoteCallMessage target: " << target() << " call_id: " << call_id() << " ";
+    Message::print_on(os);
+    os << ">";
+}
+
+
+// -- RemoteCallResultMessage --
+
+RemoteCallResultMessage::RemoteCallResultMessage(Message& other):
+    Message(other)
+{
+    fields = Schema(root_map());
+}
+
+RemoteCallResultMessage::RemoteCallResultMessage(
+    const uuid& target,
+    uint64_t call_id,
+    bool handled,
+    const string& error,
+    MessagePtr result):
+        Message(CoreModuleName, RemoteCallResultMessageName)
+{
+    flexbuffers::Builder fbb = get_builder();
+    WriteMapRoot(fbb, [&]() {
+        Schema::write<"target">(fbb, target);
+        Schema::write<"call_id">(fbb, call_id);
+        Schema::write<"handled">(fbb, handled);
+        Schema::write<"error">(fbb, error);
+        if (result != nullptr) {
+            fbb.Key("result");
+            fbb.Blob(result->get_raw_data(), result->get_raw_size());
+        }
+    });
+    fields = Schema(root_map());
+}
+
+MessagePtr RemoteCallResultMessage::result() const
+{
+    return message_from_blob(fields.ref<"result">());
+}
+
+void RemoteCallResultMessage::print_on(ostream& os) const
+{
+    os << "<RemoteCallResultMessage target: " << target()
+       << " call_id: " << call_id()
+       << " handled: " << handled();
+    if (!error().empty()) {
+        os << " error: \"" << error() << "\"";
+    }
+    os << " ";
+    Message::print_on(os);
+    os << ">";
+}
+
+
+// -- RpcRouter --
+
+RpcRouter::RpcRouter(const string& name):
+    Node(name)
+{
+
+}
+
+void RpcRouter::add_node(NodePtr node)
+{
+    if (node == nullptr) {
+        return;
+    }
+    const std::lock_guard<std::mutex> lock(nodes_mutex);
+    nodes.insert_or_assign(node->get_guid(), node);
+}
+
+void RpcRouter::add_graph(NodePtr root)
+{
+    if (root == nullptr) {
+        return;
+    }
+    add_node(root);
+    root->walk_nodes_forwards([this](NodePtr node, int) { add_node(node); });
+}
+
+bool RpcRouter::remove_node(const uuid& guid)
+{
+    const std::lock_guard<std::mutex> lock(nodes_mutex);
+    return nodes.erase(guid);
+}
+
+NodePtr RpcRouter::find_node(const uuid& guid) const
+{
+    const std::lock_guard<std::mutex> lock(nodes_mutex);
+    auto node = nodes.find(guid);
+    return node == nullptr ? nullptr : node->lock();
+}
+
+size_t RpcRouter::get_num_nodes() const
+{
+    const std::lock_guard<std::mutex> lock(nodes_mutex);
+    return nodes.size();
+}
+
+MessagePtr RpcRouter::call(const uuid& target, MessagePtr rpc_message) const
+{
+    // call outside the lock: handlers may take a while, or use us
+    NodePtr node = find_node(target);
+    return node == nullptr ? nullptr : node->handle_rpc(rpc_message);
+}
+
+void RpcRouter::receive(MessagePtr m)
+{
+    if (m->module_name_view() != CoreModuleName || m->message_name_view() != RemoteCallMessage::RemoteCallMessageName) {
+        return;
+    }
+
+    RemoteCallMessage remote_call(*m);
+    num_calls++;
+
+    bool handled = false;
+    string error;
+    MessagePtr result;
+
+    // Always go through handle_rpc: nodes (python ones, say) may answer
+    // by overriding it rather than by registering handlers.
+    MessagePtr rpc_message = remote_call.call();
+    NodePtr node = rpc_message == nullptr ? nullptr : find_node(remote_call.target());
+    if (node != nullptr) {
+        try {
+            result = node->handle_rpc(rpc_message);
+            handled = result != nullptr;
+        } catch (const std::exception& e) {
+            handled = true;
+            error = e.what();
+        }
+    }
+    if (!handled) {
+        num_unhandled++;
+    }
+
+    this->signal(std::make_shared<RemoteCallResultMessage>(
+        remote_call.target(), remote_call.call_id(), handled, error, result));
+}
+
+string RpcRouter::to_string() const
+{
+    std::stringstream sst;
+    sst << "<RpcRouter"
+        << " nodes=" << get_num_nodes()
+        << " calls=" << num_calls
+        << " unhandled=" << num_unhandled
+        << " " << Node::to_string() << ">";
+    return sst.str();
+}
+
+} // namespace nodes
+} // namespace roboflex
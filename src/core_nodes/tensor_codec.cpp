@@ -0,0 +1,175 @@
+#include <sstream>
+#include "roboflex_core/core_nodes/tensor_codec.h"
+
+namespace roboflex {
+namespace nodes {
+
+using namespace serialization;
+
+// A copy of m, except for the omitted keys, whose place the payload function
+// takes. Keeps the source node's identity, so that metrics, and anything
+// else downstream, still sees where the message really came from.
+static MessagePtr rewrite_message(
+    MessagePtr m,
+    const std::set<string>& omit_keys,
+    std::function<void(flexbuffers::Builder&)> payload_function)
+{
+    auto rewritten = std::make_shared<Message>(m->module_name(), m->message_name(), *m, omit_keys, payload_function);
+    rewritten->set_source_node_guid(m->source_node_guid());
+    rewritten->set_source_node_name(m->source_node_name());
+    return rewritten;
+}
+
+
+// -- TensorEncoder --
+
+TensorEncoder::TensorEncoder(
+    const std::vector<string>& tensor_keys,
+    int encoding,
+    unsigned int keyframe_interval,
+    const string& name):
+        Node(name),
+        tensor_keys(tensor_keys),
+        encoding(encoding),
+        keyframe_interval(keyframe_interval)
+{
+
+}
+
+void TensorEncoder::receive(MessagePtr m)
+{
+    auto root = m->root_map();
+
+    std::set<string> keys_to_encode;
+    for (auto& key: tensor_keys) {
+        auto r = root[key];
+        if (is_tensor(r) && tensor_encoding(r) == EncodingNone) {
+            keys_to_encode.insert(key);
+        }
+    }
+
+    if (keys_to_encode.empty()) {
+        signal(m);
+        return;
+    }
+
+    MessagePtr encoded;
+    {
+        const std::lock_guard<std::mutex> lock(streams_mutex);
+        encoded = rewrite_message(m, keys_to_encode, [&](flexbuffers::Builder& fbb) {
+            for (auto& key: keys_to_encode) {
+                auto r = root[key];
+                auto blob = lookup(r.AsMap(), DataFlexKey).AsBlob();
+                StreamState& stream = streams[key];
+
+                bool keyframe =
+                    stream.previous.size() != blob.size() ||
+                    (keyframe_interval > 0 && stream.frame % keyframe_interval == 0);
+                bool delta = (encoding & EncodingFrameDelta) && !keyframe;
+                int frame_encoding = delta ? encoding : (encoding & ~EncodingFrameDelta);
+
+                serialize_encoded_tensor(fbb, r, key, frame_encoding, delta ? stream.previous.data() : nullptr, stream.frame);
+
+                if (encoding & EncodingFrameDelta) {
+                    stream.previous.assign(blob.data(), blob.data() + blob.size());
+                }
+                stream.frame++;
+            }
+        });
+    }
+
+    signal(encoded);
+}
+
+string TensorEncoder::to_string() const
+{
+    std::stringstream sst;
+    sst << "<TensorEncoder"
+        << " keys: " << tensor_keys.size()
+        << " encoding: " << encoding
+        << " keyframe_interval: " << keyframe_interval
+        << " " << Node::to_string() << ">";
+    return sst.str();
+}
+
+
+// -- TensorDecoder --
+
+TensorDecoder::TensorDecoder(const string& name):
+    Node(name)
+{
+
+}
+
+void TensorDecoder::receive(MessagePtr m)
+{
+    auto root = m->root_map();
+
+    std::set<string> keys_to_decode;
+    auto keys = root.Keys();
+    auto values = root.Values();
+    for (size_t i=0; i<values.size(); i++) {
+        if (is_tensor(values[i]) && tensor_encoding(values[i]) != EncodingNone) {
+            keys_to_decode.insert(keys[i].AsKey());
+        }
+    }
+
+    if (keys_to_decode.empty()) {
+        signal(m);
+        return;
+    }
+
+    MessagePtr decoded;
+    {
+        const std::lock_guard<std::mutex> lock(streams_mutex);
+
+        bool can_decode = true;
+        for (auto& key: keys_to_decode) {
+            auto r = root[key];
+            StreamState& stream = streams[key];
+            uint64_t frame = tensor_frame(r);
+
+            bool delta = tensor_encoding(r) & EncodingFrameDelta;
+            if (delta && !(stream.valid && frame == stream.frame + 1 && stream.previous.size() == tensor_decoded_size(r))) {
+                // we don't have the frame this one is relative to
+                stream.valid = false;
+                can_decode = false;
+                continue;
+            }
+
+            std::vector<uint8_t> data;
+            stream.valid = false;
+            decode_tensor(r, data, delta ? stream.previous.data() : nullptr);
+            stream.previous.swap(data);
+            stream.frame = frame;
+            stream.valid = true;
+        }
+
+        if (!can_decode) {
+            num_dropped++;
+            return;
+        }
+
+        decoded = rewrite_message(m, keys_to_decode, [&](flexbuffers::Builder& fbb) {
+            for (auto& key: keys_to_decode) {
+                auto r = root[key];
+                auto& data = streams[key].previous;
+                serialize_raw_tensor(fbb, key, tensor_type_code(r), tensor_shape(r), data.data(), data.size());
+            }
+        });
+    }
+
+    signal(decoded);
+}
+
+string TensorDecoder::to_string() const
+{
+    std::stringstream sst;
+    sst << "<TensorDecoder"
+        << " dropped: " << num_dropped
+        << " " << Node::to_string() << ">";
+    return sst.str();
+}
+
+} // namespace nodes
+} // namespace roboflex
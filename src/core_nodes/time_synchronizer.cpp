@@ -0,0 +1,350 @@
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include "roboflex_core/core_nodes/time_synchronizer.h"
+#include "roboflex_core/core_messages/core_messages.h"
+
+namespace roboflex {
+namespace nodes {
+
+// -- SynchronizedMessage --
+
+static const serialization::FlexKey NamesFlexKey("names");
+static const serialization::FlexKey MessagesFlexKey("messages");
+
+SynchronizedMessage::SynchronizedMessage(Message& other):
+    Message(other)
+{
+    messages.resize(get_num_messages());
+}
+
+SynchronizedMessage::SynchronizedMessage(
+    const vector<string>& names,
+    const vector<MessagePtr>& messages,
+    double timestamp,
+    bool embed_messages):
+        Message(CoreModuleName, SynchronizedMessageType),
+        messages(messages)
+{
+    if (names.size() != messages.size()) {
+        throw std::runtime_error("SynchronizedMessage needs one name per message");
+    }
+    flexbuffers::Builder fbb = get_builder();
+    WriteMapRoot(fbb, [&]() {
+        fbb.Vector("names", [&]() {
+            for (auto& name: names) {
+                fbb.String(name);
+            }
+        });
+        if (embed_messages) {
+            fbb.Vector("messages", [&]() {
+                for (auto& m: messages) {
+                    fbb.Blob(m->get_raw_data(), m->get_raw_size());
+                }
+            });
+        }
+    });
+    set_timestamp(timestamp);
+}
+
+size_t SynchronizedMessage::get_num_messages() const
+{
+    return root_val(NamesFlexKey).AsVector().size();
+}
+
+bool SynchronizedMessage::has_embedded_messages() const
+{
+    return !root_val(MessagesFlexKey).IsNull();
+}
+
+vector<string> SynchronizedMessage::get_names() const
+{
+    auto names_vector = root_val(NamesFlexKey).AsVector();
+    vector<string> names;
+    names.reserve(names_vector.size());
+    for (size_t i = 0; i < names_vector.size(); i++) {
+        names.push_back(names_vector[i].AsString().str());
+    }
+    return names;
+}
+
+MessagePtr SynchronizedMessage::get_message(size_t index) const
+{
+    const std::lock_guard<std::mutex> lock(messages_mutex);
+    if (index >= messages.size()) {
+        throw std::runtime_error("SynchronizedMessage has no message " + std::to_string(index));
+    }
+    if (messages[index] == nullptr) {
+        if (!has_embedded_messages()) {
+            throw std::runtime_error("SynchronizedMessage was sent without its messages: set embed_messages on the TimeSynchronizer to send them");
+        }
+        auto blob = root_val(MessagesFlexKey).AsVector()[index].AsBlob();
+        auto payload = std::make_shared<MessageBackingStoreAligned>(blob.data(), blob.size());
+        messages[index] = std::make_shared<Message>(payload);
+    }
+    return messages[index];
+}
+
+MessagePtr SynchronizedMessage::get_message(const string& name) const
+{
+    auto names = get_names();
+    auto it = std::find(names.begin(), names.end(), name);
+    if (it == names.end()) {
+        throw std::runtime_error("SynchronizedMessage has no message named \"" + name + "\"");
+    }
+    return get_message(it - names.begin());
+}
+
+void SynchronizedMessage::print_on(ostream& os) const
+{
+    os << "<SynchronizedMessage names:";
+    for (auto& name: get_names()) {
+        os << " " << name;
+    }
+    os << " ";
+    Message::print_on(os);
+    os << ">";
+}
+
+
+// -- TimeSynchronizer --
+
+void TimeSynchronizer::Input::receive(MessagePtr m)
+{
+    synchronizer.call([this, &m](TimeSynchronizer& owner) {
+        owner.receive_input(index, m);
+    });
+}
+
+TimeSynchronizer::TimeSynchronizer(
+    double slop,
+    size_t buffer_capacity,
+    const string& name):
+        TimeSynchronizer(Policy::ApproximateTime, slop, buffer_capacity, name)
+{
+
+}
+
+TimeSynchronizer::TimeSynchronizer(
+    Policy policy,
+    double slop,
+    size_t buffer_capacity,
+    const string& name):
+        Node(name),
+        policy(policy),
+        slop(policy == Policy::Exact ? 0.0 : slop),
+        buffer_capacity(std::max(buffer_capacity, size_t(1)))
+{
+    if (this->slop < 0) {
+        throw std::runtime_error("TimeSynchronizer \"" + name + "\": slop must not be negative");
+    }
+}
+
+TimeSynchronizer::~TimeSynchronizer()
+{
+    // wait for any input that's matching in us
+    vector<util::OwnerLink<TimeSynchronizer>> links;
+    vector<std::weak_ptr<Input>> weak_inputs;
+    {
+        const std::lock_guard<std::mutex> lock(buffers_mutex);
+        links = input_links;
+        weak_inputs = inputs;
+    }
+    for (auto& link: links) {
+        link.cut();
+    }
+
+    // An input owns us through its connection, unless we weren't owned
+    // by a shared_ptr when it was made: then it must not keep pointing
+    // here.
+    for (auto& input: weak_inputs) {
+        if (auto i = input.lock()) {
+            i->disconnect(*this);
+        }
+    }
+}
+
+NodePtr TimeSynchronizer::add_input(const string& name)
+{
+    shared_ptr<Input> input;
+    {
+        const std::lock_guard<std::mutex> lock(buffers_mutex);
+        size_t index = inputs.size();
+        auto input_name = name.empty() ? get_name() + "_input_" + std::to_string(index) : name;
+        util::OwnerLink<TimeSynchronizer> link(this);
+        input = std::make_shared<Input>(link, index, input_name);
+        inputs.push_back(input);
+        input_links.push_back(link);
+        input_names.push_back(input_name);
+        buffers.emplace_back();
+    }
+
+    // so that walks reach us through the input
+    if (auto self = weak_from_this().lock()) {
+        input->connect(self);
+    } else {
+        input->connect(*this);
+    }
+    return input;
+}
+
+NodePtr TimeSynchronizer::get_input(size_t index) const
+{
+    const std::lock_guard<std::mutex> lock(buffers_mutex);
+    if (index >= inputs.size()) {
+        throw std::runtime_error("TimeSynchronizer \"" + get_name() + "\" has no input " + std::to_string(index));
+    }
+    return inputs[index].lock();
+}
+
+size_t TimeSynchronizer::get_num_inputs() const
+{
+    const std::lock_guard<std::mutex> lock(buffers_mutex);
+    return inputs.size();
+}
+
+vector<string> TimeSynchronizer::get_input_names() const
+{
+    const std::lock_guard<std::mutex> lock(buffers_mutex);
+    return input_names;
+}
+
+void TimeSynchronizer::set_callback(MatchCallback callback)
+{
+    const std::lock_guard<std::mutex> lock(emit_mutex);
+    this->callback = callback;
+}
+
+void TimeSynchronizer::receive_input(size_t index, MessagePtr m)
+{
+    vector<vector<MessagePtr>> matches;
+    vector<double> match_timestamps;
+    vector<string> names;
+
+    std::unique_lock<std::mutex> buffers_lock(buffers_mutex);
+
+    auto& buffer = buffers[index];
+    buffer.push_back(Entry{m->timestamp(), m});
+    if (buffer.size() > buffer_capacity) {
+        buffer.pop_front();
+        num_dropped++;
+    }
+
+    find_matches(matches, match_timestamps);
+    if (matches.empty()) {
+        return;
+    }
+    names = input_names;
+
+    // take the emit lock before letting go of the buffers, so that
+    // whoever finds the next match has to wait for us to emit this one
+    const std::lock_guard<std::mutex> emit_lock(emit_mutex);
+    buffers_lock.unlock();
+
+    for (size_t i = 0; i < matches.size(); i++) {
+        if (callback) {
+            callback(matches[i]);
+        }
+        if (has_observers()) {
+            signal(std::make_shared<SynchronizedMessage>(names, matches[i], match_timestamps[i], embed_messages));
+        }
+    }
+}
+
+size_t TimeSynchronizer::nearest(const std::deque<Entry>& buffer, double t)
+{
+    auto it = std::lower_bound(buffer.begin(), buffer.end(), t,
+        [](const Entry& e, double t) { return e.timestamp < t; });
+    if (it == buffer.end()) {
+        return buffer.size() - 1;
+    }
+    if (it != buffer.begin() && t - std::prev(it)->timestamp <= it->timestamp - t) {
+        --it;
+    }
+    return it - buffer.begin();
+}
+
+void TimeSynchronizer::find_matches(vector<vector<MessagePtr>>& matches, vector<double>& match_timestamps)
+{
+    if (buffers.empty()) {
+        return;
+    }
+
+    while (true) {
+
+        // the pivot: the latest of the oldest messages
+        size_t pivot_index = 0;
+        for (size_t i = 0; i < buffers.size(); i++) {
+            if (buffers[i].empty()) {
+                return;
+            }
+            if (buffers[i].front().timestamp > buffers[pivot_index].front().timestamp) {
+                pivot_index = i;
+            }
+        }
+        double pivot = buffers[pivot_index].front().timestamp;
+
+        // anything too old to go with the pivot can't go with any later pivot either
+        for (auto& buffer: buffers) {
+            while (!buffer.empty() && buffer.front().timestamp < pivot - slop) {
+                buffer.pop_front();
+                num_dropped++;
+            }
+            if (buffer.empty()) {
+                return;
+            }
+        }
+
+        // until every input has caught up with the pivot, something
+        // nearer to it might still arrive
+        for (auto& buffer: buffers) {
+            if (buffer.back().timestamp < pivot) {
+                return;
+            }
+        }
+
+        vector<size_t> chosen(buffers.size());
+        bool matched = true;
+        for (size_t i = 0; i < buffers.size(); i++) {
+            chosen[i] = nearest(buffers[i], pivot);
+            if (std::abs(buffers[i][chosen[i]].timestamp - pivot) > slop) {
+                matched = false;
+                break;
+            }
+        }
+
+        if (!matched) {
+            // some input has nothing near the pivot, and never will
+            buffers[pivot_index].pop_front();
+            num_dropped++;
+            continue;
+        }
+
+        vector<MessagePtr> match;
+        match.reserve(buffers.size());
+        for (size_t i = 0; i < buffers.size(); i++) {
+            match.push_back(std::move(buffers[i][chosen[i]].message));
+            buffers[i].erase(buffers[i].begin(), buffers[i].begin() + chosen[i] + 1);
+            num_dropped += chosen[i];
+        }
+        matches.push_back(std::move(match));
+        match_timestamps.push_back(pivot);
+        num_matched++;
+    }
+}
+
+string TimeSynchronizer::to_string() const
+{
+    std::stringstream sst;
+    sst << "<TimeSynchronizer"
+        << " inputs: " << get_num_inputs()
+        << " policy: " << (policy == Policy::Exact ? "exact" : "approximate_time")
+        << " slop: " << slop
+        << " matched: " << num_matched
+        << " dropped: " << num_dropped
+        << " " << Node::to_string() << ">";
+    return sst.str();
+}
+
+} // namespace nodes
+} // namespace roboflex
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include "roboflex_core/core_nodes/timestamp_merge.h"
+#include "roboflex_core/util/utils.h"
+
+namespace roboflex {
+namespace nodes {
+
+// The longest the merge thread sleeps, when idle, before checking again.
+constexpr double MaxIdleWaitSeconds = 0.05;
+
+void TimestampMerge::Input::receive(MessagePtr m)
+{
+    merge.call([this, &m](TimestampMerge& owner) {
+        if (queue->queue.try_push(std::move(m))) {
+            owner.wake();
+        } else {
+            queue->num_overflowed++;
+        }
+    });
+}
+
+void TimestampMerge::Input::on_connect(const Node& node, bool node_is_child)
+{
+    if (node_is_child) {
+        return;
+    }
+    const std::lock_guard<std::mutex> lock(parent_mutex);
+    if (parent != nullptr && parent != &node) {
+        throw std::runtime_error("TimestampMerge input \"" + get_name() + "\" is already connected to \"" +
+            parent->get_name() + "\"; each producer needs its own input");
+    }
+    parent = &node;
+    num_parent_connections++;
+}
+
+void TimestampMerge::Input::on_disconnect(const Node& node, bool node_is_child)
+{
+    if (node_is_child) {
+        return;
+    }
+    const std::lock_guard<std::mutex> lock(parent_mutex);
+    if (parent == &node && --num_parent_connections == 0) {
+        parent = nullptr;
+    }
+}
+
+TimestampMerge::TimestampMerge(
+    double lateness_window,
+    size_t queue_capacity,
+    Clock clock,
+    const string& name):
+        RunnableNode(name),
+        lateness_window(lateness_window),
+        queue_capacity(queue_capacity),
+        clock(clock)
+{
+
+}
+
+TimestampMerge::~TimestampMerge()
+{
+    // stop our thread while our members are still alive, and wait
+    // for any input that's pushing to us
+    this->stop();
+    for (auto& link: input_links) {
+        link.cut();
+    }
+
+    // An input owns us through its connection, unless we weren't owned
+    // by a shared_ptr when it was made: then it must not keep pointing
+    // here.
+    for (auto& input: inputs) {
+        if (auto i = input.lock()) {
+            i->disconnect(*this);
+        }
+    }
+}
+
+NodePtr TimestampMerge::add_input(const string& name)
+{
+    if (this->my_thread != nullptr) {
+        throw std::runtime_error("TimestampMerge \"" + get_name() + "\": inputs must be added before start()");
+    }
+    size_t index = input_queues.size();
+    auto input_name = name.empty() ? get_name() + "_input_" + std::to_string(index) : name;
+    auto queue = std::make_unique<InputQueue>(index, queue_capacity);
+    util::OwnerLink<TimestampMerge> link(this);
+    auto input = std::make_shared<Input>(link, queue.get(), input_name);
+    input_queues.push_back(std::move(queue));
+    input_links.push_back(link);
+    inputs.push_back(input);
+
+    // so that walks reach us through the input
+    if (auto self = weak_from_this().lock()) {
+        input->connect(self);
+    } else {
+        input->connect(*this);
+    }
+    return input;
+}
+
+NodePtr TimestampMerge::get_input(size_t index) const
+{
+    if (index >= inputs.size()) {
+        throw std::runtime_error("TimestampMerge \"" + get_name() + "\" has no input " + std::to_string(index));
+    }
+    return inputs[index].lock();
+}
+
+uint64_t TimestampMerge::get_num_overflowed() const
+{
+    uint64_t n = 0;
+    for (auto& input: input_queues) {
+        n += input->num_overflowed;
+    }
+    return n;
+}
+
+void TimestampMerge::wake()
+{
+    // pairs with the fence in child_thread_fn: either we see that it's
+    // sleeping, or it sees what we just queued.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_relaxed)) {
+        const std::lock_guard<std::mutex> lock(wake_mutex);
+        wake_cv.notify_one();
+    }
+}
+
+void TimestampMerge::request_stop()
+{
+    RunnableNode::request_stop();
+    const std::lock_guard<std::mutex> lock(wake_mutex);
+    wake_cv.notify_one();
+}
+
+void TimestampMerge::drain_inputs()
+{
+    MessagePtr m;
+    for (auto& input: input_queues) {
+        while (input->queue.try_pop(m)) {
+            double t = m->timestamp();
+            if (t < last_signalled_timestamp) {
+                num_late++;
+                continue;
+            }
+            input->latest_timestamp = std::max(input->latest_timestamp, t);
+            latest_event_time = std::max(latest_event_time, t);
+            pending.push(Pending{t, input->index, input->num_received++, std::move(m)});
+        }
+    }
+}
+
+bool TimestampMerge::all_inputs_past(double t) const
+{
+    for (auto& input: input_queues) {
+        if (input->latest_timestamp < t) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double TimestampMerge::now() const
+{
+    return clock == Clock::WallClock ? get_current_time() : latest_event_time;
+}
+
+void TimestampMerge::child_thread_fn()
+{
+    auto signal_top = [this]() {
+        Pending p = pending.top();
+        pending.pop();
+        last_signalled_timestamp = p.timestamp;
+        num_signalled++;
+        signal(p.message);
+    };
+
+    while (!this->stop_requested()) {
+
+        drain_inputs();
+
+        // signal everything that nothing can precede anymore
+        while (!pending.empty()) {
+            double t = pending.top().timestamp;
+            if (!all_inputs_past(t) && now() - t < lateness_window) {
+                break;
+            }
+            signal_top();
+        }
+
+        // Sleep until something arrives - or, on the wall clock, until
+        // the oldest message is due. Event time only moves when
+        // something arrives.
+        double wait_seconds = MaxIdleWaitSeconds;
+        if (clock == Clock::WallClock && !pending.empty()) {
+            wait_seconds = std::min(wait_seconds, pending.top().timestamp + lateness_window - now());
+        }
+        if (wait_seconds <= 0) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool anything_queued = std::any_of(input_queues.begin(), input_queues.end(), [](auto& input) { return !input->queue.empty(); });
+        if (!anything_queued && !this->stop_requested()) {
+            wake_cv.wait_for(lock, std::chrono::duration<double>(wait_seconds));
+        }
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    // on the way out, signal whatever's left, in order
+    drain_inputs();
+    while (!pending.empty()) {
+        signal_top();
+    }
+}
+
+string TimestampMerge::to_string() const
+{
+    std::stringstream sst;
+    sst << "<TimestampMerge"
+        << " inputs: " << input_queues.size()
+        << " lateness_window: " << lateness_window
+        << " clock: " << (clock == Clock::WallClock ? "wall" : "event")
+        << " signalled: " << num_signalled
+        << " late: " << num_late
+        << " overflowed: " << get_num_overflowed()
+        << " " << RunnableNode::to_string() << ">";
+    return sst.str();
+}
+
+} // namespace nodes
+} // namespace roboflex
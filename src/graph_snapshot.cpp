@@ -0,0 +1,161 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <typeinfo>
+#include <unordered_set>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+#include "roboflex_core/graph_snapshot.h"
+#include "roboflex_core/util/utils.h"
+
+namespace roboflex::core {
+
+static string type_name_of(const Node& node)
+{
+    const char* name = typeid(node).name();
+#if defined(__GNUG__)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status == 0 && demangled != nullptr) {
+        string result = demangled;
+        std::free(demangled);
+        return result;
+    }
+#endif
+    return name;
+}
+
+static string json_string(const string& s)
+{
+    std::stringstream sst;
+    sst << '"';
+    for (unsigned char c: s) {
+        switch (c) {
+            case '"': sst << "\\\""; break;
+            case '\\': sst << "\\\\"; break;
+            case '\n': sst << "\\n"; break;
+            case '\r': sst << "\\r"; break;
+            case '\t': sst << "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    sst << escaped;
+                } else {
+                    sst << c;
+                }
+        }
+    }
+    sst << '"';
+    return sst.str();
+}
+
+static string dot_string(const string& s)
+{
+    string escaped = "\"";
+    for (char c: s) {
+        if (c == '\n') {
+            escaped += "\\n";
+            continue;
+        }
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+GraphSnapshot Node::snapshot_graph() const
+{
+    GraphSnapshot snapshot;
+    snapshot.time = get_current_time();
+
+    // breadth-first, from here
+    std::unordered_set<const Node*> visited = { this };
+    std::vector<const Node*> frontier = { this };
+    for (size_t i = 0; i < frontier.size(); i++) {
+        const Node* node = frontier[i];
+
+        GraphSnapshot::NodeInfo info;
+        info.guid = node->get_guid();
+        info.name = node->get_name();
+        info.type = type_name_of(*node);
+        info.congestion = node->get_congestion();
+        if (auto runnable = dynamic_cast<const RunnableNode*>(node)) {
+            info.runnable = true;
+            info.running = !runnable->stop_requested();
+            info.thread_name = runnable->get_thread_config().thread_name.empty() ?
+                node->get_name() : runnable->get_thread_config().thread_name;
+        }
+        snapshot.nodes.push_back(std::move(info));
+
+        for (auto& edge: node->get_edge_stats()) {
+            snapshot.edges.push_back({node->get_guid(), edge.child->get_guid(), edge.messages, edge.bytes, edge.last_time});
+            if (visited.insert(edge.child.get()).second) {
+                frontier.push_back(edge.child.get());
+            }
+        }
+    }
+
+    return snapshot;
+}
+
+string GraphSnapshot::to_json() const
+{
+    std::stringstream sst;
+    sst << std::setprecision(15);
+    sst << "{\"time\": " << time << ", \"nodes\": [";
+    for (size_t i = 0; i < nodes.size(); i++) {
+        auto& n = nodes[i];
+        sst << (i == 0 ? "" : ", ")
+            << "{\"guid\": " << json_string(n.guid.str())
+            << ", \"name\": " << json_string(n.name)
+            << ", \"type\": " << json_string(n.type)
+            << ", \"runnable\": " << (n.runnable ? "true" : "false")
+            << ", \"running\": " << (n.running ? "true" : "false")
+            << ", \"thread_name\": " << json_string(n.thread_name)
+            << ", \"congestion\": " << n.congestion
+            << "}";
+    }
+    sst << "], \"edges\": [";
+    for (size_t i = 0; i < edges.size(); i++) {
+        auto& e = edges[i];
+        sst << (i == 0 ? "" : ", ")
+            << "{\"parent\": " << json_string(e.parent_guid.str())
+            << ", \"child\": " << json_string(e.child_guid.str())
+            << ", \"messages\": " << e.messages
+            << ", \"bytes\": " << e.bytes
+            << ", \"last_time\": " << e.last_time
+            << "}";
+    }
+    sst << "]}";
+    return sst.str();
+}
+
+string GraphSnapshot::to_dot() const
+{
+    std::stringstream sst;
+    sst << "digraph roboflex {\n"
+        << "    node [shape=box];\n";
+    for (auto& n: nodes) {
+        sst << "    " << dot_string(n.guid.str())
+            << " [label=" << dot_string(n.name + "\n" + n.type)
+            << (n.runnable ? ", style=bold" : "")
+            << "];\n";
+    }
+    for (auto& e: edges) {
+        double penwidth = 1.0 + std::log10(1.0 + double(e.bytes)) / 2.0;
+        sst << "    " << dot_string(e.parent_guid.str()) << " -> " << dot_string(e.child_guid.str())
+            << " [label=" << dot_string(std::to_string(e.messages) + " msgs\n" + std::to_string(e.bytes) + " bytes")
+            << ", penwidth=" << std::fixed << std::setprecision(2) << penwidth << std::defaultfloat
+            << "];\n";
+    }
+    sst << "}\n";
+    return sst.str();
+}
+
+} // namespace roboflex::core
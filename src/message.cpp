@@ -1,5 +1,6 @@
 #include <sstream>
 #include "roboflex_core/message.h"
+#include "roboflex_core/serialization/flex_tensor_format.h"
 
 using std::stringstream;
 
@@ -254,6 +255,34 @@ void Message::set_sender_info(const std::string& name, const sole::uuid& guid, u
     }
 }
 
+flexbuffers::Reference Message::root_val(const serialization::FlexKey& key) const
+{
+    if (payload() == nullptr || payload()->get_size() == 0) {
+        return flexbuffers::Reference();
+    }
+
+    auto m = root_map();
+    using RootKeyCache = MessageBackingStore::RootKeyCache;
+    auto& entry = payload()->root_key_cache.entries[key.hash % RootKeyCache::NumEntries];
+    const uint64_t tag = (key.hash | 0x8000000000000000ull) & 0xFFFFFFFF00000000ull;
+
+    uint64_t cached = entry.load(std::memory_order_relaxed);
+    if ((cached & 0xFFFFFFFF00000000ull) == tag) {
+        uint32_t index = uint32_t(cached);
+        auto keys = m.Keys();
+        if (index < keys.size() && serialization::compare_key(keys[index].AsKey(), key) == 0) {
+            return m.Values()[index];
+        }
+    }
+
+    int index = serialization::lookup_index(m, key);
+    if (index < 0) {
+        return flexbuffers::Reference();
+    }
+    entry.store(tag | uint32_t(index), std::memory_order_relaxed);
+    return m.Values()[index];
+}
+
 flexbuffers::Builder Message::get_builder() 
 {
     // Create a flex-buffer builder
@@ -284,6 +313,20 @@ void Message::finish_serialization(flexbuffers::Builder& fbb)
     //std::cout << "bf:           " << (void*)(bf.data()) << "  " << bf.size() << std::endl;
     //std::cout << "nonconst_bf:  " << (void*)(nonconst_bf.data()) << "  " << nonconst_bf.size() << std::endl;
 
+    // Tensors written aligned are aligned relative to the start of the
+    // buffer; the vector's own memory is only as aligned as malloc makes
+    // it (16 bytes). If that's not enough, copy into aligned storage.
+    bool needs_alignment =
+        reinterpret_cast<uintptr_t>(nonconst_bf.data()) % MESSAGE_DATA_ALIGNMENT != 0 &&
+        serialization::has_aligned_tensors(flexbuffers::GetRoot(
+            nonconst_bf.data() + MESSAGE_HEADER_SIZE, nonconst_bf.size() - MESSAGE_HEADER_SIZE).AsMap());
+
+    if (needs_alignment) {
+        this->_data = std::make_shared<MessageBackingStoreAligned>(nonconst_bf.data(), nonconst_bf.size());
+        this->_data->blit_header();
+        return;
+    }
+
     // Move ownership into my payload.
     auto payload = make_shared<MessageBackingStoreVector>(std::move(nonconst_bf));
     this->_data = payload;
@@ -1,3 +1,4 @@
+#include <new>
 #include <sstream>
 #include <iostream>
 #include "roboflex_core/message_backing_store.h"
@@ -63,4 +64,27 @@ void MessageBackingStoreNew::print_on(ostream& os) const
        << ">";
 }
 
+
+// -- MessageBackingStoreAligned --
+
+MessageBackingStoreAligned::MessageBackingStoreAligned(const uint8_t* bytes, size_t length):
+    data(static_cast<uint8_t*>(::operator new(length, std::align_val_t(MESSAGE_DATA_ALIGNMENT)))),
+    size(length)
+{
+    memcpy(data, bytes, length);
+}
+
+MessageBackingStoreAligned::~MessageBackingStoreAligned()
+{
+    ::operator delete(data, std::align_val_t(MESSAGE_DATA_ALIGNMENT));
+}
+
+void MessageBackingStoreAligned::print_on(ostream& os) const
+{
+    os << "<MessageBackingStoreAligned"
+       << " data: " << static_cast<const void*>(this->data)
+       << " size: " << this->get_size()
+       << ">";
+}
+
 } // namespace roboflex::core
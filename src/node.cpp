@@ -1,21 +1,27 @@
+#include <future>
 #include <sstream>
 #include <signal.h>
 #include "roboflex_core/node.h"
+#include "roboflex_core/node_registry.h"
 #include "roboflex_core/util/utils.h"
+#include "roboflex_core/util/uuid_map.h"
 #include "roboflex_core/core_messages/core_messages.h"
 
 namespace roboflex::core {
 
 Node::Node(const std::string& name):
     name(name),
-    guid(sole::uuid4())
+    guid(util::fast_uuid4())
 {
-
+    NodeRegistry::instance().add(this);
 }
 
 Node::~Node()
 {
-    
+    NodeRegistry::instance().remove(this);
+    for (auto& o: observers) {
+        o.node->on_disconnect(*this, false);
+    }
 }
 
 string Node::to_string() const
@@ -24,9 +30,10 @@ string Node::to_string() const
     sst << "<Node"
         << " name: \"" << get_name() << "\""
         << " guid: " << get_guid();
-    if (has_observers()) {
-        sst << " children(" << observers.size() << "): [";
-        for (auto n: observers) {
+    auto children = get_observers();
+    if (!children.empty()) {
+        sst << " children(" << children.size() << "): [";
+        for (auto n: children) {
             sst << " \"" << n->get_name() << "\"";
         }
         sst << "]";
@@ -51,8 +58,11 @@ string Node::graph_to_string(int level) const
 Node::NodePtr Node::connect(Node::NodePtr node)
 {
     const std::lock_guard<std::recursive_mutex> lock(observer_collection_mutex);
-    observers.push_back(node);
+
+    // the child goes first, so it can refuse
     node->on_connect(*this, false);
+    observers.push_back({node, std::make_unique<EdgeCounters>()});
+    NodeRegistry::instance().topology_changed();
     this->on_connect(*node, true);
     return node;
 }
@@ -65,9 +75,12 @@ Node& Node::connect(Node &node)
     // for use by c++ programs that create nodes on the stack, and then
     // connects them, as opposed to python programs (or c++, or other)
     // that want to create a node, connect it, and then forget it.
-    auto sptr = Node::NodePtr(&node, [](Node *) {});
-    observers.push_back(sptr);
+    // It shares ownership with nothing, so it doesn't take over the
+    // node's weak_from_this.
+    auto sptr = Node::NodePtr(Node::NodePtr(), &node);
     node.on_connect(*this, false);
+    observers.push_back({sptr, std::make_unique<EdgeCounters>()});
+    NodeRegistry::instance().topology_changed();
     this->on_connect(node, true);
     return node;
 }
@@ -75,12 +88,22 @@ Node& Node::connect(Node &node)
 void Node::disconnect(Node::NodePtr node)
 {
     const std::lock_guard<std::recursive_mutex> lock(observer_collection_mutex);
-    observers.remove(node);
+    size_t num_before = observers.size();
+    observers.remove_if([&node](const Observer& o) { return o.node == node; });
+    size_t num_removed = num_before - observers.size();
+    if (num_removed == 0) {
+        return;
+    }
+    NodeRegistry::instance().topology_changed();
+    for (size_t i = 0; i < num_removed; i++) {
+        node->on_disconnect(*this, false);
+        this->on_disconnect(*node, true);
+    }
 }
 
 void Node::disconnect(Node &node)
 {
-    auto sptr = Node::NodePtr(&node, [](Node *) {});
+    auto sptr = Node::NodePtr(Node::NodePtr(), &node);
     disconnect(sptr);
 }
 
@@ -98,7 +121,35 @@ size_t Node::num_observers() const
 
 std::list<Node::NodePtr> Node::get_observers() const
 {
-    return observers;
+    const std::lock_guard<std::recursive_mutex> lock(observer_collection_mutex);
+    std::list<Node::NodePtr> nodes;
+    for (auto& o: observers) {
+        nodes.push_back(o.node);
+    }
+    return nodes;
+}
+
+void Node::append_observers(std::vector<NodePtr>& nodes) const
+{
+    const std::lock_guard<std::recursive_mutex> lock(observer_collection_mutex);
+    for (auto& o: observers) {
+        nodes.push_back(o.node);
+    }
+}
+
+std::vector<EdgeStats> Node::get_edge_stats() const
+{
+    const std::lock_guard<std::recursive_mutex> lock(observer_collection_mutex);
+    std::vector<EdgeStats> stats;
+    stats.reserve(observers.size());
+    for (auto& o: observers) {
+        stats.push_back({
+            o.node,
+            o.counters->messages.load(std::memory_order_relaxed),
+            o.counters->bytes.load(std::memory_order_relaxed),
+            o.counters->last_time.load(std::memory_order_relaxed)});
+    }
+    return stats;
 }
 
 Node& Node::operator > (Node& other) 
@@ -115,87 +166,274 @@ Node::NodePtr Node::operator > (Node::NodePtr other)
 // -- some utility functions --
 
 /**
- * Walks the graph of nodes, starting at node, and calling node_fun on each node.
+ * A flat, open-addressing set of nodes, for marking them visited. Clearing
+ * it is a counter bump - slots from earlier walks just read as empty - so
+ * one set is reused walk after walk.
  */
-void step_nodes(Node::NodeWalkCallback node_fun, NodePtr node, set<NodePtr>& visited, bool forwards, int level=0)
-{
-    if (visited.find(node) != visited.end()) {
-        return;
+class VisitedSet {
+public:
+
+    void clear() {
+        if (++epoch == 0) {
+            for (auto& slot: slots) {
+                slot.epoch = 0;
+            }
+            epoch = 1;
+        }
+        count = 0;
     }
 
-    visited.insert(node);
-
-    auto children = node->get_observers();
-    if (forwards) {
-        node_fun(node, level);
-        for (auto& child: children) {
-            step_nodes(node_fun, child, visited, true, level+1);
+    // Returns false if the node was already in the set.
+    bool insert(const Node* node) {
+        if ((count + 1) * 4 > slots.size() * 3) {
+            grow();
         }
-    } else {
-        for (auto& child: children) {
-            step_nodes(node_fun, child, visited, false, level+1);
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(node) & mask; ; i = (i + 1) & mask) {
+            Slot& slot = slots[i];
+            if (slot.epoch != epoch) {
+                slot = { node, epoch };
+                count++;
+                return true;
+            }
+            if (slot.node == node) {
+                return false;
+            }
         }
-        node_fun(node, level);
     }
-}
+
+protected:
+
+    struct Slot {
+        const Node* node = nullptr;
+        uint32_t epoch = 0;
+    };
+
+    static size_t hash(const Node* node) {
+        uint64_t x = reinterpret_cast<uintptr_t>(node);
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    void grow() {
+        std::vector<Slot> old_slots = std::move(slots);
+        slots.assign(old_slots.empty() ? 64 : old_slots.size() * 2, Slot());
+        size_t mask = slots.size() - 1;
+        for (auto& slot: old_slots) {
+            if (slot.epoch == epoch) {
+                size_t i = hash(slot.node) & mask;
+                while (slots[i].epoch == epoch) {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = slot;
+            }
+        }
+    }
+
+    std::vector<Slot> slots;
+    uint32_t epoch = 1;
+    size_t count = 0;
+};
 
 /**
- * Walks the graph of connections, starting at node, and calling connection_fun 
- * on each pair of connected nodes connection.
+ * The state of a depth-first walk, kept on the heap instead of the call
+ * stack, so long chains can't overflow it. Each frame is a node being
+ * visited; the children of the topmost frame are pending[begin, end),
+ * and the ones below it are already visited or under way.
  */
-void step_connections(Node::ConnectionWalkCallback connection_fun, NodePtr node, set<NodePtr>& visited, bool forwards, int level=0)
-{
-    if (visited.find(node) != visited.end()) {
-        return;
+struct Traversal {
+    struct Frame {
+        NodePtr node;
+
+        // who node's children hang from (filter_nodes only)
+        Node* children_parent;
+
+        int level;
+        size_t begin;
+        size_t next;
+    };
+
+    VisitedSet visited;
+    std::vector<NodePtr> pending;
+    std::vector<Frame> frames;
+
+    // what walk_nodes and walk_connections visit, in order
+    std::vector<NodeRegistry::NodeVisit> node_order;
+    std::vector<NodeRegistry::ConnectionVisit> connection_order;
+};
+
+/**
+ * Borrows a Traversal from this thread's pool for one walk, so that walks
+ * on a warm thread don't allocate. Walks can nest (a filter_nodes callback
+ * may walk), so each borrows its own.
+ */
+class TraversalLease {
+public:
+    TraversalLease() {
+        auto& pool = get_pool();
+        if (pool.empty()) {
+            traversal = std::make_unique<Traversal>();
+        } else {
+            traversal = std::move(pool.back());
+            pool.pop_back();
+        }
+        traversal->visited.clear();
+    }
+
+    ~TraversalLease() {
+        // don't keep nodes alive between walks
+        traversal->pending.clear();
+        traversal->frames.clear();
+        traversal->node_order.clear();
+        traversal->connection_order.clear();
+        get_pool().push_back(std::move(traversal));
     }
 
-    visited.insert(node);
+    Traversal* operator->() { return traversal.get(); }
+    Traversal& operator*() { return *traversal; }
 
-    auto children = node->get_observers();
-    for (auto& child: children) {
-        if (forwards) {
-            connection_fun(node, child, level);
-            step_connections(connection_fun, child, visited, true, level+1);
+protected:
+    static std::vector<std::unique_ptr<Traversal>>& get_pool() {
+        thread_local std::vector<std::unique_ptr<Traversal>> pool;
+        return pool;
+    }
+
+    std::unique_ptr<Traversal> traversal;
+};
+
+/**
+ * Walks the graph of nodes below root, depth-first, appending each node
+ * to t.node_order: before its children going forwards, after them
+ * backwards.
+ */
+static void step_nodes(Traversal& t, const Node& root, bool forwards)
+{
+    root.append_observers(t.pending);
+    t.frames.push_back({nullptr, nullptr, -1, 0, 0});
+
+    while (!t.frames.empty()) {
+        auto& top = t.frames.back();
+        if (top.next < t.pending.size()) {
+            NodePtr node = t.pending[top.next++];
+            int level = top.level + 1;
+            if (!t.visited.insert(node.get())) {
+                continue;
+            }
+            size_t begin = t.pending.size();
+            node->append_observers(t.pending);
+            if (forwards) {
+                t.node_order.push_back({node, level});
+            }
+            t.frames.push_back({std::move(node), nullptr, level, begin, begin});
         } else {
-            step_connections(connection_fun, child, visited, false, level+1);
-            connection_fun(node, child, level);
+            if (!forwards && top.node != nullptr) {
+                t.node_order.push_back({top.node, top.level});
+            }
+            t.pending.resize(top.begin);
+            t.frames.pop_back();
         }
     }
 }
 
 /**
- * Prunes the graph of nodes, starting at node, and calling filter_fun 
- * on each node to determine whether to keep that node. The graph is pruned.
+ * Walks the graph of connections below root (but not root's own),
+ * appending each pair of connected nodes to t.connection_order: before
+ * the child's connections going forwards, after them backwards.
  */
-void filter(Node::NodeFilterCallback filter_fun, Node* parent, NodePtr child, set<NodePtr>& visited, int level=0)
-{
-    if (visited.find(child) != visited.end()) {
-        return;
+static void step_connections(Traversal& t, const Node& root, bool forwards)
+{
+    root.append_observers(t.pending);
+    t.frames.push_back({nullptr, nullptr, -1, 0, 0});
+
+    while (!t.frames.empty()) {
+        auto& top = t.frames.back();
+        if (top.next < t.pending.size()) {
+            NodePtr node = t.pending[top.next++];
+            if (forwards && top.node != nullptr) {
+                t.connection_order.push_back({top.node, node, top.level});
+            }
+            if (!t.visited.insert(node.get())) {
+                if (!forwards && top.node != nullptr) {
+                    t.connection_order.push_back({top.node, node, top.level});
+                }
+                continue;
+            }
+            int level = top.level + 1;
+            size_t begin = t.pending.size();
+            node->append_observers(t.pending);
+            t.frames.push_back({std::move(node), nullptr, level, begin, begin});
+        } else {
+            NodePtr node = std::move(top.node);
+            t.pending.resize(top.begin);
+            t.frames.pop_back();
+            if (!forwards && node != nullptr && t.frames.back().node != nullptr) {
+                auto& parent = t.frames.back();
+                t.connection_order.push_back({parent.node, node, parent.level});
+            }
+        }
     }
+}
 
-    visited.insert(child);
-
-    bool keep_node = filter_fun(child, level);
-    auto grand_children = child->get_observers();
-
-    if (!keep_node) {
-        parent->disconnect(child);
-        for (auto& grand_child: grand_children) {
-            parent->connect(grand_child);
+/**
+ * Prunes the graph of nodes below root, calling filter_fun on each node
+ * to determine whether to keep it. A node that isn't kept is cut out of
+ * both sides: its parent is connected straight to its children instead,
+ * which are then filtered as the parent's.
+ */
+static void filter(Node::NodeFilterCallback& filter_fun, Node& root)
+{
+    TraversalLease t;
+    root.append_observers(t->pending);
+    t->frames.push_back({nullptr, &root, -1, 0, 0});
+
+    while (!t->frames.empty()) {
+        auto& top = t->frames.back();
+        if (top.next < t->pending.size()) {
+            NodePtr child = t->pending[top.next++];
+            Node* parent = top.children_parent;
+            int level = top.level + 1;
+            if (!t->visited.insert(child.get())) {
+                continue;
+            }
+
+            bool keep_node = filter_fun(child, level);
+            size_t begin = t->pending.size();
+            child->append_observers(t->pending);
+
+            if (!keep_node) {
+                parent->disconnect(child);
+                for (size_t i = begin; i < t->pending.size(); i++) {
+                    child->disconnect(t->pending[i]);
+                    parent->connect(t->pending[i]);
+                }
+            }
+
+            Node* children_parent = keep_node ? child.get() : parent;
+            t->frames.push_back({std::move(child), children_parent, level, begin, begin});
+        } else {
+            t->pending.resize(top.begin);
+            t->frames.pop_back();
         }
-    } 
-
-    for (auto& grand_child: grand_children) {
-        filter(filter_fun, child.get(), grand_child, visited, level+1);
     }
 }
 
 void Node::walk_nodes(NodeWalkCallback node_fun, bool forwards) const
 {
-    set<NodePtr> visited;
-    auto children = this->get_observers();
-    for (auto& child: children) {
-        step_nodes(node_fun, child, visited, forwards);
+    // The order is gathered before any callback runs, so callbacks may
+    // walk (borrowing another Traversal) or change the graph.
+    auto& registry = NodeRegistry::instance();
+    TraversalLease t;
+    auto& order = t->node_order;
+    if (!registry.get_node_order(this, forwards, order)) {
+        uint64_t topology_version = registry.get_topology_version();
+        order.clear();
+        step_nodes(*t, *this, forwards);
+        registry.set_node_order(this, forwards, topology_version, order);
+    }
+    for (auto& visit: order) {
+        node_fun(visit.node, visit.depth);
     }
 }
 
@@ -211,10 +449,17 @@ void Node::walk_nodes_backwards(NodeWalkCallback node_fun) const
 
 void Node::walk_connections(ConnectionWalkCallback connection_fun, bool forwards) const
 {
-    set<NodePtr> visited;
-    auto children = this->get_observers();
-    for (auto& child: children) {
-        step_connections(connection_fun, child, visited, forwards);
+    auto& registry = NodeRegistry::instance();
+    TraversalLease t;
+    auto& order = t->connection_order;
+    if (!registry.get_connection_order(this, forwards, order)) {
+        uint64_t topology_version = registry.get_topology_version();
+        order.clear();
+        step_connections(*t, *this, forwards);
+        registry.set_connection_order(this, forwards, topology_version, order);
+    }
+    for (auto& visit: order) {
+        connection_fun(visit.parent, visit.child, visit.depth);
     }
 }
 
@@ -230,11 +475,19 @@ void Node::walk_connections_backwards(ConnectionWalkCallback connection_fun) con
 
 void Node::filter_nodes(NodeFilterCallback filter_fun)
 {
-    set<NodePtr> visited;
-    auto children = this->get_observers();
-    for (auto& child: children) {
-        filter(filter_fun, this, child, visited);
-    }
+    filter(filter_fun, *this);
+}
+
+
+// --- Backpressure ---
+
+float Node::get_downstream_congestion() const
+{
+    float congestion = 0;
+    this->walk_nodes_forwards([&congestion](NodePtr node, int) {
+        congestion = std::max(congestion, node->get_congestion());
+    });
+    return congestion;
 }
 
 
@@ -246,8 +499,17 @@ void Node::notify_observers(MessagePtr m)
 
     message_send_counter += 1;
 
-    for (auto o: observers) {
-        o->receive_from(m, *this);
+    if (observers.empty()) {
+        return;
+    }
+
+    uint64_t bytes = m->get_raw_size();
+    double now = get_current_time();
+    for (auto& o: observers) {
+        o.counters->messages.fetch_add(1, std::memory_order_relaxed);
+        o.counters->bytes.fetch_add(bytes, std::memory_order_relaxed);
+        o.counters->last_time.store(now, std::memory_order_relaxed);
+        o.node->receive_from(m, *this);
     }
 }
 
@@ -285,26 +547,113 @@ void Node::receive(MessagePtr m)
     signal(m);
 }
 
-MessagePtr Node::handle_rpc(MessagePtr rpc_message)
+Node::RpcTable& Node::RpcTable::add(const string& module_name, const string& message_name, Handler handler)
 {
-    if (rpc_message->module_name() == CoreModuleName) {
+    auto key = rpc_key(module_name, message_name);
+    auto it = entries.find(key);
+    if (it != entries.end() &&
+        (it->second.module_name != module_name || it->second.message_name != message_name)) {
+        throw std::runtime_error("rpc \"" + module_name + "/" + message_name +
+            "\" collides with \"" + it->second.module_name + "/" + it->second.message_name + "\"");
+    }
+    entries[key] = Entry{module_name, message_name, std::move(handler)};
+    return *this;
+}
 
-        const auto message_name = rpc_message->message_name();
+const Node::RpcTable::Handler* Node::RpcTable::find(std::string_view module_name, std::string_view message_name) const
+{
+    auto it = entries.find(rpc_key(module_name, message_name));
+    if (it == entries.end() ||
+        it->second.module_name != module_name ||
+        it->second.message_name != message_name) {
+        return nullptr;
+    }
+    return &it->second.handler;
+}
 
-        if (message_name == PingMessageName) {
+const Node::RpcTable& Node::class_rpc_table()
+{
+    static const RpcTable table = [] {
+        RpcTable t;
+        t.add(CoreModuleName, PingMessageName, [](Node&, MessagePtr) {
             return make_shared<BlankMessage>(PongMessageName);
-        }
-        else if (message_name == GetNameMessageName) {
-            return make_shared<StringMessage>(GotNameMessageName, get_name());
-        }
-        else if (message_name == GetGuidMessageName) {
-            return make_shared<StringMessage>(GotGuidMessageName, get_guid().str());
+        });
+        t.add(CoreModuleName, GetNameMessageName, [](Node& node, MessagePtr) {
+            return make_shared<StringMessage>(GotNameMessageName, node.get_name());
+        });
+        t.add(CoreModuleName, GetGuidMessageName, [](Node& node, MessagePtr) {
+            return make_shared<StringMessage>(GotGuidMessageName, node.get_guid().str());
+        });
+        return t;
+    }();
+    return table;
+}
+
+MessagePtr Node::handle_rpc(MessagePtr rpc_message)
+{
+    auto module_name = rpc_message->module_name_view();
+    auto message_name = rpc_message->message_name_view();
+
+    RpcTable::Handler handler;
+    {
+        const std::shared_lock<std::shared_mutex> lock(rpc_handlers_mutex);
+        if (rpc_handlers != nullptr) {
+            if (auto h = rpc_handlers->find(module_name, message_name)) {
+                handler = *h;
+            }
         }
     }
+    if (handler) {
+        return handler(*this, rpc_message);
+    }
 
+    // class tables are immutable once made, so need no lock
+    if (auto h = get_rpc_table().find(module_name, message_name)) {
+        return (*h)(*this, rpc_message);
+    }
     return nullptr;
 }
 
+void Node::register_rpc_handler(const string& module_name, const string& message_name, RpcHandler handler)
+{
+    const std::unique_lock<std::shared_mutex> lock(rpc_handlers_mutex);
+    if (rpc_handlers == nullptr) {
+        rpc_handlers = std::make_unique<RpcTable>();
+    }
+    try {
+        rpc_handlers->add(module_name, message_name, [handler = std::move(handler)](Node&, MessagePtr m) {
+            return handler(m);
+        });
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error("Node \"" + get_name() + "\": " + e.what());
+    }
+}
+
+bool Node::has_rpc_handler(const string& module_name, const string& message_name) const
+{
+    {
+        const std::shared_lock<std::shared_mutex> lock(rpc_handlers_mutex);
+        if (rpc_handlers != nullptr && rpc_handlers->find(module_name, message_name) != nullptr) {
+            return true;
+        }
+    }
+    return get_rpc_table().find(module_name, message_name) != nullptr;
+}
+
+uint64_t Node::rpc_key(std::string_view module_name, std::string_view message_name)
+{
+    // FNV-1a, over both names with a separator
+    uint64_t h = 14695981039346656037ull;
+    for (char c: module_name) {
+        h = (h ^ uint8_t(c)) * 1099511628211ull;
+    }
+    h = (h ^ uint8_t('/')) * 1099511628211ull;
+    for (char c: message_name) {
+        h = (h ^ uint8_t(c)) * 1099511628211ull;
+    }
+    return h;
+}
+
 
 // --- RunnableNode ---
 
@@ -314,11 +663,38 @@ RunnableNode::RunnableNode(const std::string& name):
 
 }
 
+const Node::RpcTable& RunnableNode::class_rpc_table()
+{
+    static const RpcTable table = [] {
+        RpcTable t = Node::class_rpc_table();
+        t.add_for<RunnableNode>(CoreModuleName, StartMessageName, [](RunnableNode& node, MessagePtr) {
+            node.start();
+            return make_shared<BlankMessage>(OKMessageName);
+        });
+        t.add_for<RunnableNode>(CoreModuleName, StopMessageName, [](RunnableNode& node, MessagePtr) {
+            node.stop();
+            return make_shared<BlankMessage>(OKMessageName);
+        });
+        return t;
+    }();
+    return table;
+}
+
 RunnableNode::~RunnableNode()
 {
     this->stop();
 }
 
+static string thread_config_error_string(const string& node_name, const std::vector<std::string>& errors)
+{
+    std::stringstream sst;
+    sst << "Could not apply thread config to \"" << node_name << "\":";
+    for (const auto& e: errors) {
+        sst << " " << e << ";";
+    }
+    return sst.str();
+}
+
 void RunnableNode::start()
 {
     // Once we get jthreads in clang:
@@ -330,11 +706,30 @@ void RunnableNode::start()
     //     this->my_thread.reset(new std::jthread(f, this));
     // }
     if (this->my_thread == nullptr) {
-        auto f = [](RunnableNode* self) {
-            self->child_thread_fn();
+
+        // The thread configures itself, then tells us how that went
+        // before running child_thread_fn.
+        std::promise<std::vector<std::string>> config_errors_promise;
+        auto config_errors = config_errors_promise.get_future();
+
+        auto f = [](RunnableNode* self, std::promise<std::vector<std::string>> p) {
+            auto errors = util::apply_thread_config(self->thread_config, self->get_name());
+            bool ok = errors.empty();
+            p.set_value(std::move(errors));
+            if (ok) {
+                self->child_thread_fn();
+            }
         };
         this->stop_signal = false;
-        this->my_thread.reset(new std::thread(f, this));
+        this->my_thread.reset(new std::thread(f, this, std::move(config_errors_promise)));
+
+        auto errors = config_errors.get();
+        if (!errors.empty()) {
+            this->my_thread->join();
+            this->my_thread.reset();
+            this->stop_signal = true;
+            throw std::runtime_error(thread_config_error_string(get_name(), errors));
+        }
     }
 }
 
@@ -394,6 +789,19 @@ void RunnableNode::run()
     SignalStacker s = SignalStacker(this);
 //#endif
 
+    // This is the caller's thread, so only rename it if asked to, and
+    // put it back the way it was when we're done - or if some part of the
+    // config could not be applied after the rest was.
+    struct ThreadStateRestorer {
+        util::ThreadState state = util::capture_thread_state();
+        ~ThreadStateRestorer() { util::restore_thread_state(state); }
+    } restorer;
+
+    auto errors = util::apply_thread_config(thread_config);
+    if (!errors.empty()) {
+        throw std::runtime_error(thread_config_error_string(get_name(), errors));
+    }
+
     this->stop_signal = false;
 
     // and let's go - just run in this thread
@@ -407,25 +815,4 @@ string RunnableNode::to_string() const
     return sst.str();
 }
 
-MessagePtr RunnableNode::handle_rpc(MessagePtr rpc_message)
-{
-    if (rpc_message->module_name() == CoreModuleName) {
-
-        const auto message_name = rpc_message->message_name();
-
-        if (message_name == StartMessageName) {
-            start();
-            return make_shared<BlankMessage>(OKMessageName);
-        }
-        else if (message_name == StopMessageName) {
-            stop();
-            return make_shared<BlankMessage>(OKMessageName);
-        } else {
-            return Node::handle_rpc(rpc_message);
-        }
-    }
-
-    return nullptr;
-}
-
 } // roboflex::core
@@ -0,0 +1,182 @@
+#include <mutex>
+#include "roboflex_core/node_registry.h"
+
+namespace roboflex::core {
+
+NodeRegistry& NodeRegistry::instance()
+{
+    // never destroyed, so that nodes destroyed during static
+    // destruction can still leave it
+    static NodeRegistry* registry = new NodeRegistry();
+    return *registry;
+}
+
+NodeRegistry::NodePtr NodeRegistry::pointer_to(Node* node)
+{
+    // Nodes join from Node::Node, before make_shared has given them an
+    // owner, so a node without one may be half-built: skip it.
+    return node->weak_from_this().lock();
+}
+
+NodeRegistry::NodePtr NodeRegistry::pointer_to(Node* node, bool owned)
+{
+    return owned ? pointer_to(node) : NodePtr(NodePtr(), node);
+}
+
+void NodeRegistry::add(Node* node)
+{
+    const std::unique_lock<std::shared_mutex> lock(registry_mutex);
+    nodes_by_guid.insert_or_assign(node->get_guid(), node);
+    nodes_by_name.emplace(node->get_name(), node);
+}
+
+void NodeRegistry::remove(Node* node)
+{
+    const std::unique_lock<std::shared_mutex> lock(registry_mutex);
+    nodes_by_guid.erase(node->get_guid());
+    auto [first, last] = nodes_by_name.equal_range(node->get_name());
+    for (auto it = first; it != last; ++it) {
+        if (it->second == node) {
+            nodes_by_name.erase(it);
+            break;
+        }
+    }
+    topology_version++;
+    forget_orders();
+}
+
+void NodeRegistry::topology_changed()
+{
+    const std::unique_lock<std::shared_mutex> lock(registry_mutex);
+    topology_version++;
+    forget_orders();
+}
+
+void NodeRegistry::forget_orders()
+{
+    for (int direction = 0; direction < 2; direction++) {
+        node_orders[direction].clear();
+        connection_orders[direction].clear();
+    }
+}
+
+NodeRegistry::NodePtr NodeRegistry::find(const uuid& guid) const
+{
+    const std::shared_lock<std::shared_mutex> lock(registry_mutex);
+    auto node = nodes_by_guid.find(guid);
+    return node == nullptr ? nullptr : pointer_to(*node);
+}
+
+std::vector<NodeRegistry::NodePtr> NodeRegistry::find_by_name(const string& name) const
+{
+    const std::shared_lock<std::shared_mutex> lock(registry_mutex);
+    std::vector<NodePtr> found;
+    auto [first, last] = nodes_by_name.equal_range(name);
+    for (auto it = first; it != last; ++it) {
+        if (auto node = pointer_to(it->second)) {
+            found.push_back(node);
+        }
+    }
+    return found;
+}
+
+std::vector<NodeRegistry::NodePtr> NodeRegistry::get_nodes() const
+{
+    const std::shared_lock<std::shared_mutex> lock(registry_mutex);
+    std::vector<NodePtr> found;
+    found.reserve(nodes_by_guid.size());
+    nodes_by_guid.for_each([&found](const uuid&, Node* n) {
+        if (auto node = pointer_to(n)) {
+            found.push_back(node);
+        }
+    });
+    return found;
+}
+
+size_t NodeRegistry::size() const
+{
+    const std::shared_lock<std::shared_mutex> lock(registry_mutex);
+    return nodes_by_guid.size();
+}
+
+uint64_t NodeRegistry::get_topology_version() const
+{
+    const std::shared_lock<std::shared_mutex> lock(registry_mutex);
+    return topology_version;
+}
+
+// Cached orders hold plain pointers: any node in one is still alive,
+// because destroying it would have forgotten the order. Each remembers
+// whether the walk reached it through an owning pointer, and gives out
+// the same kind. What they give out goes straight into order, so that
+// no pointer we made is released (possibly destroying a node, which
+// takes the lock) while we hold it.
+
+bool NodeRegistry::get_node_order(const Node* root, bool forwards, std::vector<NodeVisit>& order) const
+{
+    const std::shared_lock<std::shared_mutex> lock(registry_mutex);
+    auto& orders = node_orders[forwards];
+    auto cached = orders.find(root);
+    if (cached == orders.end()) {
+        return false;
+    }
+    order.reserve(order.size() + cached->second.size());
+    for (auto& visit: cached->second) {
+        order.push_back({pointer_to(visit.node, visit.owned), visit.depth});
+        if (order.back().node == nullptr) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NodeRegistry::get_connection_order(const Node* root, bool forwards, std::vector<ConnectionVisit>& order) const
+{
+    const std::shared_lock<std::shared_mutex> lock(registry_mutex);
+    auto& orders = connection_orders[forwards];
+    auto cached = orders.find(root);
+    if (cached == orders.end()) {
+        return false;
+    }
+    order.reserve(order.size() + cached->second.size());
+    for (auto& visit: cached->second) {
+        order.push_back({pointer_to(visit.parent, visit.parent_owned), pointer_to(visit.child, visit.child_owned), visit.depth});
+        if (order.back().parent == nullptr || order.back().child == nullptr) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void NodeRegistry::set_node_order(const Node* root, bool forwards, uint64_t version, const std::vector<NodeVisit>& order)
+{
+    const std::unique_lock<std::shared_mutex> lock(registry_mutex);
+    if (version != topology_version) {
+        return;
+    }
+    auto& cached = node_orders[forwards][root];
+    cached.clear();
+    cached.reserve(order.size());
+    for (auto& visit: order) {
+        cached.push_back({visit.node.get(), visit.node.use_count() != 0, visit.depth});
+    }
+}
+
+void NodeRegistry::set_connection_order(const Node* root, bool forwards, uint64_t version, const std::vector<ConnectionVisit>& order)
+{
+    const std::unique_lock<std::shared_mutex> lock(registry_mutex);
+    if (version != topology_version) {
+        return;
+    }
+    auto& cached = connection_orders[forwards][root];
+    cached.clear();
+    cached.reserve(order.size());
+    for (auto& visit: order) {
+        cached.push_back({
+            visit.parent.get(), visit.parent.use_count() != 0,
+            visit.child.get(), visit.child.use_count() != 0,
+            visit.depth});
+    }
+}
+
+} // namespace roboflex::core
@@ -0,0 +1,70 @@
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "roboflex_core/serialization/flex_key.h"
+
+namespace roboflex {
+namespace serialization {
+
+FlexKey FlexKey::intern(const std::string& s)
+{
+    // Each thread remembers what it has interned, so that only a
+    // thread's first use of a key takes the process-wide lock. Interned
+    // strings are never freed, so these stay valid.
+    thread_local std::unordered_map<std::string, FlexKey> seen;
+    auto found = seen.find(s);
+    if (found != seen.end()) {
+        return found->second;
+    }
+
+    static std::mutex interned_mutex;
+    static std::unordered_map<std::string, std::unique_ptr<std::string>> interned;
+
+    std::lock_guard<std::mutex> lock(interned_mutex);
+    auto& stored = interned[s];
+    if (stored == nullptr) {
+        stored = std::make_unique<std::string>(s);
+    }
+    FlexKey key(stored->c_str(), uint32_t(stored->size()), hash_of(stored->c_str(), stored->size()));
+    seen.emplace(s, key);
+    return key;
+}
+
+int compare_key(const char* flex_key, const FlexKey& key)
+{
+    int c = strncmp(flex_key, key.str, key.length);
+    if (c == 0 && flex_key[key.length] != 0) {
+        // flex_key is longer, so comes after
+        return 1;
+    }
+    return c;
+}
+
+int lookup_index(flexbuffers::Map m, const FlexKey& key)
+{
+    auto keys = m.Keys();
+    int lo = 0;
+    int hi = int(keys.size()) - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int c = compare_key(keys[mid].AsKey(), key);
+        if (c == 0) {
+            return mid;
+        } else if (c < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -1;
+}
+
+flexbuffers::Reference lookup(flexbuffers::Map m, const FlexKey& key)
+{
+    int index = lookup_index(m, key);
+    return index < 0 ? flexbuffers::Reference() : m.Values()[index];
+}
+
+} // namespace serialization
+} // namespace roboflex
@@ -0,0 +1,508 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "roboflex_core/serialization/flex_tensor_codec.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace roboflex {
+namespace serialization {
+
+size_t tensor_decoded_size(flexbuffers::Reference r)
+{
+    size_t num_bytes = type_size_from_code(tensor_type_code(r));
+    for (auto s: tensor_shape(r)) {
+        num_bytes *= s;
+    }
+    return num_bytes;
+}
+
+
+// -- byte shuffle --
+
+void byte_shuffle(const uint8_t* src, uint8_t* dst, size_t num_bytes, size_t element_size)
+{
+    if (element_size <= 1) {
+        memcpy(dst, src, num_bytes);
+        return;
+    }
+
+    size_t n = num_bytes / element_size;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    if (element_size == 2) {
+        const __m128i low_byte = _mm_set1_epi16(0x00FF);
+        for (; i + 16 <= n; i += 16) {
+            __m128i a = _mm_loadu_si128((const __m128i*)(src + i * 2));
+            __m128i b = _mm_loadu_si128((const __m128i*)(src + i * 2 + 16));
+            __m128i lo = _mm_packus_epi16(_mm_and_si128(a, low_byte), _mm_and_si128(b, low_byte));
+            __m128i hi = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+            _mm_storeu_si128((__m128i*)(dst + i), lo);
+            _mm_storeu_si128((__m128i*)(dst + n + i), hi);
+        }
+    } else if (element_size == 4) {
+        const __m128i low_byte = _mm_set1_epi32(0xFF);
+        for (; i + 16 <= n; i += 16) {
+            __m128i v[4];
+            for (int k = 0; k < 4; k++) {
+                v[k] = _mm_loadu_si128((const __m128i*)(src + i * 4 + k * 16));
+            }
+            for (int byte = 0; byte < 4; byte++) {
+                __m128i x[4];
+                for (int k = 0; k < 4; k++) {
+                    x[k] = _mm_and_si128(v[k], low_byte);
+                    v[k] = _mm_srli_epi32(v[k], 8);
+                }
+                __m128i packed = _mm_packus_epi16(_mm_packs_epi32(x[0], x[1]), _mm_packs_epi32(x[2], x[3]));
+                _mm_storeu_si128((__m128i*)(dst + byte * n + i), packed);
+            }
+        }
+    }
+#elif defined(__ARM_NEON)
+    if (element_size == 2) {
+        for (; i + 16 <= n; i += 16) {
+            uint8x16x2_t v = vld2q_u8(src + i * 2);
+            vst1q_u8(dst + i, v.val[0]);
+            vst1q_u8(dst + n + i, v.val[1]);
+        }
+    } else if (element_size == 4) {
+        for (; i + 16 <= n; i += 16) {
+            uint8x16x4_t v = vld4q_u8(src + i * 4);
+            for (int byte = 0; byte < 4; byte++) {
+                vst1q_u8(dst + byte * n + i, v.val[byte]);
+            }
+        }
+    }
+#endif
+
+    for (; i < n; i++) {
+        for (size_t byte = 0; byte < element_size; byte++) {
+            dst[byte * n + i] = src[i * element_size + byte];
+        }
+    }
+
+    // any trailing bytes that don't make a whole element stay where they are
+    memcpy(dst + n * element_size, src + n * element_size, num_bytes - n * element_size);
+}
+
+void byte_unshuffle(const uint8_t* src, uint8_t* dst, size_t num_bytes, size_t element_size)
+{
+    if (element_size <= 1) {
+        memcpy(dst, src, num_bytes);
+        return;
+    }
+
+    size_t n = num_bytes / element_size;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    if (element_size == 2) {
+        for (; i + 16 <= n; i += 16) {
+            __m128i lo = _mm_loadu_si128((const __m128i*)(src + i));
+            __m128i hi = _mm_loadu_si128((const __m128i*)(src + n + i));
+            _mm_storeu_si128((__m128i*)(dst + i * 2), _mm_unpacklo_epi8(lo, hi));
+            _mm_storeu_si128((__m128i*)(dst + i * 2 + 16), _mm_unpackhi_epi8(lo, hi));
+        }
+    } else if (element_size == 4) {
+        for (; i + 16 <= n; i += 16) {
+            __m128i b0 = _mm_loadu_si128((const __m128i*)(src + i));
+            __m128i b1 = _mm_loadu_si128((const __m128i*)(src + n + i));
+            __m128i b2 = _mm_loadu_si128((const __m128i*)(src + 2 * n + i));
+            __m128i b3 = _mm_loadu_si128((const __m128i*)(src + 3 * n + i));
+            __m128i b01_lo = _mm_unpacklo_epi8(b0, b1);
+            __m128i b01_hi = _mm_unpackhi_epi8(b0, b1);
+            __m128i b23_lo = _mm_unpacklo_epi8(b2, b3);
+            __m128i b23_hi = _mm_unpackhi_epi8(b2, b3);
+            _mm_storeu_si128((__m128i*)(dst + i * 4), _mm_unpacklo_epi16(b01_lo, b23_lo));
+            _mm_storeu_si128((__m128i*)(dst + i * 4 + 16), _mm_unpackhi_epi16(b01_lo, b23_lo));
+            _mm_storeu_si128((__m128i*)(dst + i * 4 + 32), _mm_unpacklo_epi16(b01_hi, b23_hi));
+            _mm_storeu_si128((__m128i*)(dst + i * 4 + 48), _mm_unpackhi_epi16(b01_hi, b23_hi));
+        }
+    }
+#elif defined(__ARM_NEON)
+    if (element_size == 2) {
+        for (; i + 16 <= n; i += 16) {
+            uint8x16x2_t v;
+            v.val[0] = vld1q_u8(src + i);
+            v.val[1] = vld1q_u8(src + n + i);
+            vst2q_u8(dst + i * 2, v);
+        }
+    } else if (element_size == 4) {
+        for (; i + 16 <= n; i += 16) {
+            uint8x16x4_t v;
+            for (int byte = 0; byte < 4; byte++) {
+                v.val[byte] = vld1q_u8(src + byte * n + i);
+            }
+            vst4q_u8(dst + i * 4, v);
+        }
+    }
+#endif
+
+    for (; i < n; i++) {
+        for (size_t byte = 0; byte < element_size; byte++) {
+            dst[i * element_size + byte] = src[byte * n + i];
+        }
+    }
+
+    memcpy(dst + n * element_size, src + n * element_size, num_bytes - n * element_size);
+}
+
+
+// -- frame delta --
+
+void xor_bytes(const uint8_t* a, const uint8_t* b, uint8_t* dst, size_t num_bytes)
+{
+    // simple enough that compilers vectorize it at whatever width the target has
+    size_t i = 0;
+    for (; i + 8 <= num_bytes; i += 8) {
+        uint64_t x, y;
+        memcpy(&x, a + i, 8);
+        memcpy(&y, b + i, 8);
+        x ^= y;
+        memcpy(dst + i, &x, 8);
+    }
+    for (; i < num_bytes; i++) {
+        dst[i] = a[i] ^ b[i];
+    }
+}
+
+
+// -- lz4 block format --
+//
+// A greedy, single-probe compressor, like lz4's "fast" mode; output is
+// standard lz4 block format. The format's end-of-block rules: the last
+// 5 bytes are always literals, and no match starts in the last 12.
+
+static constexpr size_t LZ4MinMatch = 4;
+static constexpr size_t LZ4LastLiterals = 5;
+static constexpr size_t LZ4MatchFindLimit = 12;
+static constexpr size_t LZ4MaxOffset = 65535;
+static constexpr int LZ4HashLog = 14;
+
+static inline uint32_t read32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint32_t lz4_hash(uint32_t sequence)
+{
+    return (sequence * 2654435761U) >> (32 - LZ4HashLog);
+}
+
+static inline uint8_t* lz4_write_length(uint8_t* op, size_t length)
+{
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = uint8_t(length);
+    return op;
+}
+
+size_t lz4_compress_bound(size_t num_bytes)
+{
+    return num_bytes + num_bytes / 255 + 16;
+}
+
+size_t lz4_compress(const uint8_t* src, size_t num_bytes, uint8_t* dst)
+{
+    uint8_t* op = dst;
+    size_t anchor = 0;
+
+    auto write_literals = [&](size_t end, uint8_t*& token) {
+        size_t literal_length = end - anchor;
+        token = op++;
+        *token = uint8_t(std::min<size_t>(literal_length, 15) << 4);
+        if (literal_length >= 15) {
+            op = lz4_write_length(op, literal_length - 15);
+        }
+        memcpy(op, src + anchor, literal_length);
+        op += literal_length;
+    };
+
+    if (num_bytes > LZ4MatchFindLimit) {
+        std::vector<uint32_t> table(size_t(1) << LZ4HashLog, 0);
+        const size_t match_start_limit = num_bytes - LZ4MatchFindLimit;
+        const size_t match_end_limit = num_bytes - LZ4LastLiterals;
+
+        size_t ip = 0;
+        while (ip < match_start_limit) {
+            uint32_t sequence = read32(src + ip);
+            uint32_t h = lz4_hash(sequence);
+            size_t candidate = table[h];
+            table[h] = uint32_t(ip);
+
+            if (candidate >= ip || ip - candidate > LZ4MaxOffset || read32(src + candidate) != sequence) {
+                // skip ahead faster the longer we go without a match,
+                // so that incompressible data costs little
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            size_t match_length = LZ4MinMatch;
+            while (ip + match_length + 8 <= match_end_limit) {
+                uint64_t a, b;
+                memcpy(&a, src + candidate + match_length, 8);
+                memcpy(&b, src + ip + match_length, 8);
+                if (a != b) {
+                    match_length += __builtin_ctzll(a ^ b) / 8;
+                    break;
+                }
+                match_length += 8;
+            }
+            while (ip + match_length < match_end_limit && src[candidate + match_length] == src[ip + match_length]) {
+                match_length++;
+            }
+
+            uint8_t* token;
+            write_literals(ip, token);
+
+            size_t offset = ip - candidate;
+            *op++ = uint8_t(offset);
+            *op++ = uint8_t(offset >> 8);
+
+            size_t extra = match_length - LZ4MinMatch;
+            *token |= uint8_t(std::min<size_t>(extra, 15));
+            if (extra >= 15) {
+                op = lz4_write_length(op, extra - 15);
+            }
+
+            ip += match_length;
+            anchor = ip;
+        }
+    }
+
+    uint8_t* token;
+    write_literals(num_bytes, token);
+
+    return op - dst;
+}
+
+void lz4_decompress(const uint8_t* src, size_t num_bytes, uint8_t* dst, size_t decompressed_size)
+{
+    size_t ip = 0;
+    size_t op = 0;
+
+    auto read_length = [&](size_t length) {
+        uint8_t b;
+        do {
+            if (ip >= num_bytes) {
+                throw std::runtime_error("lz4_decompress: truncated input");
+            }
+            b = src[ip++];
+            length += b;
+        } while (b == 255);
+        return length;
+    };
+
+    while (true) {
+        if (ip >= num_bytes) {
+            throw std::runtime_error("lz4_decompress: truncated input");
+        }
+        uint8_t token = src[ip++];
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15) {
+            literal_length = read_length(literal_length);
+        }
+        if (literal_length > num_bytes - ip || literal_length > decompressed_size - op) {
+            throw std::runtime_error("lz4_decompress: literals overrun the buffer");
+        }
+        memcpy(dst + op, src + ip, literal_length);
+        ip += literal_length;
+        op += literal_length;
+
+        if (ip == num_bytes) {
+            break;
+        }
+
+        if (num_bytes - ip < 2) {
+            throw std::runtime_error("lz4_decompress: truncated input");
+        }
+        size_t offset = src[ip] | (size_t(src[ip + 1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            throw std::runtime_error("lz4_decompress: bad match offset");
+        }
+
+        size_t match_length = token & 15;
+        if (match_length == 15) {
+            match_length = read_length(match_length);
+        }
+        match_length += LZ4MinMatch;
+        if (match_length > decompressed_size - op) {
+            throw std::runtime_error("lz4_decompress: match overruns the buffer");
+        }
+
+        const uint8_t* match = dst + op - offset;
+        if (offset >= match_length) {
+            memcpy(dst + op, match, match_length);
+        } else {
+            // overlapping: a run
+            for (size_t i = 0; i < match_length; i++) {
+                dst[op + i] = match[i];
+            }
+        }
+        op += match_length;
+    }
+
+    if (op != decompressed_size) {
+        throw std::runtime_error("lz4_decompress: expected " + std::to_string(decompressed_size) +
+            " bytes, got " + std::to_string(op));
+    }
+}
+
+
+// -- whole tensors --
+
+std::vector<uint8_t> encode_tensor_data(
+    const uint8_t* data,
+    size_t num_bytes,
+    size_t element_size,
+    int encoding,
+    const uint8_t* previous)
+{
+    std::vector<uint8_t> current(data, data + num_bytes);
+    std::vector<uint8_t> scratch;
+
+    if (encoding & EncodingFrameDelta) {
+        if (previous == nullptr && num_bytes > 0) {
+            throw std::runtime_error("encode_tensor_data: frame delta encoding needs the previous frame");
+        }
+        xor_bytes(current.data(), previous, current.data(), num_bytes);
+    }
+
+    if (encoding & EncodingShuffle) {
+        scratch.resize(num_bytes);
+        byte_shuffle(current.data(), scratch.data(), num_bytes, element_size);
+        current.swap(scratch);
+    }
+
+    if (encoding & EncodingLZ4) {
+        scratch.resize(lz4_compress_bound(num_bytes));
+        scratch.resize(lz4_compress(current.data(), num_bytes, scratch.data()));
+        current.swap(scratch);
+    }
+
+    return current;
+}
+
+void decode_tensor_data(
+    const uint8_t* encoded,
+    size_t encoded_size,
+    uint8_t* dst,
+    size_t num_bytes,
+    size_t element_size,
+    int encoding,
+    const uint8_t* previous)
+{
+    if ((encoding & EncodingFrameDelta) && previous == nullptr && num_bytes > 0) {
+        throw std::runtime_error("decode_tensor_data: frame delta encoding needs the previous frame");
+    }
+
+    std::vector<uint8_t> scratch;
+    const uint8_t* current = encoded;
+
+    if (encoding & EncodingLZ4) {
+        scratch.resize(num_bytes);
+        lz4_decompress(encoded, encoded_size, scratch.data(), num_bytes);
+        current = scratch.data();
+    } else if (encoded_size != num_bytes) {
+        throw std::runtime_error("decode_tensor_data: expected " + std::to_string(num_bytes) +
+            " bytes, got " + std::to_string(encoded_size));
+    }
+
+    if (encoding & EncodingShuffle) {
+        byte_unshuffle(current, dst, num_bytes, element_size);
+    } else {
+        memcpy(dst, current, num_bytes);
+    }
+
+    if (encoding & EncodingFrameDelta) {
+        xor_bytes(dst, previous, dst, num_bytes);
+    }
+}
+
+void serialize_encoded_tensor(
+    flexbuffers::Builder& fbb,
+    flexbuffers::Reference r,
+    const std::string& name,
+    int encoding,
+    const uint8_t* previous,
+    uint64_t frame)
+{
+    if (!is_tensor(r)) {
+        throw std::runtime_error("serialize_encoded_tensor was not handed a tensor");
+    }
+    if (tensor_encoding(r) != EncodingNone) {
+        throw std::runtime_error("serialize_encoded_tensor was handed a tensor that is already encoded");
+    }
+
+    int dtype = tensor_type_code(r);
+    auto shape = tensor_shape(r);
+    auto shape_vector = std::vector<uint64_t>(shape.begin(), shape.end());
+    auto blob = lookup(r.AsMap(), DataFlexKey).AsBlob();
+    auto encoded = encode_tensor_data(blob.data(), blob.size(), type_size_from_code(dtype), encoding, previous);
+
+    if (!name.empty()) {
+        fbb.Key(name);
+    }
+    fbb.Map([&]() {
+        fbb.Key(ShapeKey);
+        fbb.Vector(shape_vector);
+        fbb.Key(DataKey);
+        fbb.Blob(encoded.data(), encoded.size());
+        fbb.Int(DTypeKey, dtype);
+        fbb.Int(EncodingKey, encoding);
+        fbb.UInt(FrameKey, frame);
+    });
+}
+
+void decode_tensor(
+    flexbuffers::Reference r,
+    std::vector<uint8_t>& decoded,
+    const uint8_t* previous)
+{
+    if (!is_tensor(r)) {
+        throw std::runtime_error("decode_tensor was not handed a tensor");
+    }
+    int dtype = tensor_type_code(r);
+    size_t num_bytes = tensor_decoded_size(r);
+    auto blob = lookup(r.AsMap(), DataFlexKey).AsBlob();
+    decoded.resize(num_bytes);
+    decode_tensor_data(blob.data(), blob.size(), decoded.data(), num_bytes,
+        type_size_from_code(dtype), tensor_encoding(r), previous);
+}
+
+void serialize_raw_tensor(
+    flexbuffers::Builder& fbb,
+    const std::string& name,
+    int dtype,
+    const std::vector<size_t>& shape,
+    const uint8_t* data,
+    size_t num_bytes)
+{
+    auto shape_vector = std::vector<uint64_t>(shape.begin(), shape.end());
+    if (!name.empty()) {
+        fbb.Key(name);
+    }
+    fbb.Map([&]() {
+        fbb.Key(ShapeKey);
+        fbb.Vector(shape_vector);
+        fbb.Key(DataKey);
+        pad_for_aligned_blob(fbb, num_bytes);
+        fbb.Blob(data, num_bytes);
+        fbb.Int(DTypeKey, dtype);
+        fbb.Int(AlignKey, TensorDataAlignment);
+    });
+}
+
+} // namespace serialization
+} // namespace roboflex
@@ -20,6 +20,7 @@ std::string type_name_from_code(int type_code) {
         //case 12: return "complex64";
         //case 13: return "complex128";
         case 14: return "float16";
+        case 15: return "bfloat16";
         default: return "wat";
     }
 }
@@ -40,6 +41,7 @@ static std::map<std::string, int> TypeNamesToCodes = {
     // { "complex64", 12 },
     // { "complex128", 13 },
     { "float16", 14 },
+    { "bfloat16", 15 },
     { "wat", -1 }
 };
 
@@ -48,14 +50,46 @@ int type_code_from_name(const std::string& type_name)
     return TypeNamesToCodes[type_name];
 }
 
+size_t type_size_from_code(int type_code)
+{
+    switch (type_code) {
+        case 0: return 1;
+        case 1: return 2;
+        case 2: return 4;
+        case 3: return 8;
+        case 4: return 1;
+        case 5: return 2;
+        case 6: return 4;
+        case 7: return 8;
+        case 8: return sizeof(intptr_t);
+        case 9: return sizeof(uintptr_t);
+        case 10: return 4;
+        case 11: return 8;
+        case 12: return 8;
+        case 13: return 16;
+        case 14: return 2;
+        case 15: return 2;
+        default: return 0;
+    }
+}
+
 bool is_tensor(flexbuffers::Reference r) 
 {
-    return r.IsMap() && r.AsMap()[DataKey].IsBlob() && r.AsMap()[DTypeKey].IsInt() && (r.AsMap()[ShapeKey].IsVector() || r.AsMap()[ShapeKey].IsTypedVector());
+    if (!r.IsMap()) {
+        return false;
+    }
+    auto m = r.AsMap();
+    auto shape = lookup(m, ShapeFlexKey);
+    return lookup(m, DataFlexKey).IsBlob() && lookup(m, DTypeFlexKey).IsInt() && (shape.IsVector() || shape.IsTypedVector());
 }
 
 int tensor_type_code(flexbuffers::Reference r) 
 {
-    return (r.IsMap() && r.AsMap()[DTypeKey].IsInt()) ? r.AsMap()[DTypeKey].AsInt8() : -1;
+    if (!r.IsMap()) {
+        return -1;
+    }
+    auto dtype = lookup(r.AsMap(), DTypeFlexKey);
+    return dtype.IsInt() ? dtype.AsInt8() : -1;
 }
 
 std::string tensor_type_name(flexbuffers::Reference r)
@@ -69,17 +103,20 @@ int tensor_rank(flexbuffers::Reference r)
         return -1;
     }
     auto m = r.AsMap();
-    auto s = m[ShapeKey];
+    auto s = lookup(m, ShapeFlexKey);
     return s.IsVector() ? s.AsVector().size() : s.IsTypedVector() ? s.AsTypedVector().size() : -1;
 }
 
 std::vector<size_t> tensor_shape(flexbuffers::Reference r) 
 {
-    if (!r.IsMap() || !(r.AsMap()[ShapeKey].IsVector() || r.AsMap()[ShapeKey].IsTypedVector())) {
+    if (!r.IsMap()) {
         return {};
     }
-    auto m = r.AsMap();
-    auto shape = m[ShapeKey].AsTypedVector();
+    auto shape_ref = lookup(r.AsMap(), ShapeFlexKey);
+    if (!(shape_ref.IsVector() || shape_ref.IsTypedVector())) {
+        return {};
+    }
+    auto shape = shape_ref.AsTypedVector();
     std::vector<size_t> vshape;
     for (size_t i=0; i<shape.size(); i++) {
         uint64_t shape_element = shape[i].AsUInt64();
@@ -88,5 +125,66 @@ std::vector<size_t> tensor_shape(flexbuffers::Reference r)
     return vshape;
 }
 
+int tensor_alignment(flexbuffers::Reference r)
+{
+    if (!r.IsMap()) {
+        return 0;
+    }
+    auto a = lookup(r.AsMap(), AlignFlexKey);
+    return a.IsInt() ? a.AsInt32() : 0;
+}
+
+bool is_tensor_aligned(flexbuffers::Reference r)
+{
+    int alignment = tensor_alignment(r);
+    if (alignment <= 0 || !is_tensor(r)) {
+        return false;
+    }
+    auto data = lookup(r.AsMap(), DataFlexKey).AsBlob().data();
+    return reinterpret_cast<uintptr_t>(data) % alignment == 0;
+}
+
+bool has_aligned_tensors(flexbuffers::Map m)
+{
+    auto values = m.Values();
+    for (size_t i=0; i<values.size(); i++) {
+        if (tensor_alignment(values[i]) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int tensor_encoding(flexbuffers::Reference r)
+{
+    if (!r.IsMap()) {
+        return EncodingNone;
+    }
+    auto e = lookup(r.AsMap(), EncodingFlexKey);
+    return e.IsInt() ? e.AsInt32() : EncodingNone;
+}
+
+uint64_t tensor_frame(flexbuffers::Reference r)
+{
+    if (!r.IsMap()) {
+        return 0;
+    }
+    auto f = lookup(r.AsMap(), FrameFlexKey);
+    return f.IsInt() || f.IsUInt() ? f.AsUInt64() : 0;
+}
+
+void pad_for_aligned_blob(flexbuffers::Builder& fbb, size_t num_bytes)
+{
+    // Blob aligns to the byte width of its length prefix, writes the
+    // length, then the data. So land just before an aligned boundary,
+    // one length-prefix short of it.
+    size_t length_width = size_t(1) << flexbuffers::WidthU(num_bytes);
+    size_t position = fbb.GetSize();
+    size_t padding = (2 * TensorDataAlignment - length_width - position % TensorDataAlignment) % TensorDataAlignment;
+    if (padding > 0) {
+        fbb.ExtendBuffer(padding);
+    }
+}
+
 } // namespace serialization
 } // namespace roboflex
@@ -0,0 +1,100 @@
+#include "roboflex_core/util/half_precision.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define ROBOFLEX_HALF_PRECISION_F16C 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define ROBOFLEX_HALF_PRECISION_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace roboflex {
+namespace util {
+
+#if defined(ROBOFLEX_HALF_PRECISION_F16C)
+
+static bool has_f16c()
+{
+    static const bool has = __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+    return has;
+}
+
+__attribute__((target("avx,f16c")))
+static size_t float_to_half_f16c(const float* src, uint16_t* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(dst + i), h);
+    }
+    return i;
+}
+
+__attribute__((target("avx,f16c")))
+static size_t half_to_float_f16c(const uint16_t* src, float* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+    return i;
+}
+
+#endif
+
+void float_to_half(const float* src, uint16_t* dst, size_t n)
+{
+    size_t i = 0;
+#if defined(ROBOFLEX_HALF_PRECISION_F16C)
+    if (has_f16c()) {
+        i = float_to_half_f16c(src, dst, n);
+    }
+#elif defined(ROBOFLEX_HALF_PRECISION_NEON)
+    for (; i + 4 <= n; i += 4) {
+        float16x4_t h = vcvt_f16_f32(vld1q_f32(src + i));
+        vst1_u16(dst + i, vreinterpret_u16_f16(h));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = float_to_half_bits(src[i]);
+    }
+}
+
+void half_to_float(const uint16_t* src, float* dst, size_t n)
+{
+    size_t i = 0;
+#if defined(ROBOFLEX_HALF_PRECISION_F16C)
+    if (has_f16c()) {
+        i = half_to_float_f16c(src, dst, n);
+    }
+#elif defined(ROBOFLEX_HALF_PRECISION_NEON)
+    for (; i + 4 <= n; i += 4) {
+        float16x4_t h = vreinterpret_f16_u16(vld1_u16(src + i));
+        vst1q_f32(dst + i, vcvt_f32_f16(h));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = half_bits_to_float(src[i]);
+    }
+}
+
+// bfloat16 conversion is plain integer arithmetic, written branch-free
+// so that compilers vectorize it for whatever the target has.
+
+void float_to_bfloat16(const float* src, uint16_t* dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = float_to_bfloat16_bits(src[i]);
+    }
+}
+
+void bfloat16_to_float(const uint16_t* src, float* dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = bfloat16_bits_to_float(src[i]);
+    }
+}
+
+} // namespace util
+} // namespace roboflex
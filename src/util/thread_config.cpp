@@ -0,0 +1,157 @@
+#include <cstring>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include "roboflex_core/util/thread_config.h"
+
+namespace roboflex {
+namespace util {
+
+std::string ThreadConfig::to_string() const
+{
+    std::stringstream sst;
+    sst << "<ThreadConfig";
+    if (!thread_name.empty()) {
+        sst << " name: \"" << thread_name << "\"";
+    }
+    if (!cpu_affinity.empty()) {
+        sst << " cpus: [";
+        for (size_t i = 0; i < cpu_affinity.size(); i++) {
+            sst << (i == 0 ? "" : ", ") << cpu_affinity[i];
+        }
+        sst << "]";
+    }
+    switch (scheduling_policy) {
+        case SchedulingPolicy::Default: sst << " policy: default"; break;
+        case SchedulingPolicy::FIFO: sst << " policy: fifo"; break;
+        case SchedulingPolicy::RoundRobin: sst << " policy: rr"; break;
+    }
+    sst << " priority: " << priority;
+    if (lock_memory) {
+        sst << " lock_memory";
+    }
+    sst << ">";
+    return sst.str();
+}
+
+std::vector<std::string> apply_thread_config(
+    const ThreadConfig& config,
+    const std::string& default_thread_name)
+{
+    std::vector<std::string> errors;
+
+    // --- name ---
+
+    std::string name = config.thread_name.empty() ? default_thread_name : config.thread_name;
+    if (!name.empty()) {
+        name = name.substr(0, 15);
+#if defined(__APPLE__)
+        int r = pthread_setname_np(name.c_str());
+#else
+        int r = pthread_setname_np(pthread_self(), name.c_str());
+#endif
+        if (r != 0) {
+            errors.push_back("could not set thread name to \"" + name + "\": " + strerror(r));
+        }
+    }
+
+    // --- cpu affinity ---
+
+    if (!config.cpu_affinity.empty()) {
+#if defined(__linux__)
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for (int cpu: config.cpu_affinity) {
+            if (cpu < 0 || cpu >= CPU_SETSIZE) {
+                errors.push_back("invalid cpu index " + std::to_string(cpu));
+                continue;
+            }
+            CPU_SET(cpu, &cpuset);
+        }
+        int r = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+        if (r != 0) {
+            errors.push_back("could not set cpu affinity: " + std::string(strerror(r)));
+        }
+#else
+        errors.push_back("cpu affinity is not supported on this platform");
+#endif
+    }
+
+    // --- scheduling policy and priority ---
+
+    if (config.scheduling_policy != SchedulingPolicy::Default) {
+        int policy = config.scheduling_policy == SchedulingPolicy::FIFO ? SCHED_FIFO : SCHED_RR;
+        int min_priority = sched_get_priority_min(policy);
+        int max_priority = sched_get_priority_max(policy);
+        if (config.priority < min_priority || config.priority > max_priority) {
+            errors.push_back("priority " + std::to_string(config.priority) + " is outside [" +
+                std::to_string(min_priority) + ", " + std::to_string(max_priority) + "]");
+        } else {
+            sched_param param;
+            memset(&param, 0, sizeof(param));
+            param.sched_priority = config.priority;
+            int r = pthread_setschedparam(pthread_self(), policy, &param);
+            if (r != 0) {
+                errors.push_back("could not set scheduling policy: " + std::string(strerror(r)));
+            }
+        }
+    } else if (config.priority != 0) {
+        errors.push_back("priority " + std::to_string(config.priority) + " requires a real-time scheduling policy");
+    }
+
+    // --- memory locking ---
+
+    if (config.lock_memory) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            errors.push_back("could not lock memory: " + std::string(strerror(errno)));
+        }
+    }
+
+    return errors;
+}
+
+ThreadState capture_thread_state()
+{
+    ThreadState state;
+
+    char name[16] = {0};
+    if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0) {
+        state.thread_name = name;
+    }
+
+    if (pthread_getschedparam(pthread_self(), &state.scheduling_policy, &state.scheduling_param) != 0) {
+        state.scheduling_policy = SCHED_OTHER;
+        memset(&state.scheduling_param, 0, sizeof(state.scheduling_param));
+    }
+
+#if defined(__linux__)
+    CPU_ZERO(&state.cpu_affinity);
+    state.has_cpu_affinity = pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &state.cpu_affinity) == 0;
+#endif
+
+    return state;
+}
+
+void restore_thread_state(const ThreadState& state)
+{
+    // Drop any real-time priority first, so the rest runs at the caller's.
+    pthread_setschedparam(pthread_self(), state.scheduling_policy, &state.scheduling_param);
+
+#if defined(__linux__)
+    if (state.has_cpu_affinity) {
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &state.cpu_affinity);
+    }
+#endif
+
+    if (!state.thread_name.empty()) {
+#if defined(__APPLE__)
+        pthread_setname_np(state.thread_name.c_str());
+#else
+        pthread_setname_np(pthread_self(), state.thread_name.c_str());
+#endif
+    }
+}
+
+} // namespace util
+} // namespace roboflex
@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "roboflex_core/util/timer_service.h"
+
+namespace roboflex {
+namespace util {
+
+TimerService::TimerService(std::chrono::nanoseconds tick, size_t num_workers):
+    tick(tick),
+    epoch(clock::now())
+{
+    wheel_thread = std::thread([this]{ wheel_thread_fn(); });
+    for (size_t i = 0; i < std::max<size_t>(num_workers, 1); i++) {
+        workers.emplace_back([this]{ worker_thread_fn(); });
+    }
+}
+
+TimerService::~TimerService()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wheel_cv.notify_all();
+    dispatch_cv.notify_all();
+    finished_cv.notify_all();
+    wheel_thread.join();
+    for (auto& worker: workers) {
+        worker.join();
+    }
+}
+
+TimerService& TimerService::instance()
+{
+    static TimerService service;
+    return service;
+}
+
+TimerService::TimerId TimerService::schedule_periodic(double period_seconds, Callback callback)
+{
+    auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(period_seconds));
+    if (period <= clock::duration(0)) {
+        throw std::runtime_error("TimerService: period must be positive, got " + std::to_string(period_seconds));
+    }
+    return schedule(period, period, std::move(callback));
+}
+
+TimerService::TimerId TimerService::schedule_once(double delay_seconds, Callback callback)
+{
+    auto delay = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(delay_seconds));
+    return schedule(std::max(delay, clock::duration(0)), clock::duration(0), std::move(callback));
+}
+
+TimerService::TimerId TimerService::schedule(clock::duration delay, clock::duration period, Callback callback)
+{
+    auto timer = std::make_shared<Timer>();
+    timer->callback = std::move(callback);
+    timer->deadline = clock::now() + delay;
+    timer->period = period;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    timer->id = next_id++;
+    timers[timer->id] = timer;
+    catch_up_if_idle();
+    insert(timer, current_tick + 1);
+    wheel_changed = true;
+    wheel_cv.notify_one();
+    return timer->id;
+}
+
+void TimerService::set_period(TimerId id, double period_seconds)
+{
+    auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(period_seconds));
+    if (period <= clock::duration(0)) {
+        throw std::runtime_error("TimerService: period must be positive, got " + std::to_string(period_seconds));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = timers.find(id);
+    if (it != timers.end() && it->second->period > clock::duration(0)) {
+        it->second->period = period;
+    }
+}
+
+void TimerService::cancel(TimerId id)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = timers.find(id);
+    if (it == timers.end()) {
+        return;
+    }
+
+    // The timer stays in the wheel (or the ready queue) until
+    // it comes up; it is dropped then.
+    auto timer = it->second;
+    timer->cancelled = true;
+    timers.erase(it);
+
+    if (timer->running && timer->running_thread != std::this_thread::get_id()) {
+        finished_cv.wait(lock, [&timer]{ return !timer->running; });
+    }
+}
+
+size_t TimerService::num_timers() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return timers.size();
+}
+
+uint64_t TimerService::tick_for(clock::time_point t) const
+{
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t - epoch).count();
+    if (ns <= 0) {
+        return 0;
+    }
+    return (ns + tick.count() - 1) / tick.count();
+}
+
+void TimerService::catch_up_if_idle()
+{
+    // If the wheel has been idle, current_tick has fallen behind the
+    // clock. Nothing is in the wheel, so we can just jump it forward.
+    if (num_in_wheel == 0) {
+        current_tick = std::max(current_tick, now_tick());
+    }
+}
+
+uint64_t TimerService::now_tick() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - epoch).count() / tick.count();
+}
+
+void TimerService::insert(TimerPtr timer, uint64_t min_tick)
+{
+    uint64_t expiry_tick = std::max(tick_for(timer->deadline), min_tick);
+    timer->expiry_tick = expiry_tick;
+
+    // Find the lowest level whose span covers the delay. Timers beyond
+    // the top level's span are parked in it, and re-inserted when it
+    // cascades.
+    uint64_t delta = expiry_tick - current_tick;
+    int level = 0;
+    while (level < NumLevels - 1 && delta >= (uint64_t(1) << (SlotBits * (level + 1)))) {
+        level++;
+    }
+    uint64_t top_span = uint64_t(1) << (SlotBits * NumLevels);
+    uint64_t slot_tick = delta >= top_span ? current_tick + top_span - 1 : expiry_tick;
+    uint64_t slot = (slot_tick >> (SlotBits * level)) & SlotMask;
+
+    wheel[level][slot].push_back(std::move(timer));
+    num_in_wheel += 1;
+}
+
+void TimerService::cascade(int level)
+{
+    uint64_t slot = (current_tick >> (SlotBits * level)) & SlotMask;
+    if (slot == 0 && level + 1 < NumLevels) {
+        cascade(level + 1);
+    }
+
+    Slot timers_to_move;
+    timers_to_move.swap(wheel[level][slot]);
+    num_in_wheel -= timers_to_move.size();
+    for (auto& timer: timers_to_move) {
+        if (!timer->cancelled) {
+            insert(timer, current_tick);
+        }
+    }
+}
+
+void TimerService::advance()
+{
+    current_tick += 1;
+    if ((current_tick & SlotMask) == 0) {
+        cascade(1);
+    }
+
+    Slot expired;
+    expired.swap(wheel[0][current_tick & SlotMask]);
+    num_in_wheel -= expired.size();
+
+    bool any_ready = false;
+    for (auto& timer: expired) {
+        if (timer->cancelled) {
+            continue;
+        }
+        if (timer->expiry_tick <= current_tick) {
+            ready.push_back(timer);
+            any_ready = true;
+        } else {
+            insert(timer, current_tick);
+        }
+    }
+
+    if (any_ready) {
+        dispatch_cv.notify_all();
+    }
+}
+
+uint64_t TimerService::next_busy_tick() const
+{
+    // Level 0 expires a slot every tick; level n cascades one every 64^n
+    // ticks. Each level's slots cover the next 64 of those, so the
+    // nearest non-empty one, at any level, is the next thing to do.
+    uint64_t busy_tick = UINT64_MAX;
+    for (int level = 0; level < NumLevels; level++) {
+        uint64_t shift = SlotBits * level;
+        uint64_t t = ((current_tick >> shift) + 1) << shift;
+        for (uint64_t i = 0; i < NumSlots && t < busy_tick; i++, t += uint64_t(1) << shift) {
+            if (!wheel[level][(t >> shift) & SlotMask].empty()) {
+                busy_tick = t;
+                break;
+            }
+        }
+    }
+    return busy_tick == UINT64_MAX ? (current_tick | SlotMask) + 1 : busy_tick;
+}
+
+void TimerService::wheel_thread_fn()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+
+        if (num_in_wheel == 0) {
+            wheel_cv.wait(lock, [this]{ return stopping || num_in_wheel > 0; });
+            continue;
+        }
+
+        // Sleep until the next tick with something to do, or until a
+        // timer is added that might be due sooner.
+        wheel_changed = false;
+        auto busy_time = epoch + std::chrono::duration_cast<clock::duration>(tick * next_busy_tick());
+        wheel_cv.wait_until(lock, busy_time, [this]{ return stopping || wheel_changed; });
+
+        // Process every tick that is due: the ones we slept through have
+        // nothing in them, so stepping through them is cheap.
+        uint64_t due_tick = now_tick();
+        while (current_tick < due_tick && num_in_wheel > 0 && !stopping) {
+            advance();
+        }
+    }
+}
+
+void TimerService::worker_thread_fn()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        dispatch_cv.wait(lock, [this]{ return stopping || !ready.empty(); });
+        if (stopping) {
+            break;
+        }
+
+        auto timer = ready.front();
+        ready.pop_front();
+        if (timer->cancelled) {
+            continue;
+        }
+
+        timer->running = true;
+        timer->running_thread = std::this_thread::get_id();
+        lock.unlock();
+
+        try {
+            timer->callback();
+        } catch (std::exception& e) {
+            std::cerr << "TimerService: callback of timer " << timer->id << " threw: " << e.what() << std::endl;
+        }
+
+        lock.lock();
+        timer->running = false;
+        finished_cv.notify_all();
+
+        if (timer->cancelled) {
+            continue;
+        }
+
+        if (timer->period > clock::duration(0)) {
+            // Next period, skipping any we missed while running.
+            auto now = clock::now();
+            timer->deadline += timer->period;
+            if (timer->deadline < now) {
+                timer->deadline += ((now - timer->deadline) / timer->period + 1) * timer->period;
+            }
+            catch_up_if_idle();
+            insert(timer, current_tick + 1);
+            wheel_changed = true;
+            wheel_cv.notify_one();
+        } else {
+            timers.erase(timer->id);
+        }
+    }
+}
+
+} // namespace util
+} // namespace roboflex
@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <sys/time.h>
+#include <cerrno>
+#include <ctime>
 #include <cmath>
 #include <thread>
 #include <sstream>
@@ -53,4 +55,28 @@ void sleep_until_next_interval(
     std::this_thread::sleep_until(next_t);
 }
 
+void sleep_until_precise(
+    const std::chrono::time_point<std::chrono::steady_clock> & deadline,
+    std::chrono::nanoseconds spin_tail)
+{
+    const auto sleep_deadline = deadline - spin_tail;
+
+#if defined(__linux__)
+    // steady_clock is CLOCK_MONOTONIC on linux (both libstdc++ and libc++)
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(sleep_deadline.time_since_epoch()).count();
+    if (ns > 0) {
+        struct timespec ts;
+        ts.tv_sec = ns / 1000000000;
+        ts.tv_nsec = ns % 1000000000;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+    }
+#else
+    std::this_thread::sleep_until(sleep_deadline);
+#endif
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        // spin
+    }
+}
+
 } // namespace roboflex::core